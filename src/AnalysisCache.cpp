@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file AnalysisCache.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "AnalysisCache.hpp"
+#include <algorithm>
+#include <cstring>
+
+// Reads the unit records of a cache written by write() with the same 'key'
+// Returns false if the file cannot be read, is not a cache, is truncated, or has another key
+//
+bool analysisCache::read(const std::string& fileName, const std::string& key) {
+    std::ifstream in(fileName, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    std::string bytes(static_cast<std::size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    if (!in.read(&bytes[0], static_cast<std::streamsize>(bytes.size()))) return false;
+
+    cacheReader cache(bytes.data(), bytes.size());
+    if (static_cast<std::uint32_t>(cache.readInt()) != MAGIC || static_cast<std::uint32_t>(cache.readInt()) != VERSION) return false;
+    if (cache.readString() != key) return false;
+
+    std::unordered_map<std::string, std::string> records;
+    cache.readList([&]() {
+        std::string hash = cache.readHash();
+        records[hash] = cache.readString();
+    });
+    if (!cache.isValid() || !cache.isAtEnd()) return false;
+
+    previous = std::move(records);
+    return true;
+}
+
+// Writes the units of this run
+// Returns false if the file cannot be written
+//
+bool analysisCache::write(const std::string& fileName, const std::string& key) const {
+    cacheWriter cache;
+    cache.writeInt(MAGIC);
+    cache.writeInt(VERSION);
+    cache.writeString(key);
+    cache.writeList(current, [&](const std::pair<const int, std::pair<std::string, std::string>>& unit) {
+        cache.writeHash(unit.second.first);
+        cache.writeString(unit.second.second);
+    });
+
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out.is_open()) return false;
+    out.write(cache.getBytes().data(), static_cast<std::streamsize>(cache.getBytes().size()));
+    return out.good();
+}
+
+// Record of the unit with 'hash' in the cache read, or null if there is none
+//
+const std::string* analysisCache::find(const std::string& hash) const {
+    auto record = previous.find(hash);
+    return record == previous.end() ? nullptr : &record->second;
+}
+
+void analysisCache::addUnit(int unitNumber, const std::string& hash, const std::string& record) {
+    current[unitNumber] = {hash, record};
+}
+
+// SHA-256 digest of the unit srcML, which includes the file name unless 'withFilename' is false
+// Without the file name, units with the same content have the same hash (see classModelCollection::copyUnit())
+//
+std::string analysisCache::hashUnit(const char* unitSrcML, std::size_t size, bool withFilename) {
+    const char* end = unitSrcML + size;
+    const char* skipped = end;
+    const char* skippedEnd = end;
+    if (!withFilename) {
+        const char* tagEnd = static_cast<const char*>(std::memchr(unitSrcML, '>', size));
+        const std::string attribute = " filename=\"";
+        const char* found = tagEnd ? std::search(unitSrcML, tagEnd, attribute.begin(), attribute.end()) : end;
+        if (found != tagEnd && found != end) {
+            const char* quote = static_cast<const char*>(std::memchr(found + attribute.size(), '"', tagEnd - found - attribute.size()));
+            if (quote) {
+                skipped = found;
+                skippedEnd = quote + 1;
+            }
+        }
+    }
+
+    sha256 hash;
+    hash.update(unitSrcML, skipped - unitSrcML);
+    hash.update(skippedEnd, end - skippedEnd);
+    return hash.digest();
+}
+
+std::string analysisCache::writeUnit(const std::vector<classPart>& parts, const std::vector<std::string>& functions) {
+    cacheWriter record;
+    auto writeString = [&](const std::string& text) { record.writeString(text); };
+    record.writeList(parts, [&](const classPart& part) {
+        record.writeList(part.name, writeString);
+        record.writeString(part.kind);
+        record.writeInt(part.ordinal);
+        record.writeBool(part.typeFound);
+        record.writeString(part.type);
+        record.writeList(part.parentNames, [&](const std::pair<std::string, std::string>& parent) {
+            record.writeString(parent.first);
+            record.writeString(parent.second);
+        });
+        record.writeList(part.dataMembers, [&](const variable& v) { record.writeVariable(v); });
+        record.writeList(part.methods, writeString);
+    });
+    record.writeList(functions, writeString);
+    return std::move(record.getBytes());
+}
+
+// Returns false if the record is not valid
+//
+bool analysisCache::readUnit(const std::string& unitRecord, std::vector<classPart>& parts, std::vector<std::string>& functions) {
+    cacheReader record(unitRecord.data(), unitRecord.size());
+    record.readList([&]() {
+        classPart part;
+        record.readList([&]() { part.name.push_back(record.readString()); });
+        part.kind      = record.readString();
+        part.ordinal   = record.readInt();
+        part.typeFound = record.readBool();
+        part.type      = record.readString();
+        record.readList([&]() {
+            std::string parentName = record.readString();
+            part.parentNames.push_back({parentName, record.readString()});
+        });
+        record.readList([&]() { part.dataMembers.push_back(record.readVariable()); });
+        record.readList([&]() { part.methods.push_back(record.readString()); });
+        parts.push_back(std::move(part));
+    });
+    record.readList([&]() { functions.push_back(record.readString()); });
+
+    if (!record.isValid() || !record.isAtEnd()) return false;
+    for (const classPart& part : parts)
+        if (part.name.size() != 4) return false;
+    return true;
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file AnalysisCache.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef ANALYSISCACHE_HPP
+#define ANALYSISCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <fstream>
+#include <cstdint>
+#include "ClassModel.hpp"
+
+// Facts extracted from each unit by a previous run, keyed by the SHA-256 digest of the unit srcML (--cache)
+// A unit record has the class parts of the unit and the facts of its free functions (in the order they are found)
+// Only the extraction is cached. Methods are analyzed against their classes, inherit, and are classified again,
+//  so a change in one unit is seen by the units that depend on it without tracking the dependencies
+// The cache is only used if it was written with the same settings (see the key), and is rewritten with the units of the run
+//
+class analysisCache {
+public:
+    bool                        read                    (const std::string&, const std::string&);
+    bool                        write                   (const std::string&, const std::string&) const;
+
+    const std::string*          find                    (const std::string&) const;
+    void                        addUnit                 (int, const std::string&, const std::string&);
+
+    static std::string          hashUnit                (const char*, std::size_t, bool = true);
+    static std::string          writeUnit               (const std::vector<classPart>&, const std::vector<std::string>&);
+    static bool                 readUnit                (const std::string&, std::vector<classPart>&, std::vector<std::string>&);
+
+    std::size_t                 getReadUnitCount        () const                            { return previous.size(); }
+
+private:
+    static const std::uint32_t                      MAGIC = 0x53544143;     // "STAC"
+    static const std::uint32_t                      VERSION = 3;
+
+    std::unordered_map<std::string, std::string>    previous;               // Unit records read from the cache. Key is the unit hash
+    std::map<int, std::pair<std::string, std::string>> current;             // Hash and record of the units of this run. Key is unit number
+};
+
+#endif
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file AnalysisServer.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "AnalysisServer.hpp"
+#include "ClassModelCollection.hpp"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+analysisServer::analysisServer(const std::string& path, const analysisSettings& analysis, bool comment, bool quit, std::size_t maxRequestMegabytes) :
+    socketPath(path), settings(analysis), reDocComment(comment), allowQuit(quit), maxRequestSize(maxRequestMegabytes * 1024 * 1024) {}
+
+analysisServer::~analysisServer() {
+    if (listener != -1) {
+        close(listener);
+        unlink(socketPath.c_str());
+    }
+}
+
+// Creates the socket and listens on it. A socket file left by an earlier server is replaced, but only if no server
+//  answers on it. Any other file at the path is kept and the server does not start
+// A client that closes its connection early must not stop the server, so SIGPIPE is ignored
+//
+bool analysisServer::open() {
+    sockaddr_un address{};
+    if (!socketAddress(address)) {
+        error = "The path is too long";
+        return false;
+    }
+
+    struct stat status{};
+    if (lstat(socketPath.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            error = "The path exists and is not a socket";
+            return false;
+        }
+        if (connectOnce()) {
+            error = "Another server is listening on the socket";
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 || listen(listener, 16) == -1) {
+        error = std::strerror(errno);
+        if (listener != -1) close(listener);
+        listener = -1;
+        return false;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+
+// Handles connections until a quit request
+// The calling thread accepts connections and queues them for a fixed pool of workers. Each request has its own
+//  collection and only reads the settings, so requests are analyzed at the same time
+// At most one connection per worker is queued, so other clients wait in the backlog of the socket
+// A worker that receives a quit request connects to the socket to wake the accept. The requests already queued
+//  are still answered
+// Reads and writes on a connection time out, so a client that stops sending or reading only holds its worker
+//
+void analysisServer::run() {
+    const unsigned int nthreads = SERVER_THREADS;
+    timeval timeout{};
+    timeout.tv_sec = REQUEST_TIMEOUT;
+
+    std::mutex mu;
+    std::condition_variable connectionQueued, connectionTaken;
+    std::deque<int> connections;
+    bool accepting = true;
+    std::atomic<bool> quit{false};
+
+    auto worker = [&]() {
+        while (true) {
+            int connection;
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                connectionQueued.wait(lock, [&]() { return !connections.empty() || !accepting; });
+                if (connections.empty()) return;
+                connection = connections.front();
+                connections.pop_front();
+            }
+            connectionTaken.notify_one();
+
+            bool stop = handleRequest(connection) && !quit.exchange(true);
+            close(connection);
+            if (stop) connectOnce();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < nthreads; ++i) workers.push_back(std::thread(worker));
+
+    while (!quit) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (quit) {
+            close(connection);
+            break;
+        }
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::unique_lock<std::mutex> lock(mu);
+        connectionTaken.wait(lock, [&]() { return connections.size() < nthreads; });
+        connections.push_back(connection);
+        connectionQueued.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        accepting = false;
+    }
+    connectionQueued.notify_all();
+    for (std::thread& thread : workers) thread.join();
+}
+
+// Connects to the socket and closes the connection right away
+// Returns true if a server accepted the connection
+//
+bool analysisServer::connectOnce() const {
+    sockaddr_un address{};
+    if (!socketAddress(address)) return false;
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe == -1) return false;
+    bool connected = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    close(probe);
+    return connected;
+}
+
+bool analysisServer::socketAddress(sockaddr_un& address) const {
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) return false;
+    std::strcpy(address.sun_path, socketPath.c_str());
+    return true;
+}
+
+// Reads the header line and the srcML of a request and writes the reply
+// Returns true for a quit request that is allowed
+//
+bool analysisServer::handleRequest(int connection) {
+    std::string request;
+    if (!readAll(connection, request)) {
+        if (request.size() > maxRequestSize) {
+            std::string reply = "Error: Request larger than " + std::to_string(maxRequestSize / (1024 * 1024)) + " MB (--max-request)\n";
+            writeAll(connection, reply.data(), reply.size());
+        }
+        return false;
+    }
+
+    std::size_t endOfHeader = request.find('\n');
+    std::string header = request.substr(0, endOfHeader);
+    if (header != "" && header.back() == '\r') header.pop_back();
+    if (header == "quit" && allowQuit) return true;
+
+    std::string reply;
+    if (header == "quit")
+        reply = "Error: The server was not started with --allow-quit\n";
+    else if (header != "xml" && header != "json")
+        reply = "Error: Invalid request header: " + header + " (xml, json, or quit)\n";
+    else
+        reply = analyze(endOfHeader != std::string::npos ? request.substr(endOfHeader + 1) : "", header == "json");
+    writeAll(connection, reply.data(), reply.size());
+    return false;
+}
+
+// Classifies one srcML archive or unit in memory, with the settings the server was started with
+// Returns the srcML archive with stereotypes, or the events if json is true
+//
+std::string analysisServer::analyze(const std::string& input, bool json) {
+    srcml_archive* archive = srcml_archive_create();
+    if (srcml_archive_read_open_memory(archive, input.data(), input.size())) {
+        srcml_archive_free(archive);
+        return "Error: Invalid srcML archive\n";
+    }
+
+    srcml_archive* outputArchive = nullptr;
+    char* buffer = nullptr;
+    std::size_t size = 0;
+    if (!json) {
+        outputArchive = srcml_archive_create();
+        srcml_archive_write_open_memory(outputArchive, &buffer, &size);
+        registerOutputNamespaces(outputArchive, archive);
+    }
+
+    // The collection closes both archives. Units past the memory budget are read again from the request
+    std::ostringstream events;
+    classModelCollection classObj(settings, archive, outputArchive, "-", false, false, false, reDocComment, "", json ? &events : nullptr, "",
+                                  nullptr, [&input](srcml_archive* again) { return srcml_archive_read_open_memory(again, input.data(), input.size()); });
+    if (classObj.getError() != "") {
+        free(buffer);
+        return "Error: " + classObj.getError() + "\n";
+    }
+    if (json) return events.str();
+
+    std::string reply;
+    if (buffer) {
+        reply.assign(buffer, size);
+        free(buffer);
+    }
+    return reply;
+}
+
+// Reads until the client closes its side of the connection
+// Returns false if the read fails or times out, or if the request is larger than the maximum size
+//
+bool analysisServer::readAll(int connection, std::string& bytes) const {
+    char buffer[64 * 1024];
+    while (true) {
+        ssize_t count = read(connection, buffer, sizeof(buffer));
+        if (count == 0) return true;
+        if (count == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes.append(buffer, count);
+        if (bytes.size() > maxRequestSize) return false;
+    }
+}
+
+bool analysisServer::writeAll(int connection, const char* bytes, std::size_t size) {
+    while (size > 0) {
+        ssize_t count = write(connection, bytes, size);
+        if (count == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file AnalysisServer.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef ANALYSISSERVER_HPP
+#define ANALYSISSERVER_HPP
+
+#include <string>
+#include <sys/un.h>
+#include <srcml.h>
+#include "AnalysisSettings.hpp"
+
+// Seconds a client can wait between the bytes of its request before its connection is dropped
+constexpr int REQUEST_TIMEOUT = 30;
+
+// Requests the server analyzes at the same time. Each one also uses -j threads for its output
+constexpr unsigned int SERVER_THREADS = 4;
+
+// Resident daemon that classifies srcML archives sent over a Unix socket (--serve)
+// The tables, rules, and xpaths are created once when the server starts, so a request only pays for its analysis
+// Each connection is one request. The client sends a header line and then a srcML archive or unit, and closes its
+//  side of the connection (shutdown) when done. The header is one of:
+//
+//  xml     Reply with the srcML archive with stereotypes
+//  json    Reply with the events (NDJSON, as with --events)
+//  quit    Stop the server (only if it was started with --allow-quit)
+//
+// An invalid request is answered with one line starting with "Error: ". A request larger than the maximum size
+//  (--max-request) or a client that does not send anything for REQUEST_TIMEOUT seconds is dropped, so one client
+//  cannot hold the server or its memory
+// Up to SERVER_THREADS requests are handled at the same time, each with its own analysis
+//
+class analysisServer {
+public:
+                         analysisServer                 (const std::string&, const analysisSettings&, bool, bool, std::size_t);
+                         ~analysisServer                ();
+
+    bool                 open                           ();
+    void                 run                            ();
+    const std::string&   getError                       () const                    { return error; }
+
+private:
+    bool                 handleRequest                  (int);
+    std::string          analyze                        (const std::string&, bool);
+
+    bool                 connectOnce                    () const;
+    bool                 socketAddress                  (sockaddr_un&) const;
+
+    bool                 readAll                        (int, std::string&) const;
+    static bool          writeAll                       (int, const char*, std::size_t);
+
+    std::string                                     socketPath;
+    const analysisSettings&                         settings;                   // Settings the server was started with (prepared)
+    bool                                            reDocComment{false};
+    bool                                            allowQuit{false};           // Stop on a quit request (--allow-quit)
+    std::size_t                                     maxRequestSize{0};          // Bytes (--max-request)
+    int                                             listener{-1};
+    std::string                                     error;                      // Why open failed
+};
+
+#endif
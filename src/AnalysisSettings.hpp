@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file AnalysisSettings.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef ANALYSISSETTINGS_HPP
+#define ANALYSISSETTINGS_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include "StereotypeRules.hpp"
+#include "PrimitiveTypes.hpp"
+#include "IgnorableCalls.hpp"
+#include "XPathBuilder.hpp"
+
+extern primitiveTypes                               PRIMITIVES;
+extern ignorableCalls                               IGNORED_CALLS;
+
+// Named classification settings given with --profile
+// Profiles share the facts extracted from the archive, so only the classification is repeated for each one,
+//  unless the profile has its own kinds of classes or tables (see analysisSettings::hasOwnModels())
+//
+struct stereotypeProfile {
+    std::string                                     name;                       // Used in attribute (st:stereotype-<name>) and report file names
+    stereotypeRules                                 rules;
+    bool                                            structs{false};             // kinds= (the kinds of the default settings if not given)
+    bool                                            interfaces{false};
+    bool                                            unions{false};
+    bool                                            enums{false};
+    bool                                            ownPrimitives{false};       // Was primitive-file= given?
+    primitiveTypes                                  primitives;                 // Built-in primitives and the ones of primitive-file=
+    bool                                            ownIgnoredCalls{false};     // Was ignore-call-file= given?
+    ignorableCalls                                  ignoredCalls;               // Built-in ignored calls and the ones of ignore-call-file=
+};
+
+// Settings of one analysis. They match the options of the stereocode executable
+// They are given to classModelCollection and to the models and unit elements it finds, which only read them,
+//  so analyses with their own settings can run at the same time. The tables of primitives, ignored calls, and
+//  type modifiers (including the user-defined ones) are shared by the process (see StereocodeAnalyzer.cpp)
+// prepare() compiles the rules and generates the xpaths once the settings are set, and is called before an analysis
+// The built-in rules decide empty methods and main without their other facts. Rules from a file (-r) or a profile (-P)
+//  can use any fact, and the fact store keeps all of them, so every fact is extracted for them
+// Classes of the kinds of the default settings and of every profile are extracted. Each pass only classifies the 
+//  classes of its kinds, but all of them are used for inheritance
+//
+struct analysisSettings {
+    bool                                            freeFunction{false};        // -f
+    bool                                            structs{false};             // -s
+    bool                                            interfaces{false};          // -i
+    bool                                            unions{false};              // -n
+    bool                                            enums{false};               // -m
+    bool                                            verbose{false};             // -v
+    bool                                            twoPhase{false};            // --two-phase
+    std::size_t                                     memoryBudget{512};          // -b (megabytes of unit srcML kept from analysis for output)
+    unsigned int                                    jobs{std::thread::hardware_concurrency()};  // -j (output and compression threads)
+    std::string                                     cacheFile;                  // --cache (facts extracted from each unit by the previous run)
+    stereotypeRules                                 rules;                      // -l and -r
+    std::vector<stereotypeProfile>                  profiles;                   // -P (extra settings to classify with)
+    XPathBuilder                                    xpaths;                     // Depend on the kinds of classes analyzed (-s, -i, -n, -m)
+    bool                                            allFacts{false};            // Facts are stored for later queries (--facts)
+    bool                                            fastPaths{true};            // Empty methods and main skip the other facts
+    bool                                            extractedStructs{false};    // Kinds of classes extracted (see prepare())
+    bool                                            extractedInterfaces{false};
+    bool                                            extractedUnions{false};
+    bool                                            extractedEnums{false};
+
+    void prepare() {
+        rules.createRuleList();
+        extractedStructs    = structs;
+        extractedInterfaces = interfaces;
+        extractedUnions     = unions;
+        extractedEnums      = enums;
+        for (auto& profile : profiles) {
+            profile.rules.createRuleList();
+            profile.primitives.createPrimitiveList();
+            profile.ignoredCalls.createCallList();
+            extractedStructs    = extractedStructs    || profile.structs;
+            extractedInterfaces = extractedInterfaces || profile.interfaces;
+            extractedUnions     = extractedUnions     || profile.unions;
+            extractedEnums      = extractedEnums      || profile.enums;
+        }
+        xpaths.generateXpath(extractedStructs, extractedInterfaces, extractedUnions, extractedEnums);
+        fastPaths = !allFacts && profiles.empty() && !rules.isUserDefined();
+    }
+
+    // 'profile' is 0 for the default settings, otherwise the index of the profile + 1
+    // Is a class of 'kind' (e.g., struct, see classModel::findKind()) classified by the pass?
+    bool isKindClassified(const std::string& kind, std::size_t profile) const {
+        const stereotypeProfile* p = profile == 0 ? nullptr : &profiles[profile - 1];
+        if (kind == "struct")    return p ? p->structs    : structs;
+        if (kind == "interface") return p ? p->interfaces : interfaces;
+        if (kind == "union")     return p ? p->unions     : unions;
+        if (kind == "enum")      return p ? p->enums      : enums;
+        return true;
+    }
+
+    // Does the pass classify its own copy of the models? (see classModelCollection::copyModelsForPass())
+    bool hasOwnModels(std::size_t profile) const {
+        const stereotypeProfile* p = profile == 0 ? nullptr : &profiles[profile - 1];
+        bool sameKinds = (p ? p->structs    : structs)    == extractedStructs    &&
+                         (p ? p->interfaces : interfaces) == extractedInterfaces &&
+                         (p ? p->unions     : unions)     == extractedUnions     &&
+                         (p ? p->enums      : enums)      == extractedEnums;
+        return !sameKinds || hasOwnTables(profile);
+    }
+
+    bool hasOwnTables(std::size_t profile) const {
+        return profile != 0 && (profiles[profile - 1].ownPrimitives || profiles[profile - 1].ownIgnoredCalls);
+    }
+
+    const primitiveTypes& getPrimitives(std::size_t profile) const {
+        return profile != 0 && profiles[profile - 1].ownPrimitives ? profiles[profile - 1].primitives : PRIMITIVES;
+    }
+
+    const ignorableCalls& getIgnoredCalls(std::size_t profile) const {
+        return profile != 0 && profiles[profile - 1].ownIgnoredCalls ? profiles[profile - 1].ignoredCalls : IGNORED_CALLS;
+    }
+};
+
+#endif
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file CacheRecord.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef CACHERECORD_HPP
+#define CACHERECORD_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "variable.hpp"
+#include "call.hpp"
+#include "Sha256.hpp"
+
+// Binary records of the analysis cache (--cache)
+// Numbers are 32-bit words in native byte order, hashes are the bytes of a SHA-256 digest, and strings are a length
+//  followed by the bytes
+//
+class cacheWriter {
+public:
+    void        writeInt            (std::int32_t value)            { bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));   }
+    void        writeHash           (const std::string& value)      { bytes.append(value, 0, sha256::DIGEST_SIZE);                           }
+    void        writeBool           (bool value)                    { bytes.push_back(value ? 1 : 0);                                        }
+    void        writeString         (const std::string& value)      { writeInt(value.size()); bytes.append(value);                           }
+    void        writeVariable       (const variable& v) {
+        writeString(v.getName());
+        writeString(v.getType());
+        writeBool(v.getNonPrimitiveExternal());
+        writeBool(v.getNonPrimitive());
+    }
+    void        writeCall           (const call& c) {
+        writeString(c.getName());
+        writeString(c.getArgumentList());
+        writeString(c.getSignature());
+    }
+    template <typename Container, typename Write>
+    void        writeList           (const Container& values, Write write) {
+        writeInt(values.size());
+        for (const auto& value : values) write(value);
+    }
+
+    const std::string&  getBytes    () const                        { return bytes;                                                          }
+    std::string&        getBytes    ()                              { return bytes;                                                          }
+
+private:
+    std::string                                     bytes;
+};
+
+// Reads a record written by cacheWriter. Reading past the end gives zeros and empty strings and makes the reader invalid
+//
+class cacheReader {
+public:
+                cacheReader         (const char* data, std::size_t size) : next(data), end(data + size) {}
+
+    std::int32_t    readInt() {
+        std::int32_t value = 0;
+        read(&value, sizeof(value));
+        return value;
+    }
+    std::string     readHash() {
+        std::string value(sha256::DIGEST_SIZE, '\0');
+        read(&value[0], value.size());
+        return value;
+    }
+    bool            readBool() {
+        char value = 0;
+        read(&value, 1);
+        return value != 0;
+    }
+    std::string     readString() {
+        std::int32_t size = readInt();
+        if (size < 0 || static_cast<std::size_t>(end - next) < static_cast<std::size_t>(size)) {
+            valid = false;
+            return "";
+        }
+        std::string value(next, size);
+        next += size;
+        return value;
+    }
+    variable        readVariable() {
+        variable v;
+        v.setName(readString());
+        v.setType(readString());
+        v.setNonPrimitiveExternal(readBool());
+        v.setNonPrimitive(readBool());
+        return v;
+    }
+    call            readCall() {
+        call c;
+        c.setName(readString());
+        c.setArgumentList(readString());
+        c.setSignature(readString());
+        return c;
+    }
+    template <typename Read>
+    void            readList(Read read) {
+        std::int32_t count = readInt();
+        for (std::int32_t i = 0; i < count && valid; ++i) read();
+    }
+
+    bool            isValid         () const                        { return valid;                                                          }
+    bool            isAtEnd         () const                        { return next == end;                                                    }
+
+private:
+    void            read(void* value, std::size_t size) {
+        if (static_cast<std::size_t>(end - next) < size) {
+            valid = false;
+            next = end;
+            return;
+        }
+        std::memcpy(value, next, size);
+        next += size;
+    }
+
+    const char*                                     next;
+    const char*                                     end;
+    bool                                            valid{true};
+};
+
+#endif
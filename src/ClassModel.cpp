@@ -9,16 +9,27 @@
 
 #include "ClassModel.hpp"
 
-extern XPathBuilder                  XPATH_TRANSFORMATION;  
-
-classModel::classModel(srcml_archive* archive, srcml_unit* unit, const std::string& unitLang) {
+classModel::classModel(srcml_archive* archive, srcml_unit* unit, const std::string& unitLang, const analysisSettings& analysis) {
     unitLanguage = unitLang;
+    settings = &analysis;
     findName(archive, unit);  
+    findKind(unit);
 }
 
-void classModel::findData(srcml_archive* archive, srcml_unit* unit, const std::string& classXpath, int unitNumber) {
-    xpath[unitNumber].push_back(classXpath);
+// Class of a part restored from the analysis cache (--cache), see restorePart()
+//
+classModel::classModel(const std::vector<std::string>& className, const std::string& unitLang, const analysisSettings& analysis) : 
+                       name(className), unitLanguage(unitLang), settings(&analysis) {}
+
+// Finds the data of the class in the unit
+// If 'part' is given, what the unit adds to the class is recorded in it for the analysis cache (the methods are added by the caller)
+//
+void classModel::findData(srcml_archive* archive, srcml_unit* unit, const unitElements& elements, std::size_t classIndex, int unitNumber,
+                          classPart* part) {
+    recordedPart = part;
+    ordinals[unitNumber].push_back(elements.getClass(classIndex));
     if (unitLanguage == "C++") findType(archive, unit); // Needed for findParentClassName()
+    if (part) part->ordinal = elements.getClass(classIndex);
     findParentName(archive, unit); // Requires class type for C++
     
     std::vector<variable> dataMembersOrdered;
@@ -33,18 +44,60 @@ void classModel::findData(srcml_archive* archive, srcml_unit* unit, const std::s
     variable v;
     v.setName("this");
     v.setNonPrimitive(true);
-    dataMembers.insert({v.getName(), v});
+    insertDataMember(v);
+    recordedPart = nullptr;
     
-    findMethod(archive, unit, classXpath, unitNumber);
+    findMethod(archive, unit, elements, classIndex, unitNumber);
+
+    if (unitLanguage == "C#") findMethodInProperty(archive, unit, elements, classIndex, unitNumber); 
+}
+
+// Adds a part of the class read from the analysis cache (--cache) as findData() would, 
+//  and moves its methods (restored from the facts of the part) to the class
+//
+void classModel::restorePart(const classPart& part, int unitNumber, std::vector<methodModel>& partMethods) {
+    ordinals[unitNumber].push_back(part.ordinal);
+    if (kind.empty()) kind = part.kind;
+    if (part.typeFound) type = part.type;
+    for (const auto& parent : part.parentNames) parentNames.insert(parent);
+    for (const variable& v : part.dataMembers) dataMembers.insert({v.getName(), v});
+    for (methodModel& m : partMethods) methods.push_back(std::move(m));
+}
+
+void classModel::insertParentName(const std::string& parentName, const std::string& inheritanceSpecifier) {
+    parentNames.insert({parentName, inheritanceSpecifier});
+    if (recordedPart) recordedPart->parentNames.push_back({parentName, inheritanceSpecifier});
+}
+
+void classModel::insertDataMember(const variable& v) {
+    dataMembers.insert({v.getName(), v});
+    if (recordedPart) recordedPart->dataMembers.push_back(v);
+}
 
-    if (unitLanguage == "C#") findMethodInProperty(archive, unit, classXpath, unitNumber); 
+
+// Analyzes the methods starting at 'first' with the data members and methods of the class found so far
+// Called as soon as a unit is read. Inherited data members and methods (or the ones in other parts of a partial class) 
+//  are not known yet, so references to them are resolved later with methodModel::resolvePending()
+//
+void classModel::findMethodData(std::size_t first) {
+    buildMethodSignature();
+    for (std::size_t i = first; i < methods.size(); ++i)
+        methods[i].findData(dataMembers, methodSignatures, name[3]);
 }
 
+// Number of the first unit that defines the class (partial classes in C# are defined in several units)
+//
+int classModel::getFirstUnitNumber() const {
+    int first = 0;
+    for (const auto& pair : ordinals)
+        if (first == 0 || pair.first < first) first = pair.first;
+    return first;
+}
 
 // Finds class name
 //
 void classModel::findName(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"class_name").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"class_name").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
 
@@ -84,16 +137,35 @@ void classModel::findName(srcml_archive* archive, srcml_unit* unit) {
     srcml_transform_free(result); 
 }
 
+// Finds the kind of the class from the name of its element (class, struct, union, interface, or enum)
+// A profile (-P) only classifies the classes of its kinds (see analysisSettings::isKindClassified())
+//
+void classModel::findKind(srcml_unit* unit) {
+    std::string srcML = srcml_unit_get_srcml(unit);
+    std::size_t start = srcML.find('<');
+    if (srcML.compare(start, 5, "<unit") == 0) start = srcML.find('<', start + 1);
+    if (start == std::string::npos) return;
+
+    std::size_t end = srcML.find_first_of(" \t\r\n/>", start + 1);
+    kind = srcML.substr(start + 1, end - start - 1);
+    std::size_t prefix = kind.find(':');
+    if (prefix != std::string::npos) kind = kind.substr(prefix + 1);
+}
+
 // Determines the class type (class, interface, or struct)
 //
 void classModel::findType(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"class_type").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"class_type").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
 
     if (srcml_transform_get_unit_size(result) == 1) {
         type = srcml_unit_get_srcml(srcml_transform_get_unit(result, 0));
         trimWhitespace(type);
+        if (recordedPart) {
+            recordedPart->typeFound = true;
+            recordedPart->type = type;
+        }
     }
     
     srcml_clear_transforms(archive);
@@ -120,7 +192,7 @@ void classModel::findType(srcml_archive* archive, srcml_unit* unit) {
 //  Uses 'extends' for class-to-class and interface-to-interface inheritance and 'implements' for class-to-interface inheritance
 // 
 void classModel::findParentName(srcml_archive* archive, srcml_unit* unit) { 
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"parent_name").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"parent_name").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -162,11 +234,11 @@ void classModel::findParentName(srcml_archive* archive, srcml_unit* unit) {
             std::string parClassNameLeft = parentName.substr(0, listOpen);
             std::string parClassNameRight = parentName.substr(listOpen, parentName.size() - listOpen);
             removeNamespace(parClassNameLeft, unitLanguage, true); 
-            parentNames.insert({parClassNameLeft + parClassNameRight, inheritanceSpecifier});
+            insertParentName(parClassNameLeft + parClassNameRight, inheritanceSpecifier);
         }
         else {
             removeNamespace(parentName, unitLanguage, true);
-            parentNames.insert({parentName, inheritanceSpecifier});
+            insertParentName(parentName, inheritanceSpecifier);
         }
     
         free(unparsed);      
@@ -187,7 +259,7 @@ void classModel::findParentName(srcml_archive* archive, srcml_unit* unit) {
 //  Therefore, both types of properties will be treated as data members as they can be used and called as normal data members  
 //   where property name = data member name and where property type = data member type 
 void classModel::findDataMemberName(srcml_archive* archive, srcml_unit* unit, std::vector<variable>& dataMembersOrdered) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"data_member_name").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"data_member_name").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -221,7 +293,7 @@ void classModel::findDataMemberName(srcml_archive* archive, srcml_unit* unit, st
 // Only collect the type if there is a name
 //
 void classModel::findDataMemberType(srcml_archive* archive, srcml_unit* unit, std::vector<variable>& dataMembersOrdered, int numOfCurrentDataMembers) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"data_member_type").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"data_member_type").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -246,10 +318,10 @@ void classModel::findDataMemberType(srcml_archive* archive, srcml_unit* unit, st
         }
 
         dataMembersOrdered[numOfCurrentDataMembers + i].setType(type);  
-        dataMembers.insert({dataMembersOrdered[numOfCurrentDataMembers + i].getName(), dataMembersOrdered[numOfCurrentDataMembers + i]});
+        insertDataMember(dataMembersOrdered[numOfCurrentDataMembers + i]);
         bool nonPrimitiveDataMemberExternal = false;
 
-        checkNonPrimitiveType(type, dataMembersOrdered[numOfCurrentDataMembers + i], unitLanguage, name[3]);
+        checkNonPrimitiveType(type, dataMembersOrdered[numOfCurrentDataMembers + i], unitLanguage, name[3], settings->getPrimitives(0));
 
         if (nonPrimitiveDataMemberExternal)
             dataMembersOrdered[numOfCurrentDataMembers + i].setNonPrimitiveExternal(true);
@@ -263,8 +335,8 @@ void classModel::findDataMemberType(srcml_archive* archive, srcml_unit* unit, st
 // Finds methods defined inside the class
 // C#:
 //   Nested local functions within methods in C# are ignored 
-void classModel::findMethod(srcml_archive* archive, srcml_unit* unit, const std::string& classXpath, int unitNumber) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"method").c_str());
+void classModel::findMethod(srcml_archive* archive, srcml_unit* unit, const unitElements& elements, std::size_t classIndex, int unitNumber) {
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"method").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);    
@@ -291,8 +363,7 @@ void classModel::findMethod(srcml_archive* archive, srcml_unit* unit, const std:
         //srcml_archive_read_open_memory(propertyArchive, unparsed, size); // Uncomment when srcML v1.1 is released
         srcml_unit* methodUnit = srcml_archive_read_unit(methodArchive);
         
-        std::string methodXpath = "(" + classXpath + XPATH_TRANSFORMATION.getXpath(unitLanguage,"method") + ")[" + std::to_string(i + 1) + "]";
-        methodModel m = methodModel(methodArchive, methodUnit, methodXpath, unitLanguage, "", unitNumber);
+        methodModel m = methodModel(methodArchive, methodUnit, elements.getMethod(unitLanguage, classIndex, i), unitLanguage, "", unitNumber, *settings);
         
         methods.push_back(m); 
         
@@ -308,8 +379,8 @@ void classModel::findMethod(srcml_archive* archive, srcml_unit* unit, const std:
 // Properties need to be collected separately since they hold the return type of the getters
 // Properties can't be nested in methods or in other properties
 //
-void classModel::findMethodInProperty(srcml_archive* archive, srcml_unit* unit, const std::string& classXpath, int unitNumber) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"property").c_str());
+void classModel::findMethodInProperty(srcml_archive* archive, srcml_unit* unit, const unitElements& elements, std::size_t classIndex, int unitNumber) {
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"property").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);    
@@ -335,7 +406,7 @@ void classModel::findMethodInProperty(srcml_archive* archive, srcml_unit* unit,
         //srcml_archive_read_open_memory(propertyArchive, unparsed, size); // Uncomment when srcML v1.1 is released
         srcml_unit* propertyUnit = srcml_archive_read_unit(propertyArchive);
 
-        srcml_append_transform_xpath(propertyArchive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"property_type").c_str());
+        srcml_append_transform_xpath(propertyArchive, settings->xpaths.getXpath(unitLanguage,"property_type").c_str());
         srcml_transform_result* propertyResult = nullptr;
         srcml_unit_apply_transforms(propertyArchive, propertyUnit, &propertyResult);
         int nType = srcml_transform_get_unit_size(propertyResult);   
@@ -349,7 +420,7 @@ void classModel::findMethodInProperty(srcml_archive* archive, srcml_unit* unit,
             propertyResult = nullptr;
             srcml_clear_transforms(propertyArchive);
 
-            srcml_append_transform_xpath(propertyArchive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"property_method").c_str());
+            srcml_append_transform_xpath(propertyArchive, settings->xpaths.getXpath(unitLanguage,"property_method").c_str());
             srcml_unit_apply_transforms(propertyArchive, propertyUnit, &propertyResult);
             int nMethod = srcml_transform_get_unit_size(propertyResult); 
             for (int j = 0; j < nMethod; j++) {
@@ -368,10 +439,8 @@ void classModel::findMethodInProperty(srcml_archive* archive, srcml_unit* unit,
                 srcml_archive_read_open_memory(methodArchive, methodUnparsed, methodSize);
                 srcml_unit* methodUnit = srcml_archive_read_unit(methodArchive);
 
-                std::string methodXpath = "((" + classXpath + XPATH_TRANSFORMATION.getXpath(unitLanguage,"property") + ")[" + std::to_string(i + 1) + "]";
-                methodXpath += "//src:function)[" + std::to_string(j + 1) + "]";
-
-                methodModel m = methodModel(methodArchive, methodUnit, methodXpath, unitLanguage, typeUnparsed, unitNumber);
+                int ordinal = elements.getPropertyMethod(classIndex, i, j);
+                methodModel m = methodModel(methodArchive, methodUnit, ordinal, unitLanguage, typeUnparsed, unitNumber, *settings);
 
                 methods.push_back(m); 
 
@@ -393,15 +462,3 @@ void classModel::findMethodInProperty(srcml_archive* archive, srcml_unit* unit,
     srcml_clear_transforms(archive);
     srcml_transform_free(result);
 }
-
-
-std::string classModel::getStereotype () const {
-    std::string result;
-
-    for (const std::string &value : stereotype)
-        result += value + " ";
-
-    Rtrim(result);
-     
-    return result;
-}
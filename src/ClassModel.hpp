@@ -11,37 +11,63 @@
 #define CLASSMODEL_HPP
 
 #include "MethodModel.hpp"
+#include "UnitElements.hpp"
+
+// What a class (or a part of a partial class in C#) in a unit adds to its class model
+// Kept for units with the same content and in the analysis cache (--cache)
+// Parents and data members are the insertions in the order they were attempted, so a merged partial class ends up the same
+//
+struct classPart {
+    std::vector<std::string>                                name;                            // Name of the class in the unit (see classModel::name)
+    std::string                                             kind;                            // See classModel::findKind()
+    int                                                     ordinal{-1};                     // Element ordinal in the unit
+    bool                                                    typeFound{false};                // Was the class type found? (C++ only)
+    std::string                                             type;
+    std::vector<std::pair<std::string, std::string>>        parentNames;
+    std::vector<variable>                                   dataMembers;                     // Including "this"
+    std::vector<std::string>                                methods;                         // Facts of the methods (see methodModel::writeFacts())
+    std::size_t                                             firstMethod{0};                  // Position of the methods of the part in its class (not cached)
+    std::size_t                                             methodCount{0};
+};
 
 class classModel {
 public:
-         classModel                         (srcml_archive*, srcml_unit*, const std::string&);
+         classModel                         (srcml_archive*, srcml_unit*, const std::string&, const analysisSettings&);
+         classModel                         (const std::vector<std::string>&, const std::string&, const analysisSettings&);
          
     void findName                           (srcml_archive*, srcml_unit*);
+    void findKind                           (srcml_unit*);
     void findType                           (srcml_archive*, srcml_unit*);
     void findParentName                     (srcml_archive*, srcml_unit*);
     void findDataMemberName                 (srcml_archive*, srcml_unit*, std::vector<variable>&);
     void findDataMemberType                 (srcml_archive*, srcml_unit*, std::vector<variable>&, int);
-    void findMethod                         (srcml_archive*, srcml_unit*, const std::string&, int);
-    void findMethodInProperty               (srcml_archive*, srcml_unit*, const std::string&, int);
-    void findData                           (srcml_archive*, srcml_unit*, const std::string&, int);
+    void findMethod                         (srcml_archive*, srcml_unit*, const unitElements&, std::size_t, int);
+    void findMethodInProperty               (srcml_archive*, srcml_unit*, const unitElements&, std::size_t, int);
+    void findData                           (srcml_archive*, srcml_unit*, const unitElements&, std::size_t, int, classPart* = nullptr);
+    void findMethodData                     (std::size_t);
+    void restorePart                        (const classPart&, int, std::vector<methodModel>&);
+    void insertParentName                   (const std::string&, const std::string&);
+    void insertDataMember                   (const variable&);
 
-    std::string                                               getStereotype                      ()               const;
+    std::string                                               getStereotype                      ()               const          { return stereotypeLabel(stereotype, CLASS_STEREOTYPE_LABELS); }
     std::unordered_map<std::string, variable>&                getDataMembers                     ()                              { return dataMembers;                            }
     std::vector<methodModel>&                                 getMethods                         ()                              { return methods;                                }
     
     const std::string&                                        getUnitLanguage                    ()               const          { return unitLanguage;                           }
     const std::vector<std::string>&                           getName                            ()               const          { return name;                                   }
-    const std::vector<std::string>&                           getStereotypeList                  ()               const          { return stereotype;                             }
+    const std::string&                                        getKind                            ()               const          { return kind;                                   }
+    std::uint32_t                                             getStereotypeMask                  ()               const          { return stereotype;                             }
     const std::unordered_map<std::string, std::string>&       getParentClassName                 ()               const          { return parentNames;                            }  
     const std::unordered_set<std::string>&                    getMethodSignatures                ()               const          { return methodSignatures;                       }    
-    const std::unordered_map<int, std::vector<std::string>>&  getXpath                           ()               const          { return xpath;                                  }    
+    const std::unordered_map<int, std::vector<int>>&          getOrdinals                        ()               const          { return ordinals;                               }    
     int                                                       getConstructorDestructorCount      ()               const          { return constructorDestructorCount;             }
+    int                                                       getFirstUnitNumber                 ()               const;
     bool                                                      isInherited                        ()               const          { return inherited;                              }
     bool                                                      isVisited                          ()               const          { return visited;                                }
     
     void                                                      setInherited                       (bool flag)                     { inherited = flag;                              }
     void                                                      setVisited                         (bool flag)                     { visited = flag;                                }
-    void                                                      setStereotype                      (const std::string& s)          { stereotype.push_back(s);                       }
+    void                                                      setStereotype                      (std::uint32_t mask)            { stereotype = mask;                             }
     void                                                      setConstructorDestructorCount      (int c)                         { constructorDestructorCount = c;                }
     
     void addMethod(methodModel& m)  { methods.push_back(m); }
@@ -62,15 +88,18 @@ private:
     std::vector<std::string>                                name;                            // Size = 4 containing | Original name | name without whitespaces | name without whitespaces, namespaces, and generic types in <> | same as last but without <>
     std::unordered_map<std::string, std::string>            parentNames;                     // Key is parent class name without whitespaces and namespaces and value is specifier (public, private, or protected).
     std::string                                             type;                            // Class, or struct, or an interface
+    std::string                                             kind;                            // Element name of the class (e.g., struct), found in all languages
     std::string                                             unitLanguage;                    // Unit language
-    std::vector<std::string>                                stereotype;                      // Class stereotype(s)
+    std::uint32_t                                           stereotype{0};                   // Class stereotype(s) as a mask of classStereotype bits
     std::vector<methodModel>                                methods;                         // List of methods 
     std::unordered_set<std::string>                         methodSignatures;                // List of method signatures (including parent method signatures)
     std::unordered_map<std::string, variable>               dataMembers;                     // Key is data member name and value is data member object (including inherited data members)
-    std::unordered_map<int, std::vector<std::string>>       xpath;                           // Unique xpath for class (classs if partial in C#) along with the unit number
+    std::unordered_map<int, std::vector<int>>               ordinals;                        // Element ordinal of the class (classs if partial in C#) in each unit. Key is unit number
     bool                                                    inherited{false};                // Did class inherit the data members yet? (Used for inheritance)
     bool                                                    visited{false};                  // Has class been visited yet when inheriting? (Used for inheritance)    
     int                                                     constructorDestructorCount{0};   // Number of constructor + destructor methods (Needed for class stereotypes)
+    classPart*                                              recordedPart{nullptr};           // Part being recorded for the analysis cache by findData() (--cache)
+    const analysisSettings*                                 settings{nullptr};               // Settings of the analysis that found the class
 }; 
 
 #endif
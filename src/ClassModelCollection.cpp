@@ -9,198 +9,708 @@
 
 #include "ClassModelCollection.hpp"
 
-extern XPathBuilder                  XPATH_TRANSFORMATION;  
-extern std::unordered_map
-       <int, std::unordered_map
-       <std::string, std::string>>   XPATH_LIST;   
 extern primitiveTypes                PRIMITIVES;
 extern ignorableCalls                IGNORED_CALLS;
 extern typeModifiers                 TYPE_MODIFIERS;  
-extern bool                          IS_VERBOSE;
-extern bool                          FREE_FUNCTION;
 
-classModelCollection::classModelCollection(srcml_archive* archive, srcml_archive* outputArchive,
-                                                    const std::string& inputFile, const std::string& outputFile, 
-                                                    bool outputTxtReport, bool outputCsvReport, bool reDocComment) {  
+// Names of the analysis stages (analysisTier) used in the verbose output and the events (--events)
+static const std::vector<std::string> ANALYSIS_TIER_NAMES = {"full", "constructor-destructor", "main", "empty", "simple-return"};
+
+// Settings that change what is extracted from a unit. The analysis cache (--cache) is only used with the same settings
+//
+static std::string analysisCacheKey(const analysisSettings& settings, bool writeArchive, bool annotateUnits) {
+    std::string key;
+    for (bool flag : {settings.freeFunction, settings.extractedStructs, settings.extractedInterfaces, settings.extractedUnions, settings.extractedEnums, writeArchive, annotateUnits,
+                      settings.fastPaths})
+        key += flag ? '1' : '0';
+    for (const std::unordered_set<std::string>* userList : 
+         {&PRIMITIVES.getUserPrimitives(), &IGNORED_CALLS.getUserCalls(), &TYPE_MODIFIERS.getUserModifiers()}) {
+        std::vector<std::string> sorted(userList->begin(), userList->end());
+        std::sort(sorted.begin(), sorted.end());
+        key += '\n';
+        for (const std::string& entry : sorted) key += entry + '\t';
+    }
+    return key;
+}
+
+// Counts how many methods (and free functions if analyzed) were decided at each analysis stage
+//
+static void countAnalysisTiers(const analysisSettings& settings, std::vector<int>& tierCount, 
+                               std::unordered_map<std::string, classModel>& classes, const std::vector<methodModel>& functions) {
+    tierCount.resize(ANALYSIS_TIER_NAMES.size(), 0);
+    for (auto& pair : classes)
+        for (const auto& m : pair.second.getMethods()) ++tierCount[m.getAnalysisTier()];
+    if (settings.freeFunction)
+        for (const auto& f : functions) ++tierCount[f.getAnalysisTier()];
+}
+
+// The settings are prepared by the caller (see analysisSettings::prepare()) and must outlive the collection
+//
+classModelCollection::classModelCollection(const analysisSettings& analysis, srcml_archive* archive, srcml_archive* outputArchive,
+                                                    const std::string& inputFile, 
+                                                    bool outputTxtReport, bool outputCsvReport, bool outputRollup, bool reDocComment,
+                                                    const std::string& sidecarFile, std::ostream* events,
+                                                    const std::string& factsFile, const analysisCallbacks* resultCallbacks,
+                                                    const std::function<int(srcml_archive*)>& reopenInput) : settings(analysis) {  
+    callbacks = resultCallbacks;
+    reopen = reopenInput;
     PRIMITIVES.createPrimitiveList();
     IGNORED_CALLS.createCallList();
     TYPE_MODIFIERS.createModifierList();
 
-    if (IS_VERBOSE) {
+    if (settings.verbose) {
         PRIMITIVES.outputPrimitives();
         IGNORED_CALLS.outputCalls();
         TYPE_MODIFIERS.outputModifiers();
+        settings.rules.outputRules("Stereotype Rules");
+        for (auto& profile : settings.profiles) profile.rules.outputRules("Stereotype Rules: " + profile.name);
     }
-        
-    // Analyze one unit at a time
+
+    if (settings.twoPhase) {
+        analyzeInTwoPhases(archive, outputArchive, inputFile, outputTxtReport, outputCsvReport, outputRollup, reDocComment, 
+                           sidecarFile, events);
+        return;
+    }
+
+    // The default mode reads and extracts every unit, resolves the models against the classes of all units,
+    //  classifies them with the default settings and each profile, and then outputs the annotated units
+    // Without an output archive (--no-archive) or a sidecar, units are not kept and element ordinals are not needed
+    // Units given to a callback are annotated as if they were written to an output archive
+    unitReads reads;
+    reads.writeArchive = outputArchive != nullptr || (callbacks && callbacks->unitAnnotated);
+    reads.annotateUnits = reads.writeArchive || sidecarFile != "";
+    if (!readUnits(archive, inputFile, outputRollup, reads)) {
+        for (srcml_unit* retained : reads.retainedUnits) srcml_unit_free(retained);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        if (outputArchive) {
+            srcml_archive_close(outputArchive);
+            srcml_archive_free(outputArchive);
+        }
+        if (reads.spool) std::fclose(reads.spool);
+        return;
+    }
+
+    resolveModels();
+    if (settings.cacheFile != "") writeAnalysisCache(reads);
+    classifyModels(inputFile, outputTxtReport, outputCsvReport, outputRollup, events, factsFile);
+    outputUnits(archive, outputArchive, inputFile, reDocComment, sidecarFile, reads);
+}
+
+// Reads every unit once and extracts its classes and free functions (see extractUnit())
+// Units are kept for output generation while their srcML fits in the memory budget (-b)
+// Once a unit does not fit, it and all later units are freed and read again for output
+// Input from stdin (-) cannot be read again, so the srcML of those units is spooled to a temporary file instead
+// Returns false if a unit cannot be spooled (see getError())
+//
+bool classModelCollection::readUnits(srcml_archive* archive, const std::string& inputFile, bool outputRollup, unitReads& reads) {
+    reads.budget = reads.annotateUnits ? settings.memoryBudget * 1024 * 1024 : 0;
+    reads.cacheKey = analysisCacheKey(settings, reads.writeArchive, reads.annotateUnits);
+    reads.cacheRead = settings.cacheFile != "" && reads.cache.read(settings.cacheFile, reads.cacheKey);
+
     srcml_unit* unit = srcml_archive_read_unit(archive);
-    int unitNumber = 1; // Count starts at 1 in XPath
+    int unitNumber = 1; // Unit numbers start at 1
     while (unit){
-        findClassInfo(archive, unit, unitNumber); 
-        findFreeFunctions(archive, unit, unitNumber);
-
-        srcml_unit_free(unit); 
+        const char* unitSrcML = srcml_unit_get_srcml(unit);
+        std::size_t unitBytes = std::strlen(unitSrcML);
+        reads.analysisBytes += unitBytes;
+        const char* unitFilename = srcml_unit_get_filename(unit);
+        unitFilenames.push_back(unitFilename ? unitFilename : "");
+        if (outputRollup) unitNamespaces.push_back(unitElements::findNamespace(unitSrcML, unitBytes));
+
+        // Units without classes or functions are not analyzed and are output as they are
+        if (unitElements::hasDefinitions(unitSrcML, unitBytes))
+            extractUnit(archive, unit, unitNumber, unitBytes, reads);
+        else
+            ++reads.skippedUnits;
+
+        if (!reads.overBudget && reads.retainedBytes + unitBytes <= reads.budget) {
+            reads.retainedUnits.push_back(unit);
+            reads.retainedBytes += unitBytes;
+        }
+        else {
+            reads.overBudget = true;
+            if (reads.annotateUnits && inputFile == "-" && !reopen) {
+                if (reads.spool == nullptr) reads.spool = std::tmpfile();
+                if (reads.spool == nullptr || std::fwrite(&unitBytes, sizeof(unitBytes), 1, reads.spool) != 1 ||
+                    std::fwrite(unitSrcML, 1, unitBytes, reads.spool) != unitBytes) {
+                    error = "Cannot spool the units read from stdin to a temporary file";
+                    srcml_unit_free(unit);
+                    return false;
+                }
+                ++reads.spooledUnits;
+                reads.spooledBytes += unitBytes;
+            }
+            srcml_unit_free(unit); 
+        }
         ++unitNumber;
         unit = srcml_archive_read_unit(archive);
     }
 
-    // Performed after the collection of all classes and free functions
-    analyzeFreeFunctions();
+    if (settings.verbose) {
+        std::cerr << "---Unit Deduplication---";
+        std::cerr << "\n[duplicate units]: " << reads.duplicateUnits;
+        std::cerr << "\n[deduplicated bytes]: " << reads.duplicateBytes;
+        std::cerr << "\n[time saved (ms)]: " << static_cast<long long>(reads.savedSeconds * 1000);
+        std::cerr << "\n\n";
+    }
+    return true;
+}
 
-    // Finds inherited data members
-    for (auto& pair : classCollection) {
-        findInheritedDataMembers(pair.second);
-        pair.second.setInherited(true);
-        for (auto& pairS : classCollection)
-            pairS.second.setVisited(false);
-    } 
+// Finds the classes and free functions of a unit
+// A unit with the same content as an earlier unit (e.g., a vendored copy) copies what was found in it,
+//  and a unit found in the analysis cache (--cache) is restored. Other units are extracted
+// The content hash (SHA-256) leaves out the file name. The first unit with each content is kept
+// The class parts of the units that are not restored are recorded for the cache as they are found,
+//  and their free functions once they are extracted (see addCachedUnits())
+// Without an output archive, C# and Java free functions are only collected if they are classified (-f)
+//
+void classModelCollection::extractUnit(srcml_archive* archive, srcml_unit* unit, int unitNumber, std::size_t unitBytes, unitReads& reads) {
+    auto secondsSince = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
 
-    // Resets inheritance and build signatures for findInheritedMethods()
-    for (auto& pair : classCollection) {
-        pair.second.setInherited(false); 
-        pair.second.buildMethodSignature();
+    const char* unitSrcML = srcml_unit_get_srcml(unit);
+    const char* unitFilename = srcml_unit_get_filename(unit);
+    std::string unitLanguage = srcml_unit_get_language(unit);
+    std::string unitHash = settings.cacheFile != "" ? analysisCache::hashUnit(unitSrcML, unitBytes) : "";
+    std::string contentHash = analysisCache::hashUnit(unitSrcML, unitBytes, false);
+    std::size_t contentBytes = unitBytes - (unitFilename ? std::strlen(unitFilename) : 0);
+    auto start = std::chrono::steady_clock::now();
+    auto original = reads.foundUnits.find(contentHash);
+    if (original != reads.foundUnits.end() && original->second.contentBytes == contentBytes && 
+        copyUnit(original->second, unitNumber, unitLanguage)) {
+        if (original->second.cacheRecord)
+            reads.cache.addUnit(unitNumber, unitHash, *original->second.cacheRecord);
+        else if (settings.cacheFile != "")
+            reads.analyzedParts[unitNumber] = {unitHash, &original->second.parts};
+        ++reads.duplicateUnits;
+        reads.duplicateBytes += unitBytes;
+        reads.savedSeconds += original->second.seconds - secondsSince(start);
+        return;
     }
-        
-    // Finds inherited methods
-    for (auto& pair : classCollection) {
-        findInheritedMethods(pair.second);
-        pair.second.setInherited(true);
-        for (auto& pairS : classCollection)
-            pairS.second.setVisited(false);
-    } 
 
-    // Analyze all methods for each class
+    foundUnit found;
+    found.contentBytes = contentBytes;
+    found.firstFunction = freeFunctions.size();
+    const std::string* cachedUnit = reads.cacheRead ? reads.cache.find(unitHash) : nullptr;
+    if (cachedUnit && restoreUnit(archive, unit, unitNumber, unitLanguage, *cachedUnit, found.parts)) {
+        reads.cache.addUnit(unitNumber, unitHash, *cachedUnit);
+        found.cacheRecord = cachedUnit;
+        ++reads.restoredUnits;
+        reads.restoredBytes += unitBytes;
+    }
+    else {
+        ++reads.analyzedUnits;
+        unitElements elements = reads.annotateUnits ? unitElements(unitSrcML, unitLanguage, settings) : unitElements();
+        findClassInfo(archive, unit, elements, unitNumber, classCollection, false, &found.parts); 
+        if (reads.writeArchive || settings.freeFunction || unitLanguage == "C++")
+            findFreeFunctions(archive, unit, elements, unitNumber, freeFunctions);
+    }
+    found.functionCount = freeFunctions.size() - found.firstFunction;
+    found.seconds = secondsSince(start);
+
+    // Units that could not copy the unit with the same content keep their parts for the cache only
+    auto first = reads.foundUnits.try_emplace(contentHash, std::move(found));
+    const foundUnit& kept = first.second ? first.first->second : reads.uncopiedUnits.emplace_back(std::move(found));
+    if (settings.cacheFile != "" && kept.cacheRecord == nullptr) 
+        reads.analyzedParts[unitNumber] = {unitHash, &kept.parts};
+}
+
+// Performed after the collection of all classes and free functions
+// Methods were analyzed when their unit was read, so only references that needed 
+//  inherited data members or methods are re-checked
+// Methods defined outside of their class (C++) are analyzed here for the first time
+//
+void classModelCollection::resolveModels() {
+    analyzeFreeFunctions();
+
+    findInheritance();
+
     for (auto& pair : classCollection) {
         std::vector<methodModel>& methods = pair.second.getMethods();
-        for (auto& m : methods)
-             m.findData(pair.second.getDataMembers(), pair.second.getMethodSignatures(), pair.second.getName()[3]);                         
+        for (auto& m : methods) {
+            if (m.isAnalyzed())
+                m.resolvePending(pair.second.getDataMembers(), pair.second.getMethodSignatures());
+            else
+                m.findData(pair.second.getDataMembers(), pair.second.getMethodSignatures(), pair.second.getName()[3]);                         
+        }
     }
 
-    // Compute stereotypes here
-    stereotypes stereotypesObj;
-    stereotypesObj.computeMethodStereotypes (classCollection);
-    stereotypesObj.computeClassStereotypes  (classCollection);
-
-    // Analyze and compute stereotypes for free functions
-    if (FREE_FUNCTION) {
+    // Free functions are analyzed once for all profiles (except copies for profiles with their own tables, see copyModelsForPass())
+    if (settings.freeFunction)
         for (auto& f : freeFunctions) f.findFreeFunctionData();
-        stereotypesObj.computeFreeFunctionsStereotypes(freeFunctions);
+}
+
+// Rewrites the analysis cache (--cache) with the units of this run
+//
+void classModelCollection::writeAnalysisCache(unitReads& reads) {
+    addCachedUnits(reads.cache, reads.analyzedParts);
+    if (!reads.cache.write(settings.cacheFile, reads.cacheKey))
+        std::cerr << "Error: Cannot write the analysis cache: " << settings.cacheFile << '\n';
+
+    if (settings.verbose) {
+        std::cerr << "---Analysis Cache---";
+        std::cerr << "\n[cached units read]: " << reads.cache.getReadUnitCount();
+        std::cerr << "\n[restored units]: " << reads.restoredUnits;
+        std::cerr << "\n[restored bytes]: " << reads.restoredBytes;
+        std::cerr << "\n[analyzed units]: " << reads.analyzedUnits;
+        std::cerr << "\n\n";
     }
-    
-    // Optional TXT report file
-    std::string InputFileNoExt = inputFile.substr(0, inputFile.size() - 4);
-    if (outputTxtReport) {
-        std::ofstream reportFile(InputFileNoExt + ".stereotypes.txt");
-        std::stringstream stringStream;
-        for (auto& pair : classCollection)  outputTxtReportFile(stringStream, &pair.second);
-        reportFile << stringStream.str();
-        reportFile.close();         
-
-        stringStream.str("");
-        stringStream.clear();
-        reportFile.open(InputFileNoExt + ".free_functions_stereotypes.txt");
-        outputTxtReportFile(stringStream, nullptr);
-        reportFile << stringStream.str();
-        reportFile.close();   
-    }
-
-    // Optional CSV report file
-    if (outputCsvReport) {
-        std::ofstream out;
-        out.open(InputFileNoExt + ".stereotypes.csv");
-        out << "Class Name,Class Stereotype,Method Name,Method Stereotype" << '\n';
-        for (auto& pair : classCollection) outputCsvReportFile(out, &pair.second);        
-        out.close();
-
-        out.open(InputFileNoExt + ".free_functions_stereotypes.csv");
-        out << "Free Function Name,Free Function Stereotype" << '\n';
-        outputCsvReportFile(out, nullptr);        
-        out.close();
-    }
-
-    // Optional verbose output
-    if (IS_VERBOSE) outputCsvVerboseReportFile(InputFileNoExt);
-    
-    // Generate the stereotyped XML archive
-    std::map<int, srcml_unit*> transformedUnits;
-    std::unordered_map<int, srcml_transform_result*> results;
+}
 
-    std::vector<std::thread> threads;
-    std::vector<srcml_unit*> units;
-    std::mutex mu;
+// Compute stereotypes with the default settings and then with each profile
+// Only the classification is repeated, and each pass overwrites the stereotypes of the models
+//  after its reports are written. The output archive gets the stereotypes of every pass from the annotations
+// A pass with its own kinds of classes or tables classifies a copy of the models instead (see copyModelsForPass())
+// Stereotypes depend on inherited members from any unit, so they are final once a pass is classified
+//  and the events (--events) of the pass are written before its reports and the output archive
+// The fact store (--facts) gets the facts once and the stereotypes of every pass
+//
+void classModelCollection::classifyModels(const std::string& inputFile, bool outputTxtReport, bool outputCsvReport, bool outputRollup,
+                                          std::ostream* events, const std::string& factsFile) {
+    std::string InputFileNoExt = archiveNameNoExt(inputFile);
+    factStore facts;
+    if (factsFile != "") facts.addFacts(classCollection, freeFunctions, unitFilenames);
+    stereotypes stereotypesObj(annotations);
+    for (std::size_t profile = 0; profile <= settings.profiles.size(); ++profile) {
+        const stereotypeRules& rules = profile == 0 ? settings.rules : settings.profiles[profile - 1].rules;
+        std::unordered_map<std::string, classModel> passClasses;
+        std::vector<methodModel> passFunctions;
+        const bool ownModels = copyModelsForPass(profile, classCollection, freeFunctions, passClasses, passFunctions);
+        std::unordered_map<std::string, classModel>& classes = ownModels ? passClasses : classCollection;
+        std::vector<methodModel>& functions = ownModels ? passFunctions : freeFunctions;
+
+        stereotypes passStereotypes(annotations);
+        stereotypes& classifier = ownModels ? passStereotypes : stereotypesObj;
+        classifier.computeMethodStereotypes (classes, rules, profile);
+        classifier.computeClassStereotypes  (classes, rules, profile);
+        if (settings.freeFunction) classifier.computeFreeFunctionsStereotypes(functions, rules, profile);
+        if (events) outputEvents(*events, profile, classes, functions);
+        if (callbacks) notifyElements(profile, classes, functions);
+        if (factsFile != "") facts.addStereotypes(profile == 0 ? "" : settings.profiles[profile - 1].name, classes, functions);
+
+        std::string reportFileNoExt = InputFileNoExt;
+        if (profile != 0) reportFileNoExt += "." + settings.profiles[profile - 1].name;
+        outputReportFiles(reportFileNoExt, outputTxtReport, outputCsvReport, outputRollup, classes, functions);
+    }
 
-    unsigned int unitNumberCount = 1;
-    unsigned int threadPoolCount = 0;
-    unsigned int nthreads = std::thread::hardware_concurrency();
+    if (events) events->flush();
+    if (factsFile != "" && !facts.write(factsFile))
+        std::cerr << "Error: Cannot write the fact store: " << factsFile << '\n';
 
-    // Read all units in the archive again for output generation
-    srcml_archive_close(archive);
-    srcml_archive_free(archive);
+    if (settings.verbose) {
+        std::vector<int> tierCount;
+        countAnalysisTiers(settings, tierCount, classCollection, freeFunctions);
+        outputAnalysisTiers(tierCount);
+    }
+}
 
-    archive = srcml_archive_create();
-    srcml_archive_read_open_filename(archive, inputFile.c_str()); 
-    unit = srcml_archive_read_unit(archive);
+// Copies the models for a pass whose kinds of classes (kinds=) or tables (primitive-file=, ignore-call-file=) 
+//  differ from the facts extracted. The copy only has the classes of the kinds of the pass, and its methods and 
+//  free functions are analyzed again with the tables of the pass
+// Returns false (and copies nothing) if the pass classifies the models as they are
+//
+bool classModelCollection::copyModelsForPass(std::size_t profile,
+                                             std::unordered_map<std::string, classModel>& classes, std::vector<methodModel>& functions,
+                                             std::unordered_map<std::string, classModel>& passClasses,
+                                             std::vector<methodModel>& passFunctions) const {
+    if (!settings.hasOwnModels(profile)) return false;
+
+    const bool ownTables = settings.hasOwnTables(profile);
+    for (auto& pair : classes) {
+        if (!settings.isKindClassified(pair.second.getKind(), profile)) continue;
+        classModel& c = passClasses.insert(pair).first->second;
+        if (ownTables)
+            for (auto& m : c.getMethods()) m.reanalyze(profile, &c.getDataMembers(), &c.getMethodSignatures());
+    }
+    passFunctions = functions;
+    if (ownTables)
+        for (auto& f : passFunctions) f.reanalyze(profile, nullptr, nullptr);
+    return true;
+}
 
-    while (unit){
-        while ((threadPoolCount < nthreads) && unit) {
-            units.push_back(unit);
-            threads.push_back(std::thread(&classModelCollection::outputWithStereotypes, this, 
-                                        unit, std::ref(transformedUnits), unitNumberCount,  
-                                        std::ref(XPATH_LIST[unitNumberCount]), std::ref(results), std::ref(mu)));
+// Generate the stereotyped XML archive
+// Retained units are output first. Units past the memory budget are read back from the spool, or read again 
+//  from the input archive after skipping the retained ones
+// Both archives are closed and freed
+//
+void classModelCollection::outputUnits(srcml_archive* archive, srcml_archive* outputArchive, const std::string& inputFile, 
+                                       bool reDocComment, const std::string& sidecarFile, unitReads& reads) {
+    std::size_t nextRetained = 0;
+    std::size_t nextSpooled = 0;
+    std::size_t rereadUnits = 0;
+    std::size_t rereadBytes = 0;
+    bool reopened = false;
+    auto nextUnit = [&]() -> std::unique_ptr<annotatedUnit> {
+        std::unique_ptr<annotatedUnit> next(new annotatedUnit);
+        if (nextRetained < reads.retainedUnits.size()) {
+            next->original = next->unit = reads.retainedUnits[nextRetained++];
+            return next;
+        }
+        if (!reads.overBudget) return nullptr;
 
-            unit = srcml_archive_read_unit(archive);
+        if (reads.spool) {
+            if (nextSpooled == reads.spooledUnits) return nullptr;
+            if (nextSpooled == 0) std::rewind(reads.spool);
 
-            ++unitNumberCount;
-            ++threadPoolCount;
+            std::size_t size = 0;
+            if (std::fread(&size, sizeof(size), 1, reads.spool) != 1) {
+                error = "Cannot read the units spooled to a temporary file";
+                return nullptr;
+            }
+            next->originalSrcML.resize(size);
+            if (std::fread(&next->originalSrcML[0], 1, size, reads.spool) != size) {
+                error = "Cannot read the units spooled to a temporary file";
+                return nullptr;
+            }
+            next->originalArchive = srcml_archive_create();
+            srcml_archive_read_open_memory(next->originalArchive, next->originalSrcML.c_str(), size);
+            next->original = next->unit = srcml_archive_read_unit(next->originalArchive);
+            ++nextSpooled;
+            return next;
         }
 
-        for (std::thread& thread : threads) if (thread.joinable()) thread.join();
-        threads.clear();
+        if (!reopened) {
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+
+            archive = srcml_archive_create();
+            int openError = reopen ? reopen(archive) : openInputArchive(archive, inputFile);
+            if (openError) {
+                error = "Cannot open the input archive again: " + inputFile;
+                return nullptr;
+            }
+            for (std::size_t i = 0; i < reads.retainedUnits.size(); ++i) {
+                srcml_unit* skipped = srcml_archive_read_unit(archive);
+                if (skipped == nullptr) {
+                    error = "The input archive changed while it was analyzed: " + inputFile;
+                    return nullptr;
+                }
+                rereadBytes += std::strlen(srcml_unit_get_srcml(skipped));
+                srcml_unit_free(skipped);
+            }
+            reopened = true;
+        }
+
+        srcml_unit* reread = srcml_archive_read_unit(archive);
+        if (reread == nullptr) return nullptr;
+        ++rereadUnits;
+        rereadBytes += std::strlen(srcml_unit_get_srcml(reread));
+        next->original = next->unit = reread;
+        return next;
+    };
+
+    if (reads.annotateUnits) outputAnnotatedUnits(archive, outputArchive, reDocComment, sidecarFile, nextUnit);
+    srcml_archive_close(archive);
+    srcml_archive_free(archive);
+    if (reads.spool) std::fclose(reads.spool);
+
+    if (settings.verbose) {
+        std::cerr << "---Input Reads---";
+        std::cerr << "\n[analysis bytes]: " << reads.analysisBytes;
+        std::cerr << "\n[units without classes or functions]: " << reads.skippedUnits;
+        std::cerr << "\n[retained units]: " << reads.retainedUnits.size();
+        std::cerr << "\n[retained bytes]: " << reads.retainedBytes;
+        std::cerr << "\n[output re-read units]: " << rereadUnits;
+        std::cerr << "\n[output re-read bytes]: " << rereadBytes;
+        std::cerr << "\n[spooled units]: " << reads.spooledUnits;
+        std::cerr << "\n[spooled bytes]: " << reads.spooledBytes;
+        std::cerr << "\n\n";
+    }
+}
 
-        // Write output
-        for (const auto& pair : transformedUnits) srcml_archive_write_unit(outputArchive, pair.second); 
-        transformedUnits.clear();
+// Analysis in two passes over the input archive (--two-phase) that keeps only the class skeletons
+//  and the units in flight in memory
+//
+// The skeleton pass reads each unit once and keeps only the names, parents, data members, and method signatures
+//  of the classes. Methods are not analyzed, and only the name signatures of the methods defined outside
+//  of their class (C++) are kept to find their class. Inheritance is then resolved on the skeletons, and the number 
+//  of units that define each class (including its methods defined outside of it) is counted
+//
+// The streaming pass reads the units again. The methods of a unit are analyzed as in the default mode, first with 
+//  the data members of the class found so far and then re-checked against the skeleton (see resolvePending()),
+//  and the free functions are analyzed and classified right away. Once all the units of a class are read, the class 
+//  is classified with the default settings and each profile, its rows are added to the report files, and it is freed
+// A unit is written to the output archive (and the sidecar) as soon as all of its classes are classified, 
+//  so units are only kept while a class they define is still waiting for a later unit
+// Units are written in order, so the units after a waiting unit are kept too. A header whose methods are defined
+//  in a late unit (C++) keeps every unit read in between, and memory then grows with the distance between them
+//  (see [max units in flight] and [max bytes in flight] of -v)
+// The results are the same as the default mode, but the rows of the report files and the events 
+//  are in the order that the classes are finished. The fact store (--facts) is not supported
+//
+void classModelCollection::analyzeInTwoPhases(srcml_archive* archive, srcml_archive* outputArchive, const std::string& inputFile,
+                                              bool outputTxtReport, bool outputCsvReport, bool outputRollup, bool reDocComment,
+                                              const std::string& sidecarFile, std::ostream* events) {
+    const bool writeArchive = outputArchive != nullptr || (callbacks && callbacks->unitAnnotated);
+    const bool annotateUnits = writeArchive || sidecarFile != "";
+    const unitElements noElements;
+
+    // Skeleton pass
+    std::size_t skeletonBytes = 0;
+    srcml_unit* unit = srcml_archive_read_unit(archive);
+    int unitNumber = 1; // Unit numbers start at 1
+    while (unit) {
+        const char* unitSrcML = srcml_unit_get_srcml(unit);
+        std::size_t unitBytes = std::strlen(unitSrcML);
+        skeletonBytes += unitBytes;
+        const char* unitFilename = srcml_unit_get_filename(unit);
+        unitFilenames.push_back(unitFilename ? unitFilename : "");
+        if (outputRollup) unitNamespaces.push_back(unitElements::findNamespace(unitSrcML, unitBytes));
+
+        if (unitElements::hasDefinitions(unitSrcML, unitBytes)) {
+            findClassInfo(archive, unit, noElements, unitNumber, classCollection, true);
+            if (std::string(srcml_unit_get_language(unit)) == "C++") {
+                std::vector<methodModel> functions;
+                findFreeFunctions(archive, unit, noElements, unitNumber, functions);
+                for (auto& f : functions) {
+                    if (f.getName().find("::") == std::string::npos) continue;
+                    f.releaseSrcML();
+                    freeFunctions.push_back(f);
+                }
+            }
+        }
+        srcml_unit_free(unit);
+        ++unitNumber;
+        unit = srcml_archive_read_unit(archive);
+    }
 
-        // Clean
-        for (auto& pair : results) srcml_transform_free(pair.second);  
-        results.clear();
+    analyzeFreeFunctions();
+    freeFunctions.clear();
+    freeFunctions.shrink_to_fit();
 
-        for (auto& u : units) srcml_unit_free(u); 
-        units.clear();
+    std::unordered_map<std::string, int> remainingUnits;    // Units of each class not read yet by the streaming pass
+    for (auto& pair : classCollection) {
+        std::unordered_set<int> classUnits;
+        for (const auto& ordinal : pair.second.getOrdinals()) classUnits.insert(ordinal.first);
+        for (const auto& m : pair.second.getMethods()) classUnits.insert(m.getUnitNumber());
+        remainingUnits[pair.first] = classUnits.size();
+    }
 
-        threadPoolCount = 0;       
+    findInheritance();
+    for (auto& pair : classCollection) {
+        pair.second.getMethods().clear();
+        pair.second.getMethods().shrink_to_fit();
     }
 
-    srcml_archive_close(outputArchive);
-    srcml_archive_free(outputArchive);   
+    // Streaming pass
     srcml_archive_close(archive);
     srcml_archive_free(archive);
+    archive = srcml_archive_create();
+    if (openInputArchive(archive, inputFile)) {
+        error = "Cannot open the input archive again: " + inputFile;
+        srcml_archive_free(archive);
+        if (outputArchive) {
+            srcml_archive_close(outputArchive);
+            srcml_archive_free(outputArchive);
+        }
+        return;
+    }
 
-    // Annotate as comments
-    if (reDocComment){
-        std::string temp = outputFile + ".temp.xml";
+    std::string InputFileNoExt = archiveNameNoExt(inputFile);
+
+    // Report files of the default settings and of each profile
+    const bool outputReports = outputTxtReport || outputCsvReport || settings.verbose;
+    std::vector<std::unique_ptr<stereotypeReports>> reports;
+    std::vector<std::unique_ptr<stereotypeRollup>> rollups;
+    for (std::size_t profile = 0; profile <= settings.profiles.size(); ++profile) {
+        std::string reportFileNoExt = InputFileNoExt;
+        if (profile != 0) reportFileNoExt += "." + settings.profiles[profile - 1].name;
+        if (outputReports || outputRollup) 
+            reports.emplace_back(new stereotypeReports(reportFileNoExt, outputTxtReport, outputCsvReport, settings.verbose));
+        if (outputRollup) rollups.emplace_back(new stereotypeRollup(unitFilenames, unitNamespaces));
+    }
 
-        archive = srcml_archive_create();
-        srcml_archive_read_open_filename(archive, outputFile.c_str());  
+    std::vector<int> tierCount(ANALYSIS_TIER_NAMES.size(), 0);
+    // Units are written while later ones are classified, so the annotations are only changed under their lock
+    auto classify = [&](std::unordered_map<std::string, classModel>& batchClasses, std::vector<methodModel>& batchFunctions) {
+        stereotypes stereotypesObj(annotations);
+        for (std::size_t profile = 0; profile <= settings.profiles.size(); ++profile) {
+            const stereotypeRules& rules = profile == 0 ? settings.rules : settings.profiles[profile - 1].rules;
+            std::unordered_map<std::string, classModel> passClasses;
+            std::vector<methodModel> passFunctions;
+            const bool ownModels = copyModelsForPass(profile, batchClasses, batchFunctions, passClasses, passFunctions);
+            std::unordered_map<std::string, classModel>& classes = ownModels ? passClasses : batchClasses;
+            std::vector<methodModel>& functions = ownModels ? passFunctions : batchFunctions;
+
+            stereotypes passStereotypes(annotations);
+            stereotypes& classifier = ownModels ? passStereotypes : stereotypesObj;
+            {
+                std::lock_guard<std::mutex> guard(annotationsMutex);
+                classifier.computeMethodStereotypes (classes, rules, profile);
+                classifier.computeClassStereotypes  (classes, rules, profile);
+                if (settings.freeFunction) classifier.computeFreeFunctionsStereotypes(functions, rules, profile);
+            }
+            if (events) outputEvents(*events, profile, classes, functions);
+            if (callbacks) notifyElements(profile, classes, functions);
+            if (!reports.empty()) addReportRows(*reports[profile], outputRollup ? rollups[profile].get() : nullptr, classes, functions);
+        }
+        if (settings.verbose) countAnalysisTiers(settings, tierCount, batchClasses, batchFunctions);
+    };
 
-        outputArchive = srcml_archive_create();
-        srcml_archive_write_open_filename(outputArchive, temp.c_str());
-        srcml_archive_register_namespace(outputArchive, "st", "http://www.srcML.org/srcML/stereotype"); 
+    std::unordered_map<std::string, classModel> classesInFlight;                    // Classes with units not read yet
+    std::unordered_map<std::string, std::vector<methodModel>> methodsInFlight;     // Methods defined outside of their class (C++)
+    auto finishClasses = [&](const std::vector<std::string>& classNames) {
+        std::unordered_map<std::string, classModel> finished;
+        for (const auto& className : classNames) {
+            remainingUnits.erase(className);
+            auto node = classesInFlight.extract(className);
+            if (node.empty()) continue;
+
+            classModel& c = node.mapped();
+            for (auto& m : methodsInFlight[className]) c.addMethod(m);
+            methodsInFlight.erase(className);
+            auto skeleton = classCollection.find(className);
+            if (skeleton != classCollection.end()) c.appendInheritedDataMembers(skeleton->second.getDataMembers());
+            finished.insert(std::move(node));
+        }
+        std::vector<methodModel> noFunctions;
+        if (!finished.empty()) classify(finished, noFunctions);
+    };
 
-        unit = srcml_archive_read_unit(archive);
+    struct unitInFlight {
+        std::unique_ptr<annotatedUnit>  unit;
+        std::vector<std::string>        classNames;     // Classes the unit waits for
+        std::size_t                     bytes;
+    };
+    std::deque<unitInFlight> unitsInFlight;
+    std::size_t streamedBytes = 0;
+    std::size_t bytesInFlight = 0;
+    std::size_t maxBytesInFlight = 0;
+    std::size_t maxUnitsInFlight = 0;
+    std::size_t maxClassesInFlight = 0;
+    unitNumber = 1;
+    bool reading = true;
+
+    // Reads, analyzes, and classifies the next unit. Returns false once all the units are read
+    auto analyzeNextUnit = [&]() -> bool {
+        if (!reading) return false;
+        srcml_unit* streamed = srcml_archive_read_unit(archive);
+        if (streamed == nullptr) {
+            // Only happens if the input changed between the passes
+            std::vector<std::string> unfinished;
+            for (const auto& pair : remainingUnits) unfinished.push_back(pair.first);
+            finishClasses(unfinished);
+            reading = false;
+            return false;
+        }
 
-        while (unit) {
-            outputAsComments(unit, outputArchive);
-            srcml_unit_free(unit);
-            unit = srcml_archive_read_unit(archive);
+        const char* unitSrcML = srcml_unit_get_srcml(streamed);
+        std::size_t unitBytes = std::strlen(unitSrcML);
+        streamedBytes += unitBytes;
+        std::vector<std::string> classNames;
+        if (unitElements::hasDefinitions(unitSrcML, unitBytes)) {
+            std::string unitLanguage = srcml_unit_get_language(streamed);
+            unitElements elements = annotateUnits ? unitElements(unitSrcML, unitLanguage, settings) : unitElements();
+            classNames = findClassInfo(archive, streamed, elements, unitNumber, classesInFlight, false);
+            std::sort(classNames.begin(), classNames.end());
+            classNames.erase(std::unique(classNames.begin(), classNames.end()), classNames.end());
+
+            // Methods were analyzed with the data members of the class found so far, so only references that need 
+            //  the data members or methods of other units are re-checked
+            for (const auto& className : classNames) {
+                auto skeleton = classCollection.find(className);
+                if (skeleton == classCollection.end()) continue;
+                for (auto& m : classesInFlight.find(className)->second.getMethods()) {
+                    if (m.getUnitNumber() != unitNumber) continue;
+                    if (m.isAnalyzed())
+                        m.resolvePending(skeleton->second.getDataMembers(), skeleton->second.getMethodSignatures());
+                    else
+                        m.findData(skeleton->second.getDataMembers(), skeleton->second.getMethodSignatures(), skeleton->second.getName()[3]);
+                }
+            }
+
+            std::vector<methodModel> functions;
+            if (writeArchive || settings.freeFunction || unitLanguage == "C++")
+                findFreeFunctions(archive, streamed, elements, unitNumber, functions);
+            for (std::vector<methodModel>::iterator function = functions.begin(); function != functions.end();) {
+                std::string className;
+                auto skeleton = findMethodClass(*function, className) ? classCollection.find(className) : classCollection.end();
+                if (skeleton != classCollection.end()) {
+                    function->findData(skeleton->second.getDataMembers(), skeleton->second.getMethodSignatures(), 
+                                       skeleton->second.getName()[3]);
+                    methodsInFlight[className].push_back(*function);
+                    if (std::find(classNames.begin(), classNames.end(), className) == classNames.end()) classNames.push_back(className);
+                    function = functions.erase(function);
+                }
+                else ++function;
+            }
+            if (settings.freeFunction)
+                for (auto& f : functions) f.findFreeFunctionData();
+            if (!functions.empty()) {
+                std::unordered_map<std::string, classModel> noClasses;
+                classify(noClasses, functions);
+            }
+
+            std::vector<std::string> finished;
+            for (const auto& className : classNames) {
+                auto remaining = remainingUnits.find(className);
+                if (remaining == remainingUnits.end() || --remaining->second <= 0) finished.push_back(className);
+            }
+            maxClassesInFlight = std::max(maxClassesInFlight, classesInFlight.size());
+            finishClasses(finished);
         }
 
-        std::filesystem::remove(outputFile);
-        std::filesystem::rename(temp, outputFile);
+        if (annotateUnits) {
+            std::unique_ptr<annotatedUnit> next(new annotatedUnit);
+            next->original = next->unit = streamed;
+            unitsInFlight.push_back({std::move(next), classNames, unitBytes});
+            bytesInFlight += unitBytes;
+            maxUnitsInFlight = std::max(maxUnitsInFlight, unitsInFlight.size());
+            maxBytesInFlight = std::max(maxBytesInFlight, bytesInFlight);
+        }
+        else
+            srcml_unit_free(streamed);
+        ++unitNumber;
+        return true;
+    };
 
-        srcml_archive_close(archive); 
-        srcml_archive_close(outputArchive);
-        srcml_archive_free(outputArchive);   
+    auto isFinished = [&](const unitInFlight& u) {
+        for (const auto& className : u.classNames)
+            if (remainingUnits.count(className)) return false;
+        return true;
+    };
+
+    if (annotateUnits) {
+        auto nextUnit = [&]() -> std::unique_ptr<annotatedUnit> {
+            while (unitsInFlight.empty() || !isFinished(unitsInFlight.front()))
+                if (!analyzeNextUnit()) break;
+            if (unitsInFlight.empty()) return nullptr;
+
+            std::unique_ptr<annotatedUnit> next = std::move(unitsInFlight.front().unit);
+            bytesInFlight -= unitsInFlight.front().bytes;
+            unitsInFlight.pop_front();
+            return next;
+        };
+        outputAnnotatedUnits(archive, outputArchive, reDocComment, sidecarFile, nextUnit);
+    }
+    else
+        while (analyzeNextUnit());
+
+    srcml_archive_close(archive);
+    srcml_archive_free(archive);
+
+    for (auto& r : reports) r->close();
+    if (outputRollup) {
+        for (std::size_t profile = 0; profile <= settings.profiles.size(); ++profile) {
+            std::string reportFileNoExt = InputFileNoExt;
+            if (profile != 0) reportFileNoExt += "." + settings.profiles[profile - 1].name;
+            rollups[profile]->write(reportFileNoExt + ".rollup.csv");
+        }
+    }
+    if (events) events->flush();
+
+    if (settings.verbose) {
+        outputAnalysisTiers(tierCount);
+        std::cerr << "---Two-Phase Analysis---";
+        std::cerr << "\n[skeleton classes]: " << classCollection.size();
+        std::cerr << "\n[skeleton pass bytes]: " << skeletonBytes;
+        std::cerr << "\n[streaming pass bytes]: " << streamedBytes;
+        std::cerr << "\n[max classes in flight]: " << maxClassesInFlight;
+        std::cerr << "\n[max units in flight]: " << maxUnitsInFlight;
+        std::cerr << "\n[max bytes in flight]: " << maxBytesInFlight;
+        std::cerr << "\n\n";
     }
 }
 
@@ -238,10 +748,17 @@ classModelCollection::classModelCollection(srcml_archive* archive, srcml_archive
 //   Static classes in java can contain non-static data members or methods
 //   They are ignored (since they are nested) and their methods (only if static) are collected as free functions
 //  Anonymous classes (classes without names and are nested as instances) are ignored
-void classModelCollection::findClassInfo(srcml_archive* archive, srcml_unit* unit, int unitNumber) {
+//
+// Classes are added to 'classes', and the names of the classes found are returned
+// The skeleton pass (--two-phase) keeps only the names, parents, data members, and method signatures of the classes,
+//  so their methods are not analyzed and are freed once their signatures are collected
+std::vector<std::string> classModelCollection::findClassInfo(srcml_archive* archive, srcml_unit* unit, const unitElements& elements, int unitNumber,
+                                         std::unordered_map<std::string, classModel>& classes, bool skeleton, 
+                                         std::vector<classPart>* parts) {
+    std::vector<std::string> classNames;
     std::string unitLanguage = srcml_unit_get_language(unit);   
     if (unitLanguage == "C++" || unitLanguage == "C#" || unitLanguage == "Java") {
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage, "class").c_str()); 
+        srcml_append_transform_xpath(archive, settings.xpaths.getXpath(unitLanguage, "class").c_str()); 
 
         srcml_transform_result* result = nullptr;
         srcml_unit_apply_transforms(archive, unit, &result);
@@ -262,17 +779,53 @@ void classModelCollection::findClassInfo(srcml_archive* archive, srcml_unit* uni
             classArchive = srcml_archive_create();
             srcml_archive_read_open_memory(classArchive, unparsed, size);
             srcml_unit* unitClass = srcml_archive_read_unit(classArchive);
-            std::string classXpath = "(" + XPATH_TRANSFORMATION.getXpath(unitLanguage, "class") + ")[" + std::to_string(i + 1) + "]";
-            classModel c(classArchive, unitClass, unitLanguage); 
+            classModel c(classArchive, unitClass, unitLanguage, settings); 
+
+            // Recorded for units with the same content and for the analysis cache (--cache)
+            classPart* part = nullptr;
+            if (parts) {
+                parts->emplace_back();
+                part = &parts->back();
+                part->name = c.getName();
+                part->kind = c.getKind();
+            }
 
             // Needed for partial classs in C#
-            if (classCollection.find(c.getName()[1]) != classCollection.end())
+            std::size_t firstMethod = 0;
+            auto existing = classes.find(c.getName()[1]);
+            if (existing != classes.end()) {
                 // Append the partial class data to the existing partial class
-                classCollection.at(c.getName()[1]).findData(classArchive, unitClass, classXpath, unitNumber);
+                firstMethod = existing->second.getMethods().size();
+                existing->second.findData(classArchive, unitClass, elements, i, unitNumber, part);
+            }
             else {
-                c.findData(classArchive, unitClass, classXpath, unitNumber);      
-                classCollection.insert({c.getName()[1], c});  
+                c.findData(classArchive, unitClass, elements, i, unitNumber, part);      
+                existing = classes.insert({c.getName()[1], c}).first;  
             }                 
+            classNames.push_back(c.getName()[1]);
+
+            // Speculative analysis of the new methods, see findMethodData()
+            if (skeleton) {
+                existing->second.buildMethodSignature();
+                existing->second.getMethods().clear();
+            }
+            else
+                existing->second.findMethodData(firstMethod);
+
+            // Methods that were not extracted (e.g., constructors) are recorded as they are
+            if (part) {
+                std::vector<methodModel>& methods = existing->second.getMethods();
+                part->firstMethod = firstMethod;
+                part->methodCount = methods.size() - firstMethod;
+                for (std::size_t j = firstMethod; j < methods.size() && settings.cacheFile != ""; ++j) {
+                    part->methods.push_back(methods[j].takeFacts());
+                    if (part->methods.back().empty()) {
+                        cacheWriter facts;
+                        methods[j].writeFacts(facts);
+                        part->methods.back() = std::move(facts.getBytes());
+                    }
+                }
+            }
 
             // Needed for inheritance in Java and C#
             if (unitLanguage != "C++") classGenerics.insert({c.getName()[2], c.getName()[1]}); 
@@ -285,6 +838,7 @@ void classModelCollection::findClassInfo(srcml_archive* archive, srcml_unit* uni
         srcml_transform_free(result);
         srcml_clear_transforms(archive);   
     }      
+    return classNames;
 }
 
 // C++ only
@@ -310,10 +864,22 @@ void classModelCollection::findClassInfo(srcml_archive* archive, srcml_unit* uni
 //      Function could be a free function (including normal free functions, friend functions, static methods, methods defined for external classes)
 //          Foo(){}, namespace::Foo(){}, static Foo(){}, externalClass::Foo(){}, 
 //
-void classModelCollection::findFreeFunctions(srcml_archive* archive, srcml_unit* unit, int unitNumber) {
+void classModelCollection::findFreeFunctions(srcml_archive* archive, srcml_unit* unit, const unitElements& elements, int unitNumber,
+                                             std::vector<methodModel>& functions) {
     std::string unitLanguage = srcml_unit_get_language(unit); 
+    forEachFreeFunction(archive, unit, unitLanguage, [&](int i, srcml_archive* methodArchive, srcml_unit* methodUnit) {
+        methodModel function(methodArchive, methodUnit, elements.getFreeFunction(i), unitLanguage, "", unitNumber, settings);
+        function.setFunctionIndex(i);
+        functions.push_back(function);
+    });
+}
+
+// Calls 'found' with each free function of the unit (and method defined outside of its class in C++), in the order they are found
+//
+void classModelCollection::forEachFreeFunction(srcml_archive* archive, srcml_unit* unit, const std::string& unitLanguage,
+                                               const std::function<void(int, srcml_archive*, srcml_unit*)>& found) {
     if (unitLanguage == "C++" || unitLanguage == "C#" || unitLanguage == "Java") {
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"free_function").c_str());
+        srcml_append_transform_xpath(archive, settings.xpaths.getXpath(unitLanguage,"free_function").c_str());
         srcml_transform_result* result = nullptr;
         srcml_unit_apply_transforms(archive, unit, &result);
         int n = srcml_transform_get_unit_size(result);  
@@ -335,10 +901,7 @@ void classModelCollection::findFreeFunctions(srcml_archive* archive, srcml_unit*
             srcml_archive_read_open_memory(methodArchive, unparsed, size);
             srcml_unit* methodUnit = srcml_archive_read_unit(methodArchive);
 
-            std::string functionXpath =  "(" + XPATH_TRANSFORMATION.getXpath(unitLanguage,"free_function") + ")[" + std::to_string(i + 1) + "]";
-            methodModel function(methodArchive, methodUnit, functionXpath, unitLanguage, "", unitNumber);
-
-            freeFunctions.push_back(function);
+            found(i, methodArchive, methodUnit);
 
             free(unparsed); 
             srcml_unit_free(methodUnit);
@@ -353,38 +916,201 @@ void classModelCollection::findFreeFunctions(srcml_archive* archive, srcml_unit*
 
 // Analyzes free functions to determine externally defined methods
 //
+// Checks that the methods of each class part would be extracted the same way with the data members its class has
+//  once the part is added (methods are extracted as soon as their part is added, see findClassInfo())
+//
+bool classModelCollection::isPartExtractionValid(const std::vector<classPart>& parts, 
+                                                 const std::vector<std::vector<methodModel>>& partMethods) {
+    std::unordered_map<std::string, std::pair<std::string, std::unordered_map<std::string, variable>>> partClasses;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        auto partClass = partClasses.find(parts[i].name[1]);
+        if (partClass == partClasses.end()) {
+            auto existing = classCollection.find(parts[i].name[1]);
+            if (existing != classCollection.end())
+                partClass = partClasses.insert({parts[i].name[1], {existing->second.getName()[3], existing->second.getDataMembers()}}).first;
+            else 
+                partClass = partClasses.insert({parts[i].name[1], {parts[i].name[3], {}}}).first;
+        }
+        for (const variable& v : parts[i].dataMembers) partClass->second.second.insert({v.getName(), v});
+
+        for (const methodModel& m : partMethods[i])
+            if (!m.isExtractionValid(&partClass->second.second, partClass->second.first)) return false;
+    }
+    return true;
+}
+
+// Adds class parts and their methods to the classes as findClassInfo() would, and analyzes the methods
+// The position of the methods of each part in its class is set in the part
+//
+void classModelCollection::addParts(int unitNumber, const std::string& unitLanguage, std::vector<classPart>& parts,
+                                    std::vector<std::vector<methodModel>>& partMethods) {
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        auto existing = classCollection.find(parts[i].name[1]);
+        if (existing == classCollection.end())
+            existing = classCollection.insert({parts[i].name[1], classModel(parts[i].name, unitLanguage, settings)}).first;
+
+        parts[i].firstMethod = existing->second.getMethods().size();
+        parts[i].methodCount = partMethods[i].size();
+        existing->second.restorePart(parts[i], unitNumber, partMethods[i]);
+        existing->second.findMethodData(parts[i].firstMethod);
+
+        if (unitLanguage != "C++") classGenerics.insert({parts[i].name[2], parts[i].name[1]}); 
+    }
+}
+
+// Restores the classes and free functions of a unit from its record in the analysis cache (--cache) as if they were found
+// Returns false (and nothing is restored) if the record is not valid or if a method would not be extracted the same way
+//  with the data members its class has now (e.g., another unit adds to a partial class). The unit is then analyzed as usual
+// Free functions that could be methods of a class (C++) get their srcML, so they can be extracted again for the class
+//
+bool classModelCollection::restoreUnit(srcml_archive* archive, srcml_unit* unit, int unitNumber, const std::string& unitLanguage, 
+                                       const std::string& record, std::vector<classPart>& restoredParts) {
+    std::vector<classPart> parts;
+    std::vector<std::string> functionFacts;
+    if (!analysisCache::readUnit(record, parts, functionFacts)) return false;
+
+    std::vector<std::vector<methodModel>> partMethods(parts.size());
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        for (const std::string& facts : parts[i].methods) {
+            partMethods[i].emplace_back(facts, unitNumber, settings);
+            if (!partMethods[i].back().isCached()) return false;
+        }
+    }
+
+    std::vector<methodModel> functions;
+    bool classMethodCandidate = false;
+    for (const std::string& facts : functionFacts) {
+        functions.emplace_back(facts, unitNumber, settings);
+        if (!functions.back().isCached()) return false;
+        if (unitLanguage == "C++" && functions.back().getName().find("::") != std::string::npos) classMethodCandidate = true;
+    }
+
+    if (!isPartExtractionValid(parts, partMethods)) return false;
+    addParts(unitNumber, unitLanguage, parts, partMethods);
+
+    if (classMethodCandidate)
+        forEachFreeFunction(archive, unit, unitLanguage, [&](int i, srcml_archive*, srcml_unit* methodUnit) {
+            if (static_cast<std::size_t>(i) < functions.size()) functions[i].setSrcML(srcml_unit_get_srcml(methodUnit));
+        });
+    for (methodModel& f : functions) freeFunctions.push_back(std::move(f));
+
+    restoredParts = std::move(parts);
+    return true;
+}
+
+// Copies the classes and free functions found in an earlier unit with the same content (only the file name differs)
+//  instead of extracting them again. The copies keep the extracted facts and are analyzed in their classes
+// Returns false (and nothing is copied) if a method would not be extracted the same way with the data members 
+//  its class has now (e.g., the copy of a returned name is now a data member). The unit is then analyzed as usual
+//
+bool classModelCollection::copyUnit(const foundUnit& original, int unitNumber, const std::string& unitLanguage) {
+    std::vector<std::vector<methodModel>> partMethods(original.parts.size());
+    for (std::size_t i = 0; i < original.parts.size(); ++i) {
+        const classPart& part = original.parts[i];
+        const std::vector<methodModel>& methods = classCollection.find(part.name[1])->second.getMethods();
+        for (std::size_t j = part.firstMethod; j < part.firstMethod + part.methodCount; ++j)
+            partMethods[i].push_back(methods[j].copyForUnit(unitNumber));
+    }
+    if (!isPartExtractionValid(original.parts, partMethods)) return false;
+
+    std::vector<methodModel> functions;
+    for (std::size_t i = original.firstFunction; i < original.firstFunction + original.functionCount; ++i)
+        functions.push_back(freeFunctions[i].copyForUnit(unitNumber));
+
+    std::vector<classPart> parts = original.parts;
+    addParts(unitNumber, unitLanguage, parts, partMethods);
+    for (methodModel& f : functions) freeFunctions.push_back(std::move(f));
+    return true;
+}
+
+// Adds the units that were analyzed (and not restored) to the analysis cache (--cache)
+// Free functions, including the ones that are now methods of a class, are added in the order they were found in their unit
+//
+void classModelCollection::addCachedUnits(analysisCache& cache, 
+                                          const std::map<int, std::pair<std::string, const std::vector<classPart>*>>& analyzedParts) {
+    std::map<int, std::map<int, std::string>> unitFunctions;
+    auto addFunction = [&](const methodModel& f) {
+        if (f.getFunctionIndex() < 0 || analyzedParts.count(f.getUnitNumber()) == 0) return;
+        std::string& facts = unitFunctions[f.getUnitNumber()][f.getFunctionIndex()];
+        facts = f.getFacts();
+        if (facts.empty()) {
+            cacheWriter current;
+            f.writeFacts(current);
+            facts = std::move(current.getBytes());
+        }
+    };
+    for (const auto& f : freeFunctions) addFunction(f);
+    for (auto& pair : classCollection)
+        for (const auto& m : pair.second.getMethods()) addFunction(m);
+
+    for (const auto& unit : analyzedParts) {
+        std::vector<std::string> functions;
+        for (auto& function : unitFunctions[unit.first]) functions.push_back(std::move(function.second));
+        cache.addUnit(unit.first, unit.second.first, analysisCache::writeUnit(*unit.second.second, functions));
+    }
+}
+
 void classModelCollection::analyzeFreeFunctions() {
     for (std::vector<methodModel>::iterator function = freeFunctions.begin(); function != freeFunctions.end();) {
-        if (function->getUnitLanguage() == "C++") {
-            // Removes namespaces if any
-            std::string functionName = function->getName();  
-            removeNamespace(functionName, "C++", false);
-
-            // Get the class name (if any). Else, it is a free function
-            std::size_t isClassName = functionName.find("::");
-            if (isClassName != std::string::npos) { // Class found, it is a method       
-                std::string className = functionName.substr(0, isClassName); 
-                auto result = classCollection.find(className);
-                if (result != classCollection.end()) {
-                    result->second.addMethod(*function);
-                    function = freeFunctions.erase(function);
-                }                          
-                else { // Case specialized template method belongs to the generic template class
-                    className = className.substr(0, className.find("<"));
-                    result = classCollection.find(className);
-                    if (result != classCollection.end())  {
-                        result->second.addMethod(*function);
-                        function = freeFunctions.erase(function);
-                    } 
-                    else ++function;                                                  
-                }
-            }
-            else ++function;
+        std::string className;
+        auto found = findMethodClass(*function, className) ? classCollection.find(className) : classCollection.end();
+        if (found != classCollection.end()) {
+            found->second.addMethod(*function);
+            function = freeFunctions.erase(function);
         }
         else ++function;
     }
 }
 
+// Finds the class of a method defined outside of its class (C++)
+// Returns false for a free function
+//
+bool classModelCollection::findMethodClass(const methodModel& function, std::string& className) const {
+    if (function.getUnitLanguage() != "C++") return false;
+
+    // Removes namespaces if any
+    std::string functionName = function.getName();  
+    removeNamespace(functionName, "C++", false);
+
+    // Get the class name (if any). Else, it is a free function
+    std::size_t isClassName = functionName.find("::");
+    if (isClassName == std::string::npos) return false;
+
+    className = functionName.substr(0, isClassName); 
+    if (classCollection.count(className)) return true;
+
+    // Case specialized template method belongs to the generic template class
+    className = className.substr(0, className.find("<"));
+    return classCollection.count(className) != 0;
+}
+
+
+// Adds the inherited data members and method signatures to every class
+// Performed after the collection of all classes
+//
+void classModelCollection::findInheritance() {
+    // Finds inherited data members
+    for (auto& pair : classCollection) {
+        findInheritedDataMembers(pair.second);
+        pair.second.setInherited(true);
+        for (auto& pairS : classCollection)
+            pairS.second.setVisited(false);
+    } 
+
+    // Resets inheritance and build signatures for findInheritedMethods()
+    for (auto& pair : classCollection) {
+        pair.second.setInherited(false); 
+        pair.second.buildMethodSignature();
+    }
+        
+    // Finds inherited methods
+    for (auto& pair : classCollection) {
+        findInheritedMethods(pair.second);
+        pair.second.setInherited(true);
+        for (auto& pairS : classCollection)
+            pairS.second.setVisited(false);
+    } 
+}
 
 // Finds inherited data members 
 // In C++, you can inherit from a specialized templated class or
@@ -512,326 +1238,295 @@ void classModelCollection::findInheritedMethods(classModel& c) {
     }
 }
 
-// Generates other CSV report files containing stereotype information
-// This includes method_view (e.g., get set ... etc)
-// This includes class view (e.g., entity control ... etc)
-// This includes unique_method_view (e.g., 'get collaborator' ... etc)
-// This includes unique_class_view (e.g., 'entity control' ... etc)
-// This includes category_view (e.g., accessors, mutators ... etc) 
-//
-void classModelCollection::outputCsvVerboseReportFile(const std::string& InputFileNoExt) {
-    std::unordered_map<std::string, int>            uniqueMethodStereotypesView;  
-    std::unordered_map<std::string, int>            uniqueClassStereotypesView;  
-
-    std::unordered_map<std::string, int> classStereotypes = {
-        {"entity", 0},
-        {"minimal-entity", 0},
-        {"data-provider", 0},
-        {"commander", 0},
-        {"boundary", 0},
-        {"factory", 0},
-        {"controller", 0},
-        {"pure-controller", 0},
-        {"large-class", 0},
-        {"lazy-class", 0},
-        {"degenerate", 0},
-        {"data-class", 0},
-        {"small-class", 0},
-        {"unclassified", 0},
-        {"empty", 0},
-    };
-
-    std::unordered_map<std::string, int> methodStereotypes = {
-        {"get", 0},
-        {"predicate", 0},
-        {"property", 0},
-        {"void-accessor", 0},
-        {"set", 0},
-        {"command", 0},
-        {"non-void-command", 0},
-        {"collaborator", 0},
-        {"controller", 0},
-        {"wrapper", 0},
-        {"constructor", 0},
-        {"copy-constructor", 0},
-        {"destructor", 0},
-        {"factory", 0},
-        {"incidental", 0},
-        {"stateless", 0},  
-        {"empty", 0},
-        {"unclassified", 0},
-    };
-
-    for (auto& pair : classCollection) {
-        uniqueClassStereotypesView[pair.second.getStereotype()]++; 
-        for (const std::string& s : pair.second.getStereotypeList()) 
-            classStereotypes[s]++;   
-        
-        const std::vector<methodModel>& method = pair.second.getMethods();     
-        for (const auto& m : method) {         
-            uniqueMethodStereotypesView[m.getStereotype()]++;
+// Outputs the optional report files of one set of stereotypes
+// 'fileNoExt' is the input file name without extension, followed by the profile name if any
+// The classes and free functions are traversed once and each row is fed to every requested format
+//  and to the rollup report (--rollup)
+//
+void classModelCollection::outputReportFiles(const std::string& fileNoExt, bool outputTxtReport, bool outputCsvReport, bool outputRollup,
+                                             std::unordered_map<std::string, classModel>& classes, const std::vector<methodModel>& functions) {
+    if (!outputTxtReport && !outputCsvReport && !outputRollup && !settings.verbose) return;
+
+    stereotypeReports reports(fileNoExt, outputTxtReport, outputCsvReport, settings.verbose);
+    stereotypeRollup rollup(unitFilenames, unitNamespaces);
+    addReportRows(reports, outputRollup ? &rollup : nullptr, classes, functions);
+    reports.close();
+    if (outputRollup) rollup.write(fileNoExt + ".rollup.csv");
+}
 
-            for (const std::string& s : m.getStereotypeList())
-                methodStereotypes[s]++;           
+// Feeds the rows of classes and free functions to the report files and to the rollup report (if not null)
+//
+void classModelCollection::addReportRows(stereotypeReports& reports, stereotypeRollup* rollup,
+                                         std::unordered_map<std::string, classModel>& classes, const std::vector<methodModel>& functions) {
+    for (auto& pair : classes) {
+        reports.addClass(pair.second.getName()[1], pair.second.getStereotypeMask());
+        if (rollup) rollup->addClass(pair.second.getFirstUnitNumber());
+        for (const auto& m : pair.second.getMethods()) {
+            reports.addMethod(m.getName(), m.getStereotypeMask());
+            if (rollup) rollup->addMethod(m.getUnitNumber(), m.getStereotypeMask());
         }
+        reports.endClass();
+    }
+    for (const auto& f : functions) {
+        reports.addFreeFunction(f.getName(), f.getStereotypeMask());
+        if (rollup && settings.freeFunction) rollup->addMethod(f.getUnitNumber(), f.getStereotypeMask());
     }
+}
 
-    std::ofstream outU, outV, outM, outS, outC;
-    outU.open(InputFileNoExt + ".unique_method_view.csv");
-    outV.open(InputFileNoExt + ".unique_class_view.csv");
-    outM.open(InputFileNoExt + ".method_view.csv");
-    outS.open(InputFileNoExt + ".class_view.csv");
-    outC.open(InputFileNoExt + ".category_view.csv");
+//  Add in stereotypes on <class> and <function>
+//  Example: <function st:stereotype="get"> ... </function>
+//           <class st:stereotype="boundary"> ... ></class>
+//
+//  The attributes (and the comments of -c) are added while the unit's srcML is copied (see UnitElements.cpp), 
+//   and the copy is read back as a unit for the output archive. Units without stereotypes are output as they are
+//
+//  With --sidecar, each annotated element is also recorded as one JSON object per line
+//  Example: {"unit":1,"filename":"a.cpp","ordinal":42,"element":"function","line":10,"column":5,"stereotype":"get"}
+//   The ordinal is the position of the element's start tag in the unit (the unit is 0), and line and column are only
+//   given if the archive has positions (--position). Profiles (-P) add "stereotype-<name>" members
+//
+void classModelCollection::outputWithStereotypes(annotatedUnit& result, int unitNumber, const std::map<int, stereotypeMask>& annotations) {  
+        srcml_unit* unit = result.original;
+        if (annotations.empty()) return;
+
+        if (sidecarOutput) {
+            const char* filename = srcml_unit_get_filename(unit);
+            const std::string unitPrefix = "{\"unit\":" + std::to_string(unitNumber) + 
+                                           ",\"filename\":" + jsonString(filename ? filename : "");
+            for (const elementTag& tag : unitElements::findTags(srcml_unit_get_srcml(unit), annotations)) {
+                const stereotypeMask& mask = annotations.at(tag.ordinal);
+                result.sidecar += unitPrefix + ",\"ordinal\":" + std::to_string(tag.ordinal) + ",\"element\":" + jsonString(tag.name);
+                if (tag.line != 0)
+                    result.sidecar += ",\"line\":" + std::to_string(tag.line) + ",\"column\":" + std::to_string(tag.column);
+                if (mask.bits != stereotypeMask::NOT_CLASSIFIED)
+                    result.sidecar += ",\"stereotype\":" + jsonString(mask.label());
+                for (std::size_t i = 0; i < mask.profiles.size() && i < profileAttributes.size(); ++i)
+                    if (mask.profiles[i] != stereotypeMask::NOT_CLASSIFIED)
+                        result.sidecar += "," + jsonString(profileAttributes[i]) + ":" + jsonString(mask.label(mask.profiles[i]));
+                result.sidecar += "}\n";
+            }
+        }
+        if (!archiveOutput) return;
 
-    
-    // Needed to print stereotypes in this order
-    std::vector<std::string> method_ordered_keys = {
-        "get", "predicate", "property", "void-accessor", "set", "command", "non-void-command", 
-        "collaborator", "controller", "wrapper", "constructor", "copy-constructor", "destructor", "factory", 
-        "incidental", "stateless", "empty", "unclassified"
-    };
-    
-    std::vector<std::string> class_ordered_keys = {
-        "entity", "minimal-entity", "data-provider", "commander", "boundary", "factory", 
-        "controller", "pure-controller", "large-class", "lazy-class", "degenerate", "data-class", 
-        "small-class", "empty", "unclassified"
-    };
+        result.srcML = unitElements::annotate(srcml_unit_get_srcml(unit), annotations, profileAttributes, outputNamespaces, docComment);
+        result.archive = srcml_archive_create();
+        srcml_archive_read_open_memory(result.archive, result.srcML.c_str(), result.srcML.size());
+        result.unit = srcml_archive_read_unit(result.archive);
+}
 
-    int total = 0;
-    // Unique Method View
-    if (outU.is_open()) {
-        outU << "Unique Method Stereotype,Method Count" <<'\n';
-        for (auto& pair : uniqueMethodStereotypesView){
-            outU << pair.first << ",";
-            outU << pair.second << '\n';
-            total += pair.second;
-        }
-        outU << "Total" << "," << total;
+// Writes the units given by 'nextUnit' with stereotypes to the output archive and the sidecar (--sidecar) 
+//  and closes the output archive
+// 'archive' is the input archive, whose namespaces are declared on the annotated units
+//
+void classModelCollection::outputAnnotatedUnits(srcml_archive* archive, srcml_archive* outputArchive, bool reDocComment, 
+                                                const std::string& sidecarFile, 
+                                                const std::function<std::unique_ptr<annotatedUnit>()>& nextUnit) {
+    // Annotated units are read back on their own, so they declare the namespaces of the archive
+    for (std::size_t i = 0; i < srcml_archive_get_namespace_size(archive); ++i)
+        outputNamespaces.push_back({srcml_archive_get_namespace_prefix(archive, i), srcml_archive_get_namespace_uri(archive, i)});
+    outputNamespaces.push_back({"st", "http://www.srcML.org/srcML/stereotype"});
+    for (const auto& profile : settings.profiles) profileAttributes.push_back("stereotype-" + profile.name);
+    docComment = reDocComment;
+    archiveOutput = outputArchive != nullptr || (callbacks && callbacks->unitAnnotated);
+    sidecarOutput = sidecarFile != "";
+
+    std::ofstream sidecar;
+    if (sidecarOutput) sidecar.open(sidecarFile);
+
+    outputArchiveUnits(outputArchive, sidecarOutput ? &sidecar : nullptr, nextUnit);
+
+    if (outputArchive) {
+        srcml_archive_close(outputArchive);
+        srcml_archive_free(outputArchive);   
     }
+}
+
+// Writes the units of the input archive with stereotypes to the output archive and the sidecar (if not null)
+// The calling thread reads units and queues them for a fixed pool of workers that add the stereotypes. A writer
+//  thread takes the units from a reorder buffer and writes each one as soon as the units before it are written
+// At most 'capacity' units are read but not yet written, which bounds the memory used by the queue and the buffer
+// The annotations of a unit are freed once it is written, so they do not stay in memory for the whole output
+//
+void classModelCollection::outputArchiveUnits(srcml_archive* outputArchive, std::ostream* sidecar, 
+                                              const std::function<std::unique_ptr<annotatedUnit>()>& nextUnit) {
+    const unsigned int nthreads = std::max(1u, settings.jobs);
+    const std::size_t capacity = 2 * nthreads;
+    const std::map<int, stereotypeMask> noAnnotations;
+
+    struct outputJob {
+        int                                     unitNumber;
+        std::unique_ptr<annotatedUnit>          unit;
+        const std::map<int, stereotypeMask>*    annotations;
+    };
 
-    // Unique Class View
-    if (outV.is_open()) {   
-        outV << "Unique Class Stereotype,Class Count" <<'\n';
-        total = 0;
-        for (auto& pair : uniqueClassStereotypesView){
-            outV << pair.first << ",";
-            outV << pair.second << '\n';
-            total += pair.second;
+    std::mutex mu;
+    std::condition_variable jobQueued, unitTransformed, unitWritten;
+    std::deque<outputJob> jobs;
+    std::map<int, std::unique_ptr<annotatedUnit>> reorderBuffer;
+    std::size_t pending = 0;    // Units read but not yet written
+    int unitsRead = 0;
+    bool reading = true;
+
+    auto worker = [&]() {
+        while (true) {
+            outputJob job;
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                jobQueued.wait(lock, [&]() { return !jobs.empty() || !reading; });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            outputWithStereotypes(*job.unit, job.unitNumber, *job.annotations);
+            {
+                std::lock_guard<std::mutex> guard(mu);
+                reorderBuffer.insert({job.unitNumber, std::move(job.unit)});
+            }
+            unitTransformed.notify_one();
         }
-        outV << "Total" << "," << total;
-    }
-
-    // Method View
-    //
-    if (outM.is_open()) { 
-        outM << "Method Stereotype,Stereotype Count" <<'\n';
-        total = 0;
-        for (const auto& key : method_ordered_keys) {
-            outM << key << ",";
-            outM << methodStereotypes[key] << '\n';
-            total += methodStereotypes[key];
+    };
+
+    auto writer = [&]() {
+        int unitNumber = 1; 
+        while (true) {
+            std::unique_ptr<annotatedUnit> result;
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                unitTransformed.wait(lock, [&]() { return reorderBuffer.count(unitNumber) || (!reading && unitNumber > unitsRead); });
+                auto next = reorderBuffer.find(unitNumber);
+                if (next == reorderBuffer.end()) return;
+                result = std::move(next->second);
+                reorderBuffer.erase(next);
+            }
+
+            if (outputArchive) srcml_archive_write_unit(outputArchive, result->unit);
+            if (callbacks && callbacks->unitAnnotated) callbacks->unitAnnotated(unitNumber, result->unit);
+            if (sidecar) *sidecar << result->sidecar;
+            if (result->archive) {
+                srcml_unit_free(result->unit);
+                srcml_archive_close(result->archive);
+                srcml_archive_free(result->archive);
+            }
+            srcml_unit_free(result->original);
+            if (result->originalArchive) {
+                srcml_archive_close(result->originalArchive);
+                srcml_archive_free(result->originalArchive);
+            }
+            {
+                std::lock_guard<std::mutex> guard(mu);
+                std::lock_guard<std::mutex> annotationsGuard(annotationsMutex);
+                annotations.erase(unitNumber);
+                --pending;
+            }
+            ++unitNumber;
+            unitWritten.notify_one();
         }
-        outM << "Total" << "," << total;
-    }
-
-    // Class View
-    //
-    if (outS.is_open()) {
-        outS << "Class Stereotype,Class Count" <<'\n';
-        total = 0;
-        for (const auto& key : class_ordered_keys) {
-            outS << key << ",";
-            outS << classStereotypes[key] << '\n';
-            total += classStereotypes[key];
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < nthreads; ++i) workers.push_back(std::thread(worker));
+    std::thread writerThread(writer);
+
+    std::unique_ptr<annotatedUnit> unit = nextUnit();
+    while (unit) {
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            unitWritten.wait(lock, [&]() { return pending < capacity; });
+
+            ++unitsRead;
+            ++pending;
+            std::lock_guard<std::mutex> annotationsGuard(annotationsMutex);
+            auto found = annotations.find(unitsRead);
+            jobs.push_back({unitsRead, std::move(unit), found != annotations.end() ? &found->second : &noAnnotations});
         }
-        outS << "Total" << "," << total;
+        jobQueued.notify_one();
+        unit = nextUnit();
     }
 
-    // Category view
-    int getters = methodStereotypes["get"];
-    int accessors = getters + methodStereotypes["predicate"] +
-                    methodStereotypes["property"] +
-                    methodStereotypes["void-accessor"];
+    {
+        std::lock_guard<std::mutex> guard(mu);
+        reading = false;
+    }
+    jobQueued.notify_all();
+    unitTransformed.notify_all();
 
-    int setters = methodStereotypes["set"];     
-    int commands = methodStereotypes["command"] + methodStereotypes["non-void-command"];           
-    int mutators = setters + commands;
+    for (std::thread& thread : workers) thread.join();
+    writerThread.join();
+}
 
-    int controllers = methodStereotypes["controller"];
-    int collaborator =  methodStereotypes["collaborator"] + methodStereotypes["wrapper"]; 
-    int collaborators = controllers + collaborator;
-    
-    int factory = methodStereotypes["factory"] + methodStereotypes["constructor"] + methodStereotypes["copy-constructor"] + methodStereotypes["destructor"];
-
-    int degenerates = methodStereotypes["incidental"] + methodStereotypes["stateless"] + methodStereotypes["empty"]; 
-
-    int unclassified = methodStereotypes["unclassified"];
-
-    total = accessors + mutators + factory + collaborators + degenerates + unclassified;
-    outC << "Stereotype Category,Stereotype Count" <<'\n';
-    outC << "Accessors" << "," << accessors << '\n';
-    outC << "Mutators" << "," << mutators << '\n';
-    outC << "Creational" << "," << factory << '\n';
-    outC << "Collaborational" << "," << collaborators << '\n';
-    outC << "Degenerate" << "," << degenerates << '\n';
-    outC << "Unclassified" << "," << unclassified << '\n';
-    outC << "Total" << "," << total;
-
-    outU.close();
-    outV.close();
-    outM.close();     
-    outS.close();
-    outC.close();
-}
-
-// Optional TXT report file containing stereotype information
-// Format:
-//
-// Class Name:                  Class Stereotype:
-// ...                          ...
-// Method Name:                 Method Stereotype:
-// ...                          ...
-//---------------------------------------------------------------
-// Class Name:                  Class Stereotype:
-// ...                          ...
-// Method Name:                 Method Stereotype:
-// ...                          ...
-//
-void classModelCollection::outputTxtReportFile(std::stringstream& stringStream, classModel* c) {
-    const int WIDTH = 70;
-    const std::string line(WIDTH * 2, '-');
-    auto setw_width = std::setw(WIDTH);
-    std::vector<methodModel>* methods = &freeFunctions;
-
-    if (c != nullptr) {
-        const std::string& className = c->getName()[1];
-        const std::string& classStereotype = c->getStereotype();
-        stringStream << std::left << setw_width << "Class Name:" << setw_width << "Class Stereotype:" << '\n';
-        stringStream << std::left << setw_width <<  className << setw_width << classStereotype << "\n\n";
-        stringStream << std::left << setw_width << "Method Name:" << setw_width << "Method Stereotype:" << '\n';
-        methods = &c->getMethods();
-    }
-    else 
-        stringStream << std::left << setw_width << "Free Function Name:" << setw_width << "Free Function Stereotype:" << '\n';
+// Writes one JSON object per line for each class, method, and free function with the stereotype of one pass
+// Profiles (-P) add a "profile" member. The lines of a class are flushed together so a reader can use them right away
+// Free functions are only written if they are classified (-f)
+//
+void classModelCollection::outputEvents(std::ostream& out, std::size_t profile, 
+                                        std::unordered_map<std::string, classModel>& classes, const std::vector<methodModel>& functions) {
+    const std::string profileMember = profile == 0 ? "" : ",\"profile\":" + jsonString(settings.profiles[profile - 1].name);
+    auto unitMembers = [&](int unitNumber) {
+        const std::string& filename = unitNumber >= 1 && static_cast<std::size_t>(unitNumber) <= unitFilenames.size() ? 
+                                      unitFilenames[unitNumber - 1] : "";
+        return "\"unit\":" + std::to_string(unitNumber) + ",\"filename\":" + jsonString(filename);
+    };
+    auto methodMembers = [&](const methodModel& m) {
+        return ",\"signature\":" + jsonString(m.getNameSignature()) + 
+               ",\"stereotype\":" + jsonString(m.getStereotype()) + profileMember +
+               ",\"tier\":" + jsonString(ANALYSIS_TIER_NAMES[m.getAnalysisTier()]) + 
+               ",\"statements\":" + std::to_string(m.getNonCommentStatementsCount()) +
+               ",\"dataMembersModified\":" + std::to_string(m.getDataMembersModifiedCount()) +
+               ",\"externalFunctionCalls\":" + std::to_string(m.getExternalFunctionCallsCount()) +
+               ",\"externalMethodCalls\":" + std::to_string(m.getExternalMethodCallsCount()) +
+               ",\"const\":" + (m.isMethodConst() ? "true" : "false") + "}\n";
+    };
 
-    
-    for (const auto& m : *methods) {
-        std::string methodName = m.getName();
-        stringStream << std::left << setw_width << methodName; 
-        stringStream << setw_width << m.getStereotype() << '\n';
+    for (auto& pair : classes) {
+        classModel& c = pair.second;
+        const std::string className = jsonString(c.getName()[1]);
+
+        std::string parents;
+        for (const auto& parent : c.getParentClassName()) parents += (parents.empty() ? "" : ",") + jsonString(parent.first);
+
+        std::string lines = "{\"kind\":\"class\"," + unitMembers(c.getFirstUnitNumber()) + ",\"class\":" + className + 
+                            ",\"stereotype\":" + jsonString(c.getStereotype()) + profileMember +
+                            ",\"methods\":" + std::to_string(c.getMethods().size()) + 
+                            ",\"dataMembers\":" + std::to_string(c.getDataMembers().size()) + 
+                            ",\"parents\":[" + parents + "]}\n";
+        for (const auto& m : c.getMethods())
+            lines += "{\"kind\":\"method\"," + unitMembers(m.getUnitNumber()) + ",\"class\":" + className + methodMembers(m);
+        out << lines << std::flush;
     }
-    stringStream << line << '\n'; 
+
+    if (!settings.freeFunction) return;
+    for (const auto& f : functions)
+        out << "{\"kind\":\"function\"," << unitMembers(f.getUnitNumber()) << methodMembers(f);
+    out.flush();
 }
 
-// Optional CSV report file containing stereotype information
+// Hands each class, its methods, and the free functions (if classified) with the stereotypes of one pass to the callbacks
+// A class is given with the file name of its first unit
 //
-void classModelCollection::outputCsvReportFile(std::ofstream& out, classModel* c) {
-    std::vector<methodModel>* methods = &freeFunctions;
+void classModelCollection::notifyElements(std::size_t profile, 
+                                          std::unordered_map<std::string, classModel>& classes, const std::vector<methodModel>& functions) {
+    auto filename = [&](int unitNumber) -> const std::string& {
+        static const std::string none;
+        return unitNumber >= 1 && static_cast<std::size_t>(unitNumber) <= unitFilenames.size() ? unitFilenames[unitNumber - 1] : none;
+    };
 
-    std::string classInfo;
-    if (c != nullptr) {
-        classInfo = "\"" + c->getName()[1] + "\",\"" + c->getStereotype() + "\"";
-        methods = &c->getMethods();
+    for (auto& pair : classes) {
+        classModel& c = pair.second;
+        if (callbacks->classFound) callbacks->classFound(profile, filename(c.getFirstUnitNumber()), c);
+        if (callbacks->methodFound)
+            for (const auto& m : c.getMethods()) callbacks->methodFound(profile, filename(m.getUnitNumber()), &c, m);
     }
 
-    for (const auto& m : *methods) {
-        std::string methodName = "\"" + m.getName() + "\"";
-        if (c != nullptr) out << classInfo << ",";
-        out << methodName << "," << "\"" + m.getStereotype() + "\"" << '\n';          
-    }
+    if (!settings.freeFunction || !callbacks->methodFound) return;
+    for (const auto& f : functions) callbacks->methodFound(profile, filename(f.getUnitNumber()), nullptr, f);
 }
 
-//  Add in stereotypes on <class> and <function>
-//  Example: <function st:stereotype="get"> ... </function>
-//           <class st:stereotype="boundary"> ... ></class>
+// Outputs how many methods (and free functions if analyzed) were decided at each analysis stage
 //
-void classModelCollection::outputWithStereotypes(srcml_unit* unit, std::map<int, srcml_unit*>& transformedUnits,
-                                                int unitNumber, const std::unordered_map<std::string, std::string>& xpathPair,
-                                                std::unordered_map<int, srcml_transform_result*>& results, std::mutex& mu) {  
-        srcml_archive* archive = srcml_archive_create();
-        bool transform = false;
-        for (auto& pair : xpathPair) { 
-            srcml_append_transform_xpath_attribute(archive, pair.first.c_str(), "st",
-                                    "http://www.srcML.org/srcML/stereotype",
-                                    "stereotype", pair.second.c_str());             
-            transform = true;               
-        }  
-        if (transform) {
-            srcml_transform_result* result = nullptr; 
-            srcml_unit_apply_transforms(archive, unit, &result);
-            srcml_unit* resultUnit = srcml_transform_get_unit(result, 0);  
-            {
-                std::lock_guard<std::mutex> guard(mu);
-                transformedUnits.insert({unitNumber, resultUnit});
-                results.insert({unitNumber, result});   
-            }
-        }
-        else {
-            std::lock_guard<std::mutex> guard(mu);
-            transformedUnits.insert({unitNumber, unit});
-        }
-             
-        srcml_clear_transforms(archive); 
-        srcml_archive_free(archive);
+void classModelCollection::outputAnalysisTiers(const std::vector<int>& tierCount) {
+    std::cerr << "---Analysis Stages---";
+    for (std::size_t i = 0; i < ANALYSIS_TIER_NAMES.size(); ++i)
+        std::cerr << "\n[" << ANALYSIS_TIER_NAMES[i] << "]: " << tierCount[i];
+    std::cerr << "\n\n";
 }
-
-// Inserts the stereotype as a comment before each function or class tag
-// For example, /** @stereotype get */
-// last_ws is used to preserve to the whitespace that precedes each function or class
-//
-void classModelCollection::outputAsComments(srcml_unit* unit, srcml_archive* outputArchive) {
-    std::string xslt = R"**(<xsl:stylesheet
-    xmlns="http://www.srcML.org/srcML/src"
-    xmlns:xsl="http://www.w3.org/1999/XSL/Transform"
-    xmlns:src="http://www.srcML.org/srcML/src" 
-    xmlns:cpp="http://www.srcML.org/srcML/cpp"
-    xmlns:st="http://www.srcML.org/srcML/stereotype"
-    xmlns:func="http://exslt.org/functions"
-    extension-element-prefixes="func"
-    exclude-result-prefixes="src st cpp"
-    version="1.0">
-    
-    <xsl:output method="xml" version="1.0" encoding="UTF-8" standalone="yes"/>
-    <xsl:template match="@*|node()"><xsl:copy><xsl:apply-templates select="@*|node()"/></xsl:copy></xsl:template>
- 
-    <func:function name="src:last_ws">
-        <xsl:param name="s"/>
-        <xsl:choose>
-        <xsl:when test="contains($s, '&#xa;')">
-            <func:result select="src:last_ws(substring-after($s, '&#xa;'))"/>
-        </xsl:when>
-        <xsl:otherwise>
-            <func:result select="$s"/>
-        </xsl:otherwise>
-        </xsl:choose>
-    </func:function>
-    
-    <xsl:template match="*[@st:stereotype]">
-        <comment type="block">
-            <xsl:text>/** @Stereotype </xsl:text>
-            <xsl:value-of select="@st:stereotype"/>
-            <xsl:text> */</xsl:text>
-        </comment>
-        <xsl:text>&#xa;</xsl:text>
-        <xsl:value-of select="src:last_ws(preceding-sibling::text()[1])"/>
-        <xsl:copy>
-            <xsl:apply-templates select="@*|node()"/>
-        </xsl:copy>
-    </xsl:template>
-    </xsl:stylesheet>
-    )**"; 
-
-    srcml_archive* archive = srcml_archive_create();
-    srcml_transform_result* result = nullptr; 
-
-    srcml_append_transform_xslt_memory(archive, xslt.c_str(), xslt.size());           
-    srcml_unit_apply_transforms(archive, unit, &result);
-
-    srcml_unit* resultUnit = srcml_transform_get_unit(result, 0);  
-    srcml_archive_write_unit(outputArchive, resultUnit); 
-    
-    srcml_transform_free(result);  
-    srcml_clear_transforms(archive); 
-    srcml_archive_free(archive);
-}
-
@@ -13,34 +13,158 @@
 #include <thread>
 #include <iomanip> 
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <cstring>
+#include <chrono>
 #include "ClassModel.hpp"
 #include "stereotypes.hpp"
+#include "UnitElements.hpp"
+#include "CompressedArchive.hpp"
+#include "StereotypeReports.hpp"
+#include "FactStore.hpp"
+#include "AnalysisCache.hpp"
+
+// Copy of a unit with stereotype attributes, read back as a unit so it can be written to the output archive
+// The srcML is kept until the unit is written since the archive reads from it
+// Units without stereotypes are not copied (i.e., 'unit' is 'original' and there is no archive)
+//
+struct annotatedUnit {
+    std::string          srcML;
+    srcml_archive*       archive{nullptr};
+    srcml_unit*          unit{nullptr};
+    srcml_unit*          original{nullptr};         // Unit read from the input archive
+    srcml_archive*       originalArchive{nullptr};  // Archive that reads 'original' from 'originalSrcML' if it was spooled (stdin input)
+    std::string          originalSrcML;
+    std::string          sidecar;                   // Records of the annotated elements (--sidecar)
+};
+
+// Classes and free functions found in a unit, kept so later units with the same content can copy them (see copyUnit())
+//
+struct foundUnit {
+    std::size_t              contentBytes{0};       // Size of the unit srcML without the file name
+    std::vector<classPart>   parts;
+    std::size_t              firstFunction{0};      // Position of the first free function of the unit in 'freeFunctions'
+    std::size_t              functionCount{0};
+    const std::string*       cacheRecord{nullptr};  // Record of the unit if it was restored from the analysis cache (--cache)
+    double                   seconds{0};            // Time taken to find them
+};
+
+// State of the units read by the default mode, shared by its steps (see classModelCollection::readUnits())
+//
+struct unitReads {
+    bool                                            writeArchive{false};    // Units are annotated for an output archive or a callback
+    bool                                            annotateUnits{false};   // Units are annotated (output archive, callback, or sidecar)
+
+    std::vector<srcml_unit*>                        retainedUnits;          // Units kept for output (within the memory budget)
+    std::size_t                                     budget{0};              // Bytes (-b)
+    std::size_t                                     retainedBytes{0};
+    std::size_t                                     analysisBytes{0};
+    std::size_t                                     skippedUnits{0};        // Units without classes or functions
+    bool                                            overBudget{false};
+    std::FILE*                                      spool{nullptr};         // Units past the budget read from stdin
+    std::size_t                                     spooledUnits{0};
+    std::size_t                                     spooledBytes{0};
+
+    std::unordered_map<std::string, foundUnit>      foundUnits;             // First unit with each content. Key is the content hash
+    std::deque<foundUnit>                           uncopiedUnits;          // Units that could not copy the unit with the same content
+    std::size_t                                     duplicateUnits{0};
+    std::size_t                                     duplicateBytes{0};
+    double                                          savedSeconds{0};
+
+    analysisCache                                   cache;                  // --cache
+    std::string                                     cacheKey;
+    bool                                            cacheRead{false};
+    std::map<int, std::pair<std::string, const std::vector<classPart>*>> analyzedParts;    // Units that were not restored. Key is unit number
+    std::size_t                                     restoredUnits{0};
+    std::size_t                                     restoredBytes{0};
+    std::size_t                                     analyzedUnits{0};
+};
+
+// Results handed to the caller as soon as they are final, without writing them to files (see stereocodeAnalyzer)
+// Models and units are only valid during the call. The pass is 0 for the default settings and then one per profile (-P)
+// Units are given in order, with their stereotypes, from the thread that writes the output archive
+//
+struct analysisCallbacks {
+    std::function<void(std::size_t, const std::string&, const classModel&)>                             classFound;     // Pass, file name, class
+    std::function<void(std::size_t, const std::string&, const classModel*, const methodModel&)>         methodFound;    // Class is null for free functions
+    std::function<void(int, srcml_unit*)>                                                               unitAnnotated;  // Unit number, unit
+};
 
 class classModelCollection {
 public:
-                         classModelCollection           (srcml_archive*, srcml_archive*, const std::string&, const std::string&, bool, bool, bool);
+                         classModelCollection           (const analysisSettings&, srcml_archive*, srcml_archive*, const std::string&, 
+                                                         bool, bool, bool, bool, const std::string&, std::ostream*, const std::string&, 
+                                                         const analysisCallbacks* = nullptr, 
+                                                         const std::function<int(srcml_archive*)>& = nullptr);
+
+    bool                 readUnits                      (srcml_archive*, const std::string&, bool, unitReads&);
+    void                 extractUnit                    (srcml_archive*, srcml_unit*, int, std::size_t, unitReads&);
+    void                 resolveModels                  ();
+    void                 writeAnalysisCache             (unitReads&);
+    void                 classifyModels                 (const std::string&, bool, bool, bool, std::ostream*, const std::string&);
+    bool                 copyModelsForPass              (std::size_t, std::unordered_map<std::string, classModel>&, std::vector<methodModel>&,
+                                                         std::unordered_map<std::string, classModel>&, std::vector<methodModel>&) const;
+    void                 outputUnits                    (srcml_archive*, srcml_archive*, const std::string&, bool, const std::string&, unitReads&);
 
-    void                 findClassInfo                  (srcml_archive*, srcml_unit*, int);
-    void                 findFreeFunctions              (srcml_archive*, srcml_unit*, int);
+    void                 analyzeInTwoPhases             (srcml_archive*, srcml_archive*, const std::string&, bool, bool, bool, bool, 
+                                                         const std::string&, std::ostream*);
+    std::vector<std::string> findClassInfo              (srcml_archive*, srcml_unit*, const unitElements&, int, 
+                                                         std::unordered_map<std::string, classModel>&, bool, std::vector<classPart>* = nullptr);
+    void                 findFreeFunctions              (srcml_archive*, srcml_unit*, const unitElements&, int, std::vector<methodModel>&);
+    void                 forEachFreeFunction            (srcml_archive*, srcml_unit*, const std::string&, 
+                                                         const std::function<void(int, srcml_archive*, srcml_unit*)>&);
+    bool                 isPartExtractionValid          (const std::vector<classPart>&, const std::vector<std::vector<methodModel>>&);
+    void                 addParts                       (int, const std::string&, std::vector<classPart>&, std::vector<std::vector<methodModel>>&);
+    bool                 restoreUnit                    (srcml_archive*, srcml_unit*, int, const std::string&, const std::string&, 
+                                                         std::vector<classPart>&);
+    bool                 copyUnit                       (const foundUnit&, int, const std::string&);
+    void                 addCachedUnits                 (analysisCache&, const std::map<int, std::pair<std::string, const std::vector<classPart>*>>&);
+    void                 findInheritance                ();
     void                 findInheritedDataMembers       (classModel&);
     void                 findInheritedMethods           (classModel&);
+    bool                 findMethodClass                (const methodModel&, std::string&) const;
 
-    void                 outputWithStereotypes          (srcml_unit*, std::map<int, srcml_unit*>&,
-                                                         int, const std::unordered_map<std::string, std::string>&,  
-                                                         std::unordered_map<int, srcml_transform_result*>&, std::mutex&);
-    void                 outputAsComments               (srcml_unit*, srcml_archive*) ;                            
-    void                 outputTxtReportFile            (std::stringstream&, classModel*);
-    void                 outputCsvReportFile            (std::ofstream&, classModel*);
-    void                 outputCsvVerboseReportFile     (const std::string&);
+    void                 outputWithStereotypes          (annotatedUnit&, int, const std::map<int, stereotypeMask>&);
+    void                 outputAnnotatedUnits           (srcml_archive*, srcml_archive*, bool, const std::string&, 
+                                                         const std::function<std::unique_ptr<annotatedUnit>()>&);
+    void                 outputArchiveUnits             (srcml_archive*, std::ostream*, 
+                                                         const std::function<std::unique_ptr<annotatedUnit>()>&);
+    void                 outputReportFiles              (const std::string&, bool, bool, bool,
+                                                         std::unordered_map<std::string, classModel>&, const std::vector<methodModel>&);
+    void                 addReportRows                  (stereotypeReports&, stereotypeRollup*, 
+                                                         std::unordered_map<std::string, classModel>&, const std::vector<methodModel>&);
+    void                 outputEvents                   (std::ostream&, std::size_t, 
+                                                         std::unordered_map<std::string, classModel>&, const std::vector<methodModel>&);
+    void                 notifyElements                 (std::size_t, std::unordered_map<std::string, classModel>&, const std::vector<methodModel>&);
+    void                 outputAnalysisTiers            (const std::vector<int>&);
 
     bool                 isFriendFunction               (methodModel&);
     void                 analyzeFreeFunctions();
+
+    const std::string&   getError                       () const                    { return error; }
     
 private:
+    const analysisSettings&                             settings;           // Read only, so analyses with other settings can run at the same time
+    annotationList                                      annotations;        // Stereotypes of the elements of each unit not written yet
+    std::mutex                                          annotationsMutex;   // The output threads free the annotations of each unit written
     std::unordered_map<std::string, classModel>         classCollection;    // List of class names and their models
     std::unordered_map<std::string, std::string>        classGenerics;      // List of class names with and without generic parameter lists <> for inheritance matching
     std::vector<methodModel>                            freeFunctions;      // List of free functions
+    std::vector<std::string>                            unitFilenames;      // File name of each unit (unit number - 1)
+    std::vector<std::string>                            unitNamespaces;     // First package or namespace of each unit (--rollup)
+    std::vector<std::pair<std::string, std::string>>    outputNamespaces;   // Prefix and uri of the namespaces declared on annotated units
+    std::vector<std::string>                            profileAttributes;  // st:stereotype-<profile> attribute names
+    bool                                                docComment{false};      // Add stereotypes as comments (-c)
+    bool                                                archiveOutput{false};   // Annotated units are written to an output archive
+    bool                                                sidecarOutput{false};   // Annotated elements are written to a sidecar (--sidecar)
+    const analysisCallbacks*                            callbacks{nullptr};     // Results handed to the caller (null if none)
+    std::function<int(srcml_archive*)>                  reopen;                 // Opens the input again for output (null to open 'inputFile' again)
+    std::string                                         error;                  // Why the run was stopped (empty if it was not)
 };
 
 #endif
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file CompressedArchive.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "CompressedArchive.hpp"
+
+// Archives with the extension .gz are read and written as gzip
+//
+bool isCompressedArchive(const std::string& fileName) {
+    return fileName.size() > 3 && fileName.compare(fileName.size() - 3, 3, ".gz") == 0;
+}
+
+// File name of an archive without .xml (and .gz)
+// Used as the prefix of the report files and of the default output archive ('stdin' for -)
+//
+std::string archiveNameNoExt(const std::string& fileName) {
+    if (fileName == "-") return "stdin";
+    std::string name = isCompressedArchive(fileName) ? fileName.substr(0, fileName.size() - 3) : fileName;
+    return name.substr(0, name.size() - 4);
+}
+
+static ssize_t gzipRead(void* context, void* buffer, std::size_t size) {
+    return gzread(static_cast<gzFile>(context), buffer, static_cast<unsigned int>(size));
+}
+
+static int gzipClose(void* context) {
+    return gzclose(static_cast<gzFile>(context));
+}
+
+// Opens an input archive, inflating it while it is read if it is compressed (.gz)
+// The input archive '-' is read from stdin, which may be compressed or not
+// Returns the error of libsrcml, or 2 if the file cannot be opened
+//
+int openInputArchive(srcml_archive* archive, const std::string& fileName) {
+    if (fileName == "-") {
+        gzFile input = gzdopen(fileno(stdin), "rb");
+        if (input == nullptr) return 2;
+        gzbuffer(input, 128 * 1024);
+        return srcml_archive_read_open_io(archive, input, gzipRead, gzipClose);
+    }
+    if (!isCompressedArchive(fileName)) return srcml_archive_read_open_filename(archive, fileName.c_str());
+
+    gzFile file = gzopen(fileName.c_str(), "rb");
+    if (file == nullptr) return 2;
+    gzbuffer(file, 128 * 1024);
+    return srcml_archive_read_open_io(archive, file, gzipRead, gzipClose);
+}
+
+// Registers the stereotype namespace in an output archive, and the position namespace if the input archive has it
+//
+void registerOutputNamespaces(srcml_archive* outputArchive, srcml_archive* archive) {
+    srcml_archive_register_namespace(outputArchive, "st", "http://www.srcML.org/srcML/stereotype"); 
+    std::size_t size = srcml_archive_get_namespace_size(archive);
+    for (std::size_t i = 0; i < size; i++) {
+        if (strcmp(srcml_archive_get_namespace_prefix(archive, i), "pos")  == 0) {
+            srcml_archive_register_namespace(outputArchive, "pos", "http://www.srcML.org/srcML/position");
+            break;
+        }
+    }
+}
+
+parallelDeflate::parallelDeflate(unsigned int threads) {
+    if (threads == 0) threads = 1;
+    capacity = 2 * threads;
+    for (unsigned int i = 0; i < threads; ++i) workers.push_back(std::thread(&parallelDeflate::compressBlocks, this));
+}
+
+parallelDeflate::~parallelDeflate() {
+    stopWorkers();
+    if (file) std::fclose(file);
+}
+
+// Opens the output archive for writing through the compressor
+// Returns 2 if the file cannot be created
+//
+int parallelDeflate::open(srcml_archive* archive, const std::string& fileName) {
+    file = std::fopen(fileName.c_str(), "wb");
+    if (file == nullptr) return 2;
+
+    // gzip header: no file name or time, unknown OS
+    const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        std::fclose(file);
+        file = nullptr;
+        return 2;
+    }
+    crc = crc32(0L, Z_NULL, 0);
+    return srcml_archive_write_open_io(archive, this, writeCallback, closeCallback);
+}
+
+// Returns -1 once a write to the file has failed, so the rest of the archive is not compressed
+//
+ssize_t parallelDeflate::writeCallback(void* context, const void* data, std::size_t length) {
+    parallelDeflate* deflater = static_cast<parallelDeflate*>(context);
+    if (deflater->writeFailed) return -1;
+    const char* bytes = static_cast<const char*>(data);
+    std::size_t written = 0;
+    while (written < length) {
+        std::size_t n = std::min(length - written, BLOCK_SIZE - deflater->buffer.size());
+        deflater->buffer.append(bytes + written, n);
+        written += n;
+        if (deflater->buffer.size() == BLOCK_SIZE) deflater->submitBlock(false);
+    }
+    return static_cast<ssize_t>(length);
+}
+
+// Compresses the rest of the archive and writes the gzip trailer (CRC and size, little endian)
+// Returns non-zero if any write to the file failed (see failed())
+//
+int parallelDeflate::closeCallback(void* context) {
+    parallelDeflate* deflater = static_cast<parallelDeflate*>(context);
+    deflater->submitBlock(true);
+    deflater->writeFinishedBlocks(true);
+    deflater->stopWorkers();
+
+    unsigned char trailer[8];
+    for (int i = 0; i < 4; ++i) {
+        trailer[i]     = static_cast<unsigned char>((deflater->crc >> (8 * i)) & 0xff);
+        trailer[4 + i] = static_cast<unsigned char>((deflater->size >> (8 * i)) & 0xff);
+    }
+    if (std::fwrite(trailer, 1, sizeof(trailer), deflater->file) != sizeof(trailer)) deflater->writeFailed = true;
+    if (std::fclose(deflater->file) != 0) deflater->writeFailed = true;
+    deflater->file = nullptr;
+    return deflater->writeFailed ? -1 : 0;
+}
+
+// Queues the buffered input as a block
+//
+void parallelDeflate::submitBlock(bool last) {
+    std::shared_ptr<deflateBlock> block = std::make_shared<deflateBlock>();
+    block->input.swap(buffer);
+    block->dictionary = dictionary;
+    block->last = last;
+
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(block->input.data()), static_cast<uInt>(block->input.size()));
+    size += static_cast<uLong>(block->input.size());
+    if (block->input.size() >= WINDOW_SIZE)
+        dictionary = block->input.substr(block->input.size() - WINDOW_SIZE);
+    else {
+        dictionary += block->input;
+        if (dictionary.size() > WINDOW_SIZE) dictionary.erase(0, dictionary.size() - WINDOW_SIZE);
+    }
+    {
+        std::lock_guard<std::mutex> guard(mu);
+        jobs.push_back(block);
+        blocks.push_back(block);
+    }
+    blockQueued.notify_one();
+    writeFinishedBlocks(false);
+}
+
+// Writes the compressed blocks that are next in order
+// Waits for blocks while too many are queued, or until all are written if 'all' is true
+//
+void parallelDeflate::writeFinishedBlocks(bool all) {
+    while (true) {
+        std::shared_ptr<deflateBlock> block;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            if (blocks.empty()) return;
+            if (all || blocks.size() > capacity)
+                blockDone.wait(lock, [&]() { return blocks.front()->done; });
+            else if (!blocks.front()->done)
+                return;
+            block = blocks.front();
+            blocks.pop_front();
+        }
+        if (std::fwrite(block->output.data(), 1, block->output.size(), file) != block->output.size()) writeFailed = true;
+    }
+}
+
+void parallelDeflate::compressBlocks() {
+    while (true) {
+        std::shared_ptr<deflateBlock> block;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            blockQueued.wait(lock, [&]() { return !jobs.empty() || stopping; });
+            if (jobs.empty()) return;
+            block = jobs.front();
+            jobs.pop_front();
+        }
+
+        z_stream stream{};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        if (!block->dictionary.empty())
+            deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(block->dictionary.data()), static_cast<uInt>(block->dictionary.size()));
+
+        // The bound is for Z_FINISH, so the output grows if a flush needs more
+        const int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+        block->output.resize(deflateBound(&stream, static_cast<uLong>(block->input.size())) + 16);
+        stream.next_in   = reinterpret_cast<Bytef*>(&block->input[0]);
+        stream.avail_in  = static_cast<uInt>(block->input.size());
+        stream.next_out  = reinterpret_cast<Bytef*>(&block->output[0]);
+        stream.avail_out = static_cast<uInt>(block->output.size());
+        while (true) {
+            int status = deflate(&stream, flush);
+            if (flush == Z_FINISH ? status == Z_STREAM_END : stream.avail_out != 0) break;
+
+            std::size_t used = stream.total_out;
+            block->output.resize(2 * block->output.size());
+            stream.next_out  = reinterpret_cast<Bytef*>(&block->output[used]);
+            stream.avail_out = static_cast<uInt>(block->output.size() - used);
+        }
+        block->output.resize(stream.total_out);
+        deflateEnd(&stream);
+        block->input.clear();
+        block->input.shrink_to_fit();
+
+        {
+            std::lock_guard<std::mutex> guard(mu);
+            block->done = true;
+        }
+        blockDone.notify_all();
+    }
+}
+
+void parallelDeflate::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> guard(mu);
+        stopping = true;
+    }
+    blockQueued.notify_all();
+    for (std::thread& worker : workers) if (worker.joinable()) worker.join();
+    workers.clear();
+}
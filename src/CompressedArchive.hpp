@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file CompressedArchive.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef COMPRESSEDARCHIVE_HPP
+#define COMPRESSEDARCHIVE_HPP
+
+#include <srcml.h>
+#include <zlib.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+bool                    isCompressedArchive     (const std::string&);
+std::string             archiveNameNoExt        (const std::string&);
+int                     openInputArchive        (srcml_archive*, const std::string&);
+void                    registerOutputNamespaces(srcml_archive*, srcml_archive*);
+
+// Block of an output archive compressed by one worker
+//
+struct deflateBlock {
+    std::string         input;
+    std::string         dictionary;             // Last 32 KB of the input of the block before it
+    std::string         output;
+    bool                last{false};            // Ends the deflate stream
+    bool                done{false};
+};
+
+// Writes an output archive as gzip (.gz) and compresses blocks of it in parallel (like pigz)
+// Each block is raw deflate that ends on a byte boundary and is primed with the end of the block before it,
+//  so the compressed blocks join into one deflate stream that any gzip reader can inflate
+// The writing thread computes the CRC and writes finished blocks in order. At most twice the number
+//  of workers are queued, so memory is bounded by the block size
+// libsrcml does not return the result of the close callback, so write errors are checked with failed() after the close
+//
+class parallelDeflate {
+public:
+                        parallelDeflate         (unsigned int);
+                        ~parallelDeflate        ();
+
+    int                 open                    (srcml_archive*, const std::string&);
+    bool                failed                  () const                    { return writeFailed; }
+
+private:
+    static ssize_t      writeCallback           (void*, const void*, std::size_t);
+    static int          closeCallback           (void*);
+
+    void                submitBlock             (bool);
+    void                writeFinishedBlocks     (bool);
+    void                compressBlocks          ();
+    void                stopWorkers             ();
+
+    static const std::size_t                    BLOCK_SIZE = 128 * 1024;
+    static const std::size_t                    WINDOW_SIZE = 32 * 1024;
+
+    std::FILE*                                  file{nullptr};
+    std::string                                 buffer;             // Input of the next block
+    std::string                                 dictionary;
+    uLong                                       crc{0};
+    uLong                                       size{0};            // Input size modulo 2^32
+    std::size_t                                 capacity{2};
+
+    std::mutex                                  mu;
+    std::condition_variable                     blockQueued, blockDone;
+    std::deque<std::shared_ptr<deflateBlock>>   jobs;               // Blocks not yet compressed
+    std::deque<std::shared_ptr<deflateBlock>>   blocks;             // Blocks not yet written, in order
+    std::vector<std::thread>                    workers;
+    bool                                        stopping{false};
+    bool                                        writeFailed{false}; // A write to the file failed (e.g., the disk is full)
+};
+
+#endif
@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file FactStore.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "FactStore.hpp"
+
+std::uint32_t factStore::addString(const std::string& text) {
+    auto found = stringIndex.find(text);
+    if (found != stringIndex.end()) return found->second;
+
+    std::uint32_t index = static_cast<std::uint32_t>(stringOffsets.size() - 1);
+    stringBytes += text;
+    stringOffsets.push_back(static_cast<std::uint32_t>(stringBytes.size()));
+    stringIndex[text] = index;
+    return index;
+}
+
+// Adds the facts of the classes, their methods, and the free functions in collection order
+// Called once, since the facts are the same for every pass
+//
+void factStore::addFacts(std::unordered_map<std::string, classModel>& classCollection, const std::vector<methodModel>& freeFunctions,
+                         const std::vector<std::string>& filenames) {
+    builtColumns.assign(FACT_COLUMN_COUNT, {});
+    for (const auto& filename : filenames) builtUnitFilenames.push_back(addString(filename));
+
+    auto addMethodFacts = [&](const methodModel& m, std::uint32_t classRow) {
+        const bool flags[] = {
+            m.isMethodConst(), m.isDataMemberUsed(), m.isParameterUsed(), m.hasSimpleReturn(), m.hasComplexReturn(),
+            m.hasParameterComplexReturn(), m.isParameterRefModified(), m.isNewReturned(), m.isGlobalOrStaticVariableModified(),
+            m.isNonPrimitiveDataMemberExternal(), m.isNonPrimitiveReturnTypeExternal(), m.isNonPrimitiveLocalExternal(),
+            m.isNonPrimitiveParamaterExternal(), m.isNonPrimitiveReturnType(), m.isConstructorOrDestructor(),
+            m.isDestructor(), m.isVariableCreatedAndReturnedWithNew(), m.isNonPrimitiveLocalOrParameterModified()
+        };
+        std::uint32_t flagBits = 0;
+        for (std::size_t bit = 0; bit < sizeof(flags) / sizeof(flags[0]); ++bit)
+            if (flags[bit]) flagBits |= std::uint32_t(1) << bit;
+
+        builtColumns[FACT_METHOD_NAME].push_back(addString(m.getName()));
+        builtColumns[FACT_METHOD_SIGNATURE].push_back(addString(m.getNameSignature()));
+        builtColumns[FACT_METHOD_CLASS].push_back(classRow);
+        builtColumns[FACT_METHOD_UNIT].push_back(static_cast<std::uint32_t>(m.getUnitNumber()));
+        builtColumns[FACT_METHOD_ORDINAL].push_back(static_cast<std::uint32_t>(m.getOrdinal()));
+        builtColumns[FACT_METHOD_TIER].push_back(static_cast<std::uint32_t>(m.getAnalysisTier()));
+        builtColumns[FACT_METHOD_STATEMENTS].push_back(static_cast<std::uint32_t>(m.getNonCommentStatementsCount()));
+        builtColumns[FACT_METHOD_DATA_MEMBERS_MODIFIED].push_back(static_cast<std::uint32_t>(m.getDataMembersModifiedCount()));
+        builtColumns[FACT_METHOD_EXTERNAL_FUNCTION_CALLS].push_back(static_cast<std::uint32_t>(m.getExternalFunctionCallsCount()));
+        builtColumns[FACT_METHOD_EXTERNAL_METHOD_CALLS].push_back(static_cast<std::uint32_t>(m.getExternalMethodCallsCount()));
+        builtColumns[FACT_METHOD_FLAGS].push_back(flagBits);
+    };
+
+    for (auto& pair : classCollection) {
+        classModel& c = pair.second;
+
+        std::uint32_t classRow = static_cast<std::uint32_t>(classCount++);
+        builtColumns[FACT_CLASS_NAME].push_back(addString(c.getName()[1]));
+        builtColumns[FACT_CLASS_UNIT].push_back(static_cast<std::uint32_t>(c.getFirstUnitNumber()));
+        builtColumns[FACT_CLASS_FIRST_METHOD].push_back(static_cast<std::uint32_t>(methodCount));
+        builtColumns[FACT_CLASS_METHODS].push_back(static_cast<std::uint32_t>(c.getMethods().size()));
+        builtColumns[FACT_CLASS_DATA_MEMBERS].push_back(static_cast<std::uint32_t>(c.getDataMembers().size()));
+        builtColumns[FACT_CLASS_PARENTS].push_back(static_cast<std::uint32_t>(c.getParentClassName().size()));
+        builtColumns[FACT_CLASS_CONSTRUCTORS_DESTRUCTORS].push_back(static_cast<std::uint32_t>(c.getConstructorDestructorCount()));
+
+        for (const auto& m : c.getMethods()) addMethodFacts(m, classRow);
+        methodCount += c.getMethods().size();
+    }
+
+    for (const auto& f : freeFunctions) addMethodFacts(f, FACT_NO_CLASS);
+    functionCount = freeFunctions.size();
+    unitCount = filenames.size();
+}
+
+// Adds the stereotypes of one pass ('name' is empty for the default classification, otherwise the profile name)
+// The collection must be traversed in the same order as in addFacts
+//
+void factStore::addStereotypes(const std::string& name, std::unordered_map<std::string, classModel>& classCollection,
+                               const std::vector<methodModel>& freeFunctions) {
+    std::vector<std::uint32_t> classStereotypes, methodStereotypes;
+    for (auto& pair : classCollection) {
+        classStereotypes.push_back(pair.second.getStereotypeMask());
+        for (const auto& m : pair.second.getMethods()) methodStereotypes.push_back(m.getStereotypeMask());
+    }
+    for (const auto& f : freeFunctions) methodStereotypes.push_back(f.getStereotypeMask());
+
+    builtPassNames.push_back(addString(name));
+    builtMasks.push_back(std::move(classStereotypes));
+    builtMasks.push_back(std::move(methodStereotypes));
+    ++passCount;
+}
+
+// Returns false if the file cannot be written
+//
+bool factStore::write(const std::string& fileName) const {
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out.is_open()) return false;
+
+    auto writeWords = [&](const std::vector<std::uint32_t>& values) {
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(std::uint32_t)));
+    };
+
+    writeWords({MAGIC, VERSION, static_cast<std::uint32_t>(passCount), static_cast<std::uint32_t>(unitCount),
+                static_cast<std::uint32_t>(classCount), static_cast<std::uint32_t>(methodCount),
+                static_cast<std::uint32_t>(functionCount), static_cast<std::uint32_t>(stringOffsets.size() - 1),
+                static_cast<std::uint32_t>(stringBytes.size())});
+    writeWords(builtPassNames);
+    writeWords(builtUnitFilenames);
+    for (const auto& column : builtColumns) writeWords(column);
+    for (const auto& masks : builtMasks) writeWords(masks);
+    writeWords(stringOffsets);
+
+    // The string bytes are padded to a whole word
+    std::string padded = stringBytes;
+    padded.resize((padded.size() + 3) / 4 * 4, '\0');
+    out.write(padded.data(), static_cast<std::streamsize>(padded.size()));
+    return out.good();
+}
+
+// Reads a fact store written by write()
+// Returns false if the file cannot be read, is not a fact store, is truncated, or refers to rows or strings it does not have
+//
+bool factStore::read(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    std::size_t size = static_cast<std::size_t>(in.tellg());
+    if (size < HEADER_WORDS * sizeof(std::uint32_t) || size % sizeof(std::uint32_t) != 0) return false;
+
+    words.resize(size / sizeof(std::uint32_t));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(size))) return false;
+    if (words[0] != MAGIC || words[1] != VERSION) return false;
+
+    passCount     = words[2];
+    unitCount     = words[3];
+    classCount    = words[4];
+    methodCount   = words[5];
+    functionCount = words[6];
+    stringCount   = words[7];
+    std::size_t stringSize = words[8];
+    std::size_t methodRows = methodCount + functionCount;
+
+    // Counts that cannot fit in the file are rejected before the expected size is computed, so it cannot overflow
+    for (std::size_t count : {passCount, unitCount, classCount, methodRows, stringCount, stringSize})
+        if (count > size) return false;
+    if (passCount != 0 && classCount + methodRows > words.size() / passCount) return false;
+
+    std::size_t expected = HEADER_WORDS + passCount + unitCount + FACT_CLASS_COLUMN_COUNT * classCount +
+                           (FACT_COLUMN_COUNT - FACT_CLASS_COLUMN_COUNT) * methodRows + passCount * (classCount + methodRows) +
+                           stringCount + 1 + (stringSize + 3) / 4;
+    if (words.size() != expected) return false;
+
+    const std::uint32_t* next = words.data() + HEADER_WORDS;
+    passNames = next;
+    next += passCount;
+    unitFilenames = next;
+    next += unitCount;
+
+    columns.assign(FACT_COLUMN_COUNT, nullptr);
+    for (int column = 0; column < FACT_COLUMN_COUNT; ++column) {
+        columns[column] = next;
+        next += column < FACT_CLASS_COLUMN_COUNT ? classCount : methodRows;
+    }
+
+    classMasks.clear();
+    methodMasks.clear();
+    for (std::size_t pass = 0; pass < passCount; ++pass) {
+        classMasks.push_back(next);
+        next += classCount;
+        methodMasks.push_back(next);
+        next += methodRows;
+    }
+
+    offsets = next;
+    next += stringCount + 1;
+    strings = reinterpret_cast<const char*>(next);
+    return isValid(stringSize);
+}
+
+// Checks the references between the columns of a fact store that was read, so queries and reports can use them unchecked:
+//  the string offsets increase from 0 to the size of the string bytes, every string index is below the string count,
+//  the methods of each class are within the methods of classes, and the class of each method is a class row
+//
+bool factStore::isValid(std::size_t stringSize) const {
+    if (offsets[0] != 0 || offsets[stringCount] != stringSize) return false;
+    for (std::size_t i = 0; i < stringCount; ++i)
+        if (offsets[i] > offsets[i + 1]) return false;
+
+    auto isString = [&](std::uint32_t index) { return index < stringCount; };
+    for (std::size_t pass = 0; pass < passCount; ++pass)
+        if (!isString(passNames[pass])) return false;
+    for (std::size_t unit = 0; unit < unitCount; ++unit)
+        if (!isString(unitFilenames[unit])) return false;
+
+    for (std::size_t row = 0; row < classCount; ++row) {
+        if (!isString(columns[FACT_CLASS_NAME][row])) return false;
+        std::uint64_t end = std::uint64_t(columns[FACT_CLASS_FIRST_METHOD][row]) + columns[FACT_CLASS_METHODS][row];
+        if (end > methodCount) return false;
+    }
+
+    for (std::size_t row = 0; row < methodCount + functionCount; ++row) {
+        if (!isString(columns[FACT_METHOD_NAME][row]) || !isString(columns[FACT_METHOD_SIGNATURE][row])) return false;
+        std::uint32_t classRow = columns[FACT_METHOD_CLASS][row];
+        if (row < methodCount ? classRow >= classCount : classRow != FACT_NO_CLASS) return false;
+    }
+    return true;
+}
+
+std::string factStore::getString(std::uint32_t index) const {
+    if (index >= stringCount || offsets[index] > offsets[index + 1]) return "";
+    return std::string(strings + offsets[index], offsets[index + 1] - offsets[index]);
+}
+
+// Generates the report files of every pass (-x, -z, and the verbose report files) as the analysis would
+// 'fileNoExt' is the prefix of the report files. Profiles add their name to it
+//
+void factStore::outputReportFiles(const std::string& fileNoExt, bool outputTxtReport, bool outputCsvReport, bool outputVerbose) const {
+    for (std::size_t pass = 0; pass < passCount; ++pass) {
+        std::string reportFileNoExt = fileNoExt;
+        if (pass != 0) reportFileNoExt += "." + getPassName(pass);
+
+        stereotypeReports reports(reportFileNoExt, outputTxtReport, outputCsvReport, outputVerbose);
+        for (std::size_t row = 0; row < classCount; ++row) {
+            reports.addClass(getString(columns[FACT_CLASS_NAME][row]), classMasks[pass][row]);
+            std::size_t first = columns[FACT_CLASS_FIRST_METHOD][row];
+            for (std::size_t method = first; method < first + columns[FACT_CLASS_METHODS][row]; ++method)
+                reports.addMethod(getString(columns[FACT_METHOD_NAME][method]), methodMasks[pass][method]);
+            reports.endClass();
+        }
+        for (std::size_t function = methodCount; function < methodCount + functionCount; ++function)
+            reports.addFreeFunction(getString(columns[FACT_METHOD_NAME][function]), methodMasks[pass][function]);
+        reports.close();
+    }
+}
+
+// Outputs the classes, methods, and free functions that match a query as CSV
+// With 'count', outputs the number of matching elements of each kind and stereotype instead
+// Returns false (and outputs an error) if the profile or stereotype is unknown
+//
+bool factStore::outputQuery(std::ostream& out, const factQuery& query) const {
+    std::size_t pass = 0;
+    if (query.profile != "") {
+        while (pass < passCount && (pass == 0 || getPassName(pass) != query.profile)) ++pass;
+        if (pass == passCount) {
+            std::cerr << "Error: Profile not found in the fact store: " << query.profile << '\n';
+            return false;
+        }
+    }
+
+    // Bit of the stereotype label, or no bits if the label is not a stereotype of that kind of element
+    std::uint32_t classBit = 0, methodBit = 0;
+    if (query.stereotype != "") {
+        for (std::size_t bit = 0; bit < CLASS_STEREOTYPE_LABELS.size(); ++bit)
+            if (CLASS_STEREOTYPE_LABELS[bit] == query.stereotype) classBit = std::uint32_t(1) << bit;
+        for (std::size_t bit = 0; bit < METHOD_STEREOTYPE_LABELS.size(); ++bit)
+            if (METHOD_STEREOTYPE_LABELS[bit] == query.stereotype) methodBit = std::uint32_t(1) << bit;
+        if (classBit == 0 && methodBit == 0) {
+            std::cerr << "Error: Unknown stereotype: " << query.stereotype << '\n';
+            return false;
+        }
+    }
+
+    auto filename = [&](std::uint32_t unit) {
+        return unit >= 1 && unit <= unitCount ? getString(unitFilenames[unit - 1]) : "";
+    };
+
+    std::map<std::string, int> counts;
+    if (query.count) out << "Kind,Stereotype,Count" << '\n';
+    else             out << "Kind,File Name,Class Name,Method Name,Stereotype" << '\n';
+    auto match = [&](const std::string& kind, std::uint32_t unit, const std::string& className, const std::string& methodName,
+                     std::uint32_t mask, const std::array<std::string, CLASS_STEREOTYPE_COUNT>* classLabels) {
+        const std::string stereotype = classLabels ? stereotypeLabel(mask, *classLabels) : stereotypeLabel(mask, METHOD_STEREOTYPE_LABELS);
+        if (query.count)
+            counts[kind + ",\"" + stereotype + "\""]++;
+        else
+            out << kind << ",\"" << filename(unit) << "\",\"" << className << "\",\"" << methodName << "\",\"" << stereotype << "\"" << '\n';
+    };
+
+    for (std::size_t row = 0; row < classCount; ++row) {
+        const std::string className = getString(columns[FACT_CLASS_NAME][row]);
+        if (query.className != "" && className != query.className) continue;
+
+        if ((query.kind == "" || query.kind == "class") && (query.stereotype == "" || classMasks[pass][row] & classBit))
+            match("class", columns[FACT_CLASS_UNIT][row], className, "", classMasks[pass][row], &CLASS_STEREOTYPE_LABELS);
+
+        if (query.kind != "" && query.kind != "method") continue;
+        std::size_t first = columns[FACT_CLASS_FIRST_METHOD][row];
+        for (std::size_t method = first; method < first + columns[FACT_CLASS_METHODS][row]; ++method)
+            if (query.stereotype == "" || methodMasks[pass][method] & methodBit)
+                match("method", columns[FACT_METHOD_UNIT][method], className, getString(columns[FACT_METHOD_NAME][method]),
+                      methodMasks[pass][method], nullptr);
+    }
+
+    if (query.className == "" && (query.kind == "" || query.kind == "function"))
+        for (std::size_t function = methodCount; function < methodCount + functionCount; ++function)
+            if (query.stereotype == "" || methodMasks[pass][function] & methodBit)
+                match("function", columns[FACT_METHOD_UNIT][function], "", getString(columns[FACT_METHOD_NAME][function]),
+                      methodMasks[pass][function], nullptr);
+
+    if (query.count) {
+        int total = 0;
+        for (const auto& pair : counts) {
+            out << pair.first << "," << pair.second << '\n';
+            total += pair.second;
+        }
+        out << "Total" << ",," << total << '\n';
+    }
+    return true;
+}
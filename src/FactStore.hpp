@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file FactStore.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef FACTSTORE_HPP
+#define FACTSTORE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include "ClassModel.hpp"
+#include "StereotypeReports.hpp"
+
+// Columns of the fact store
+// Methods and free functions share the method columns. The free functions follow the methods of the last class
+//
+enum factColumn {
+    FACT_CLASS_NAME,                    // String (class name without whitespaces)
+    FACT_CLASS_UNIT,                    // First unit of the class
+    FACT_CLASS_FIRST_METHOD,            // Row of the first method of the class
+    FACT_CLASS_METHODS,
+    FACT_CLASS_DATA_MEMBERS,            // Including inherited data members
+    FACT_CLASS_PARENTS,
+    FACT_CLASS_CONSTRUCTORS_DESTRUCTORS,
+    FACT_CLASS_COLUMN_COUNT,
+
+    FACT_METHOD_NAME = FACT_CLASS_COLUMN_COUNT, // String
+    FACT_METHOD_SIGNATURE,              // String (name and parameter types without whitespaces)
+    FACT_METHOD_CLASS,                  // Row of the class (FACT_NO_CLASS for free functions)
+    FACT_METHOD_UNIT,
+    FACT_METHOD_ORDINAL,                // Element ordinal in the unit (-1 if not annotated)
+    FACT_METHOD_TIER,                   // analysisTier
+    FACT_METHOD_STATEMENTS,             // Non-comment statements
+    FACT_METHOD_DATA_MEMBERS_MODIFIED,
+    FACT_METHOD_EXTERNAL_FUNCTION_CALLS,
+    FACT_METHOD_EXTERNAL_METHOD_CALLS,
+    FACT_METHOD_FLAGS,                  // Bits of factFlag
+    FACT_COLUMN_COUNT
+};
+
+// Boolean facts of a method (FACT_METHOD_FLAGS)
+//
+enum factFlag {
+    FACT_FLAG_CONST, FACT_FLAG_DATA_MEMBER_USED, FACT_FLAG_PARAMETER_USED, FACT_FLAG_SIMPLE_RETURN, FACT_FLAG_COMPLEX_RETURN,
+    FACT_FLAG_PARAMETER_COMPLEX_RETURN, FACT_FLAG_PARAMETER_REF_MODIFIED, FACT_FLAG_NEW_RETURNED, FACT_FLAG_GLOBAL_OR_STATIC_MODIFIED,
+    FACT_FLAG_NON_PRIMITIVE_DATA_MEMBER_EXTERNAL, FACT_FLAG_NON_PRIMITIVE_RETURN_TYPE_EXTERNAL, FACT_FLAG_NON_PRIMITIVE_LOCAL_EXTERNAL,
+    FACT_FLAG_NON_PRIMITIVE_PARAMETER_EXTERNAL, FACT_FLAG_NON_PRIMITIVE_RETURN_TYPE, FACT_FLAG_CONSTRUCTOR_OR_DESTRUCTOR,
+    FACT_FLAG_DESTRUCTOR, FACT_FLAG_CREATED_AND_RETURNED_WITH_NEW, FACT_FLAG_NON_PRIMITIVE_LOCAL_OR_PARAMETER_MODIFIED
+};
+
+const std::uint32_t FACT_NO_CLASS = 0xffffffff;
+
+// Elements selected by the query subcommand
+//
+struct factQuery {
+    std::string                                 kind;               // class, method, or function (empty for all)
+    std::string                                 stereotype;         // Label the stereotype must include (empty for all)
+    std::string                                 className;          // Class of the elements (empty for all)
+    std::string                                 profile;            // Stereotypes of a profile (-P) instead of the default ones
+    bool                                        count{false};       // Number of elements of each stereotype instead of the elements
+};
+
+// Per-class and per-method facts and stereotypes written with --facts and read by the query subcommand
+// Every value is a 32-bit word in native byte order and every column is a contiguous array, so the file
+//  can be mapped (or read in one call) and used in place without parsing
+// Layout:
+//
+// | header | pass names | unit file names | class columns | method columns | class and method stereotypes of each pass |
+// | string offsets (string count + 1) | string bytes |
+//
+// A pass is the default classification followed by each profile (-P). Strings are stored once and are
+//  referred to by index
+//
+class factStore {
+public:
+    void                        addFacts                (std::unordered_map<std::string, classModel>&, const std::vector<methodModel>&,
+                                                         const std::vector<std::string>&);
+    void                        addStereotypes          (const std::string&, std::unordered_map<std::string, classModel>&,
+                                                         const std::vector<methodModel>&);
+    bool                        write                   (const std::string&) const;
+
+    bool                        read                    (const std::string&);
+    void                        outputReportFiles       (const std::string&, bool, bool, bool) const;
+    bool                        outputQuery             (std::ostream&, const factQuery&) const;
+
+    std::size_t                 getClassCount           () const                            { return classCount;    }
+    std::size_t                 getMethodCount          () const                            { return methodCount;   }
+    std::size_t                 getFunctionCount        () const                            { return functionCount; }
+    std::size_t                 getPassCount            () const                            { return passCount;     }
+    std::uint32_t               getFact                 (factColumn column, std::size_t row) const   { return columns[column][row]; }
+    std::uint32_t               getClassStereotype      (std::size_t pass, std::size_t row) const    { return classMasks[pass][row];  }
+    std::uint32_t               getMethodStereotype     (std::size_t pass, std::size_t row) const    { return methodMasks[pass][row]; }
+    std::string                 getString               (std::uint32_t) const;
+    std::string                 getPassName             (std::size_t pass) const            { return getString(passNames[pass]); }
+
+private:
+    std::uint32_t               addString               (const std::string&);
+    bool                        isValid                 (std::size_t) const;
+
+    static const std::uint32_t                      MAGIC = 0x53544653;     // "STFS"
+    static const std::uint32_t                      VERSION = 1;
+    static const std::size_t                        HEADER_WORDS = 9;
+
+    // Built by the analysis
+    std::vector<std::vector<std::uint32_t>>         builtColumns;
+    std::vector<std::vector<std::uint32_t>>         builtMasks;             // Class then method stereotypes of each pass
+    std::vector<std::uint32_t>                      builtPassNames;
+    std::vector<std::uint32_t>                      builtUnitFilenames;
+    std::vector<std::uint32_t>                      stringOffsets{0};
+    std::string                                     stringBytes;
+    std::unordered_map<std::string, std::uint32_t>  stringIndex;
+
+    // Read from a file
+    std::vector<std::uint32_t>                      words;
+    std::vector<const std::uint32_t*>               columns;
+    std::vector<const std::uint32_t*>               classMasks;
+    std::vector<const std::uint32_t*>               methodMasks;
+    const std::uint32_t*                            passNames{nullptr};
+    const std::uint32_t*                            unitFilenames{nullptr};
+    const std::uint32_t*                            offsets{nullptr};
+    const char*                                     strings{nullptr};
+
+    std::size_t                                     passCount{0};
+    std::size_t                                     unitCount{0};
+    std::size_t                                     classCount{0};
+    std::size_t                                     methodCount{0};         // Methods of classes
+    std::size_t                                     functionCount{0};       // Free functions
+    std::size_t                                     stringCount{0};
+};
+
+#endif
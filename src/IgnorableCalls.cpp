@@ -14,7 +14,7 @@ extern std::vector<std::string> LANGUAGE;
 // Checks if 'call' is ignored
 // User-defined calls are checked for all languages
 //
-bool ignorableCalls::isIgnored(const std::string& call, const std::string& unitLanguage) {
+bool ignorableCalls::isIgnored(const std::string& call, const std::string& unitLanguage) const {
 return (ignoredCalls.at(unitLanguage).find(call) != ignoredCalls.at(unitLanguage).end()) || 
        (userIgnoredCalls.find(call) != userIgnoredCalls.end());
 }
@@ -51,8 +51,10 @@ void ignorableCalls::outputCalls() {
 }
 
 // Specific calls to ignore are used based on unit language
+// The list is only created once (--serve analyzes many archives)
 //
 void ignorableCalls::createCallList() {
+    if (!ignoredCalls.empty()) return;
     for (const auto& l : LANGUAGE) {
         // cout, cin, streams, casts are all ignored (not collected) for C++ since they are not considered as a <call>
         if (l == "C++") {
@@ -19,10 +19,11 @@
 
 class ignorableCalls {
 public:
-    bool                 isIgnored                (const std::string&, const std::string&);
+    bool                 isIgnored                (const std::string&, const std::string&) const;
     void                 addCall                  (const std::string&);
     void                 createCallList           ();
     void                 outputCalls              ();
+    const std::unordered_set<std::string>& getUserCalls () const { return userIgnoredCalls; }
     friend std::istream& operator>>               (std::istream&, ignorableCalls&);
 
 private:
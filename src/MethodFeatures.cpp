@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file MethodFeatures.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "MethodFeatures.hpp"
+
+// Adds the classification inputs of a method in a class
+// 'className' is the class name without whitespaces, namespaces, and generic types <>
+//
+void methodFeatures::addMethod(const methodModel& m, const std::string& className, const std::string& classUnitLanguage) {
+    std::uint32_t f = 0;
+
+    if (m.isConstructorOrDestructor())                                      f |= FEATURE_CONSTRUCTOR_OR_DESTRUCTOR;
+    if (m.isDestructor())                                                   f |= FEATURE_DESTRUCTOR;
+    if (m.getParameterList().find(className) != std::string::npos)          f |= FEATURE_COPY_CONSTRUCTOR;
+    if (m.isDataMemberUsed())                                               f |= FEATURE_DATA_MEMBER_USED;
+    if (m.isMethodConst())                                                  f |= FEATURE_METHOD_CONST;
+    if (m.hasSimpleReturn())                                                f |= FEATURE_SIMPLE_RETURN;
+    if (m.hasComplexReturn())                                               f |= FEATURE_COMPLEX_RETURN;
+    if (m.isParameterRefModified())                                         f |= FEATURE_PARAMETER_REF_MODIFIED;
+    if (m.isNewReturned())                                                  f |= FEATURE_NEW_RETURNED;
+    if (m.isVariableCreatedAndReturnedWithNew())                            f |= FEATURE_CREATED_WITH_NEW_AND_RETURNED;
+    if (m.isNonPrimitiveReturnType())                                       f |= FEATURE_NON_PRIMITIVE_RETURN_TYPE;
+    if (m.isNonPrimitiveLocalOrParameterModified())                         f |= FEATURE_NON_PRIMITIVE_LOCAL_OR_PARAMETER_MODIFIED;
+    if (m.isNonPrimitiveDataMemberExternal())                               f |= FEATURE_NON_PRIMITIVE_DATA_MEMBER_EXTERNAL;
+    if (m.isNonPrimitiveLocalExternal())                                    f |= FEATURE_NON_PRIMITIVE_LOCAL_EXTERNAL;
+    if (m.isNonPrimitiveParamaterExternal())                                f |= FEATURE_NON_PRIMITIVE_PARAMETER_EXTERNAL;
+    if (m.isNonPrimitiveReturnTypeExternal())                               f |= FEATURE_NON_PRIMITIVE_RETURN_TYPE_EXTERNAL;
+    addReturnType(f, m, classUnitLanguage, false);
+
+    flags.push_back(f);
+    counts[COUNT_DATA_MEMBERS_MODIFIED].push_back(m.getDataMembersModifiedCount());
+    counts[COUNT_METHOD_CALLS].push_back(m.getMethodCalls().size());
+    counts[COUNT_FUNCTION_CALLS].push_back(m.getFunctionCalls().size());
+    counts[COUNT_NEW_CONSTRUCTOR_CALLS].push_back(m.getNewConstructorCalls().size());
+    counts[COUNT_EXTERNAL_FUNCTION_CALLS].push_back(m.getExternalFunctionCallsCount());
+    counts[COUNT_EXTERNAL_METHOD_CALLS].push_back(m.getExternalMethodCallsCount());
+    counts[COUNT_NON_COMMENT_STATEMENTS].push_back(m.getNonCommentStatementsCount());
+}
+
+// Adds the classification inputs of a free function
+// Only the calls and statements are counted since a free function has no data members
+//
+void methodFeatures::addFreeFunction(const methodModel& f) {
+    std::uint32_t flag = 0;
+
+    if (f.getName() == "main" || f.getName() == "Main")                     flag |= FEATURE_MAIN;
+    if (f.isParameterUsed())                                                flag |= FEATURE_PARAMETER_USED;
+    if (f.hasParameterComplexReturn())                                      flag |= FEATURE_PARAMETER_COMPLEX_RETURN;
+    if (f.isParameterRefModified())                                         flag |= FEATURE_PARAMETER_REF_MODIFIED;
+    if (f.isGlobalOrStaticVariableModified())                               flag |= FEATURE_GLOBAL_OR_STATIC_MODIFIED;
+    if (f.isNewReturned())                                                  flag |= FEATURE_NEW_RETURNED;
+    if (f.isVariableCreatedAndReturnedWithNew())                            flag |= FEATURE_CREATED_WITH_NEW_AND_RETURNED;
+    if (f.isNonPrimitiveReturnType())                                       flag |= FEATURE_NON_PRIMITIVE_RETURN_TYPE;
+    addReturnType(flag, f, f.getUnitLanguage(), true);
+
+    flags.push_back(flag);
+    counts[COUNT_DATA_MEMBERS_MODIFIED].push_back(0);
+    counts[COUNT_METHOD_CALLS].push_back(f.getMethodCalls().size());
+    counts[COUNT_FUNCTION_CALLS].push_back(f.getFunctionCalls().size());
+    counts[COUNT_NEW_CONSTRUCTOR_CALLS].push_back(0);
+    counts[COUNT_EXTERNAL_FUNCTION_CALLS].push_back(0);
+    counts[COUNT_EXTERNAL_METHOD_CALLS].push_back(0);
+    counts[COUNT_NON_COMMENT_STATEMENTS].push_back(f.getNonCommentStatementsCount());
+}
+
+// Classifies the return type once
+// Pointers to void count as a non-void, non-bool return type for methods but not for free functions
+//
+void methodFeatures::addReturnType(std::uint32_t& f, const methodModel& m, const std::string& unitLanguage, bool isFreeFunction) {
+    const std::string& returnTypeParsed = m.getReturnTypeParsed();
+
+    // Covers the case of void with * or more
+    bool isVoidPointer = unitLanguage != "Java" && m.getReturnType().find("void*") != std::string::npos;
+
+    bool returnBool = false;
+    bool returnNotVoidOrBool = false;
+    if (unitLanguage == "C++") {
+        returnBool          = (returnTypeParsed == "bool");
+        returnNotVoidOrBool = (returnTypeParsed != "bool" && returnTypeParsed != "void" && returnTypeParsed != "");
+    }
+    else if (unitLanguage == "C#") {
+        returnBool          = (returnTypeParsed == "bool") || (returnTypeParsed == "Boolean");
+        returnNotVoidOrBool = (returnTypeParsed != "bool" && returnTypeParsed != "Boolean" &&
+                               returnTypeParsed != "void" && returnTypeParsed != "Void" && returnTypeParsed != "");
+    }
+    else if (unitLanguage == "Java") {
+        returnBool          = (returnTypeParsed == "boolean");
+        returnNotVoidOrBool = (returnTypeParsed != "boolean" && returnTypeParsed != "void" &&
+                               returnTypeParsed != "Void" && returnTypeParsed != "");
+    }
+    if (!isFreeFunction && isVoidPointer) returnNotVoidOrBool = true;
+
+    if (isVoidPointer)                                                      f |= FEATURE_VOID_POINTER;
+    if (returnBool)                                                         f |= FEATURE_RETURN_BOOL;
+    if (returnNotVoidOrBool)                                                f |= FEATURE_RETURN_NOT_VOID_OR_BOOL;
+    if (returnTypeParsed == "void")                                         f |= FEATURE_RETURN_VOID;
+    if (returnTypeParsed == "void" || returnTypeParsed == "Void")           f |= FEATURE_RETURN_VOID_ANY;
+}
+
+// Computes method stereotypes
+//
+void methodFeatures::classifyMethods(const stereotypeRules& rules, std::vector<std::uint32_t>& result) const {
+    rules.classify(RULE_METHOD, flags.data(), getColumns(), size(), result);
+}
+
+// Computes free function stereotypes
+//
+void methodFeatures::classifyFreeFunctions(const stereotypeRules& rules, std::vector<std::uint32_t>& result) const {
+    rules.classify(RULE_FUNCTION, flags.data(), getColumns(), size(), result);
+}
+
+std::vector<const int*> methodFeatures::getColumns() const {
+    std::vector<const int*> columns;
+    for (const auto& column : counts) columns.push_back(column.data());
+    return columns;
+}
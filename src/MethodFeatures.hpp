@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file MethodFeatures.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef METHODFEATURES_HPP
+#define METHODFEATURES_HPP
+
+#include "MethodModel.hpp"
+#include "StereotypeMask.hpp"
+#include "StereotypeRules.hpp"
+
+// Classification inputs packed as bits
+// The return type class is computed once per method instead of comparing strings in every rule
+//
+enum methodFeature : std::uint32_t {
+    FEATURE_CONSTRUCTOR_OR_DESTRUCTOR          = 1u << 0,
+    FEATURE_DESTRUCTOR                         = 1u << 1,
+    FEATURE_COPY_CONSTRUCTOR                   = 1u << 2,
+    FEATURE_MAIN                               = 1u << 3,
+    FEATURE_DATA_MEMBER_USED                   = 1u << 4,
+    FEATURE_PARAMETER_USED                     = 1u << 5,
+    FEATURE_METHOD_CONST                       = 1u << 6,
+    FEATURE_SIMPLE_RETURN                      = 1u << 7,
+    FEATURE_COMPLEX_RETURN                     = 1u << 8,
+    FEATURE_PARAMETER_COMPLEX_RETURN           = 1u << 9,
+    FEATURE_PARAMETER_REF_MODIFIED             = 1u << 10,
+    FEATURE_GLOBAL_OR_STATIC_MODIFIED          = 1u << 11,
+    FEATURE_NEW_RETURNED                       = 1u << 12,
+    FEATURE_CREATED_WITH_NEW_AND_RETURNED      = 1u << 13,
+    FEATURE_NON_PRIMITIVE_RETURN_TYPE          = 1u << 14,
+    FEATURE_NON_PRIMITIVE_LOCAL_OR_PARAMETER_MODIFIED = 1u << 15,
+    FEATURE_NON_PRIMITIVE_DATA_MEMBER_EXTERNAL = 1u << 16,
+    FEATURE_NON_PRIMITIVE_LOCAL_EXTERNAL       = 1u << 17,
+    FEATURE_NON_PRIMITIVE_PARAMETER_EXTERNAL   = 1u << 18,
+    FEATURE_NON_PRIMITIVE_RETURN_TYPE_EXTERNAL = 1u << 19,
+    FEATURE_RETURN_BOOL                        = 1u << 20,  // bool, Boolean (C#), or boolean (Java)
+    FEATURE_RETURN_NOT_VOID_OR_BOOL            = 1u << 21,  // Not void, Void, bool, or empty. Pointers to void count as not void for methods
+    FEATURE_RETURN_VOID                        = 1u << 22,  // Exactly void
+    FEATURE_RETURN_VOID_ANY                    = 1u << 23,  // void or Void
+    FEATURE_VOID_POINTER                       = 1u << 24   // void with one or more * (C++ and C#)
+};
+
+// Count columns of the feature table
+//
+enum methodCount {
+    COUNT_DATA_MEMBERS_MODIFIED,        // Number of modified data members
+    COUNT_METHOD_CALLS,                 // Number of method calls on data members (e.g., a.foo())
+    COUNT_FUNCTION_CALLS,               // Number of function calls to methods in class (e.g., foo())
+    COUNT_NEW_CONSTRUCTOR_CALLS,        // Number of constructor calls using 'new'
+    COUNT_EXTERNAL_FUNCTION_CALLS,      // Number of external function calls
+    COUNT_EXTERNAL_METHOD_CALLS,        // Number of external method calls
+    COUNT_NON_COMMENT_STATEMENTS,       // Number of non-comment statements
+    METHOD_COUNT_COLUMNS
+};
+
+// Classification inputs of all methods (or free functions) stored by column
+// Stereotypes are computed in a single pass over the columns by the compiled stereotype rules
+// Results are masks of methodStereotype bits in the same order the methods are added
+//
+class methodFeatures {
+public:
+    void                        addMethod               (const methodModel&, const std::string&, const std::string&);
+    void                        addFreeFunction         (const methodModel&);
+    void                        classifyMethods         (const stereotypeRules&, std::vector<std::uint32_t>&) const;
+    void                        classifyFreeFunctions   (const stereotypeRules&, std::vector<std::uint32_t>&) const;
+    std::size_t                 size                    () const                    { return flags.size();                         }
+
+private:
+    void                        addReturnType           (std::uint32_t&, const methodModel&, const std::string&, bool);
+    std::vector<const int*>     getColumns              () const;
+
+    std::vector<std::uint32_t>                                  flags;      // methodFeature bits
+    std::array<std::vector<int>, METHOD_COUNT_COLUMNS>          counts;     // Indexed by methodCount
+};
+
+#endif
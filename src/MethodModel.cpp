@@ -9,13 +9,11 @@
 
 #include "MethodModel.hpp"
 
-extern primitiveTypes    PRIMITIVES;
-extern ignorableCalls    IGNORED_CALLS;
-extern XPathBuilder      XPATH_TRANSFORMATION;
 
-methodModel::methodModel(srcml_archive* archive, srcml_unit* unit, const std::string& xpath, 
-                         const std::string& unitLang, const std::string& propertyReturnType, int unitNum) :
-                         unitLanguage(unitLang), xpath(xpath), unitNumber(unitNum) {
+methodModel::methodModel(srcml_archive* archive, srcml_unit* unit, int elementOrdinal, 
+                         const std::string& unitLang, const std::string& propertyReturnType, int unitNum, 
+                         const analysisSettings& analysis) :
+                         unitLanguage(unitLang), unitNumber(unitNum), ordinal(elementOrdinal), settings(&analysis) {
     srcML = srcml_unit_get_srcml(unit);
 
     callType = {"function", "method", "constructor"};
@@ -28,6 +26,8 @@ methodModel::methodModel(srcml_archive* archive, srcml_unit* unit, const std::st
 
     // We need to determine if a method is a constructor or a destructor before finding the other information
     findConstructorOrDestructor(archive, unit);
+    destructor = srcML.find("<destructor>") != std::string::npos;
+    if (constructorOrDestructor) tier = CONSTRUCTOR_DESTRUCTOR;
 
     // Name signature needed for inheritance analysis before calling findData()
     findName(archive, unit); 
@@ -35,6 +35,145 @@ methodModel::methodModel(srcml_archive* archive, srcml_unit* unit, const std::st
     findNameSignature();
 }
 
+// Restores a method from the facts recorded in the analysis cache (--cache), see writeFacts()
+// The method has no srcML unless it is given with setSrcML(). 'isCached()' is false if the record is not valid
+//
+methodModel::methodModel(const std::string& cachedFacts, int unitNum, const analysisSettings& analysis) : 
+                         unitNumber(unitNum), settings(&analysis), facts(cachedFacts) {
+    callType = {"function", "method", "constructor"};
+
+    cacheReader in(facts.c_str(), facts.size());
+    name             = in.readString();
+    nameSignature    = in.readString();
+    returnType       = in.readString();
+    returnTypeParsed = in.readString();
+    returnTypeFound  = in.readString();
+    parameterList    = in.readString();
+    unitLanguage     = in.readString();
+    classNameParsed  = in.readString();
+
+    in.readList([&]() { parametersOrdered.push_back(in.readVariable()); });
+    in.readList([&]() { localsOrdered.push_back(in.readVariable()); });
+    in.readList([&]() { variable v = in.readVariable(); parameters.insert({v.getName(), v}); });
+    in.readList([&]() { variable v = in.readVariable(); locals.insert({v.getName(), v}); });
+    in.readList([&]() { variablesCreatedWithNew.insert(in.readString()); });
+    for (std::vector<call>* calls : {&functionCalls, &methodCalls, &newConstructorCalls, &functionCallsFound, &methodCallsFound,
+                                     &newConstructorCallsFound})
+        in.readList([&]() { calls->push_back(in.readCall()); });
+    for (std::vector<std::string>* names : {&unresolvedCallSignatures, &expressionNames, &assignedNames, &returnExpressions})
+        in.readList([&]() { names->push_back(in.readString()); });
+
+    for (bool* flag : {&methodConst, &dataMemberUsed, &parameterUsed, &simpleReturn, &complexReturn, &parameterComplexReturn,
+                       &parameterRefModified, &nonPrimitiveLocalOrParameterModified, &globalOrStaticVariableModified,
+                       &nonPrimitiveDataMemberExternal, &nonPrimitiveReturnType, &nonPrimitiveReturnTypeExternal,
+                       &nonPrimitiveLocalExternal, &nonPrimitiveParamaterExternal, &newReturned, &constructorOrDestructor,
+                       &destructor, &extracted, &analyzed, &variableCreatedWithNewAndReturned})
+        *flag = in.readBool();
+
+    tier = static_cast<analysisTier>(in.readInt());
+    for (int* count : {&ordinal, &dataMembersModifiedCount, &externalFunctionCallsCount, &externalMethodCallsCount, 
+                       &nonCommentStatementsCount, &functionIndex})
+        *count = in.readInt();
+
+    shortcutName      = in.readString();
+    shortcutTaken     = in.readBool();
+    extractedForClass = in.readBool();
+
+    cached = in.isValid() && in.isAtEnd() && tier >= FULL && tier <= SIMPLE_RETURN;
+}
+
+// Writes the facts of the method as a cache record
+// Everything but the srcML and the stereotype is written, so the record is taken before the method is analyzed
+//  (see recordFacts()) and the analysis is repeated with the current data members and methods of the class
+//
+void methodModel::writeFacts(cacheWriter& out) const {
+    for (const std::string* text : {&name, &nameSignature, &returnType, &returnTypeParsed, &returnTypeFound, &parameterList, &unitLanguage,
+                                    &classNameParsed})
+        out.writeString(*text);
+
+    auto writeVariable = [&](const variable& v) { out.writeVariable(v); };
+    auto writeMapped   = [&](const std::pair<const std::string, variable>& pair) { out.writeVariable(pair.second); };
+    auto writeCall     = [&](const call& c) { out.writeCall(c); };
+    auto writeString   = [&](const std::string& text) { out.writeString(text); };
+    out.writeList(parametersOrdered, writeVariable);
+    out.writeList(localsOrdered, writeVariable);
+    out.writeList(parameters, writeMapped);
+    out.writeList(locals, writeMapped);
+    out.writeList(variablesCreatedWithNew, writeString);
+    for (const std::vector<call>* calls : {&functionCalls, &methodCalls, &newConstructorCalls, &functionCallsFound, &methodCallsFound,
+                                           &newConstructorCallsFound})
+        out.writeList(*calls, writeCall);
+    for (const std::vector<std::string>* names : {&unresolvedCallSignatures, &expressionNames, &assignedNames, &returnExpressions})
+        out.writeList(*names, writeString);
+
+    for (bool flag : {methodConst, dataMemberUsed, parameterUsed, simpleReturn, complexReturn, parameterComplexReturn,
+                      parameterRefModified, nonPrimitiveLocalOrParameterModified, globalOrStaticVariableModified,
+                      nonPrimitiveDataMemberExternal, nonPrimitiveReturnType, nonPrimitiveReturnTypeExternal,
+                      nonPrimitiveLocalExternal, nonPrimitiveParamaterExternal, newReturned, constructorOrDestructor,
+                      destructor, extracted, analyzed, variableCreatedWithNewAndReturned})
+        out.writeBool(flag);
+
+    out.writeInt(tier);
+    for (int count : {ordinal, dataMembersModifiedCount, externalFunctionCallsCount, externalMethodCallsCount, 
+                      nonCommentStatementsCount, functionIndex})
+        out.writeInt(count);
+
+    out.writeString(shortcutName);
+    out.writeBool(shortcutTaken);
+    out.writeBool(extractedForClass);
+}
+
+// Keeps the facts as a cache record once they are extracted (only with --cache)
+//
+void methodModel::recordFacts() {
+    if (settings->cacheFile == "") return;
+    cacheWriter out;
+    writeFacts(out);
+    facts = std::move(out.getBytes());
+}
+
+// Checks if facts read from the cache (or copied from a unit with the same content) are the same as extracting the method again 
+//  for a class with 'dataMembers' and 'classNamePar' (or for a free function if 'dataMembers' is null)
+//
+bool methodModel::isExtractionValid(const std::unordered_map<std::string, variable>* dataMembers, 
+                                          const std::string& classNamePar) const {
+    if (!extracted) return true;
+    if (extractedForClass != (dataMembers != nullptr)) return false;
+    if (dataMembers == nullptr) return true;
+    if (classNameParsed != classNamePar) return false;
+    return shortcutName == "" || (dataMembers->find(shortcutName) != dataMembers->end()) == shortcutTaken;
+}
+
+// Replaces facts read from the cache that do not hold anymore with the ones of the method srcML
+//
+void methodModel::discardCachedFacts() {
+    if (srcML.empty()) return;
+
+    srcml_archive* archive = srcml_archive_create();
+    srcml_archive_read_open_memory(archive, srcML.c_str(), srcML.size());
+    srcml_unit* unit = srcml_archive_read_unit(archive);
+
+    methodModel extractedAgain(archive, unit, ordinal, unitLanguage, "", unitNumber, *settings);
+    extractedAgain.functionIndex = functionIndex;
+    *this = extractedAgain;
+
+    srcml_unit_free(unit);
+    srcml_archive_close(archive);
+    srcml_archive_free(archive);
+}
+
+// Copy of the method for a unit with the same content (see classModelCollection::copyUnit())
+// The extracted facts are kept, and the analysis is repeated with the class of the copy
+//
+methodModel methodModel::copyForUnit(int unitNum) const {
+    methodModel copy = *this;
+    copy.unitNumber = unitNum;
+    copy.resolvedNames.clear();
+    copy.resolvedReturnNames.clear();
+    copy.analyzed = false;
+    return copy;
+}
+
 // Finds the name signature of the method
 //
 void methodModel::findNameSignature() {
@@ -49,44 +188,20 @@ void methodModel::findNameSignature() {
     trimWhitespace(nameSignature);
 }
 
+// Analyzes the method using the data members and method signatures known so far
+// Data is extracted from srcML only the first time, so the method can be analyzed as soon as its unit is read
+//  References that need inherited data members or methods are re-checked later by resolvePending()
+//
 void methodModel::findData(std::unordered_map<std::string, variable>& dataMembers, 
                           const std::unordered_set<std::string>& classMethods,
                           const std::string& classNamePar) {
     if (!constructorOrDestructor) {    
-        classNameParsed = classNamePar;
-    
-        srcml_archive* archive = srcml_archive_create();
-        srcml_archive_read_open_memory(archive, srcML.c_str(), srcML.size());
-        srcml_unit* unit = srcml_archive_read_unit(archive);
-
-        findReturnType(archive, unit); 
-        findParameterName(archive, unit);
-        findParameterType(archive, unit);
-    
-        findLocalVariableName(archive, unit);
-        findLocalVariableType(archive, unit); 
-        findReturnExpression(archive, unit);
-
-        findCallName(archive, unit);
-        findCallArgument(archive, unit);
-        findNewAssignedVariables(archive, unit);
-
-        findIgnorableCalls(methodCalls);
-        findIgnorableCalls(functionCalls);
-        findIgnorableCalls(newConstructorCalls);
-
-        // Must only be called after isIgnorableCall()
-        findCallsOnDataMembers(dataMembers, classMethods);
-
-        // Must only be called after findNewAssign()
-        findReturnedVariables(dataMembers, false); 
-        findVariablesInExpressions(archive, unit, dataMembers, false);
-        findModifiedVariables(archive, unit, dataMembers, false);
-        findNonCommentStatements(archive, unit);
-
-        srcml_unit_free(unit);
-        srcml_archive_close(archive);
-        srcml_archive_free(archive); 
+        if (cached && !isExtractionValid(&dataMembers, classNamePar)) discardCachedFacts();
+        if (!extracted) {
+            classNameParsed = classNamePar;
+            extractData(&dataMembers);
+        }
+        analyzeData(dataMembers, classMethods);
     }
 }
 
@@ -95,44 +210,229 @@ void methodModel::findData(std::unordered_map<std::string, variable>& dataMember
 //
 void methodModel::findFreeFunctionData() {
     if (!constructorOrDestructor) {
-        srcml_archive* archive = srcml_archive_create();
-        srcml_archive_read_open_memory(archive, srcML.c_str(), srcML.size());
-        srcml_unit* unit = srcml_archive_read_unit(archive);
+        resolvedNames.clear();
+        resolvedReturnNames.clear();
+        if (cached && !isExtractionValid(nullptr, "")) discardCachedFacts();
+
+        // Stereotype is decided by the name alone (only by the built-in rules)
+        if (settings->fastPaths && (name == "main" || name == "Main")) {
+            tier = MAIN;
+            extracted = true;
+            recordFacts();
+        }
+
+        if (!extracted) extractData(nullptr);
+        analyzeFreeFunction();
+    }
+}
+
+// Free functions are analyzed with their parameters in place of data members
+//
+void methodModel::analyzeFreeFunction() {
+    resetAnalysis();
+    findReturnedVariables(parameters, true); 
+    findVariablesInExpressions(parameters, true);
+    findModifiedVariables(parameters, true);
+}
+
+// Collects everything needed for the analysis from the method srcML
+// None of it depends on the data members or methods of the class, so it is only done once
+//
+// The cheapest checks that decide the stereotype are done first and the rest is skipped:
+//  Empty methods only need the number of non-comment statements (only with the built-in rules, see analysisSettings)
+//  Methods that only return a data member (e.g., return dm;) only need the return type and parameters
+//   since the returned name is the only expression in the method ('dataMembers' is null for free functions)
+//
+void methodModel::extractData(std::unordered_map<std::string, variable>* dataMembers) {
+    srcml_archive* archive = srcml_archive_create();
+    srcml_archive_read_open_memory(archive, srcML.c_str(), srcML.size());
+    srcml_unit* unit = srcml_archive_read_unit(archive);
+
+    findNonCommentStatements(archive, unit);
+    if (nonCommentStatementsCount == 0 && settings->fastPaths) 
+        tier = EMPTY;
+    else {
+        std::string returnedExpr = dataMembers ? findSimpleReturn(archive, unit) : "";
 
         findReturnType(archive, unit); 
         findParameterName(archive, unit);
         findParameterType(archive, unit);
-    
-        findLocalVariableName(archive, unit);
-        findLocalVariableType(archive, unit); 
-        findReturnExpression(archive, unit);
-
-        findCallName(archive, unit);
-        findCallArgument(archive, unit);
-        findNewAssignedVariables(archive, unit);
-
-        findIgnorableCalls(methodCalls);
-        findIgnorableCalls(functionCalls);
-        findIgnorableCalls(newConstructorCalls);
-
-        findReturnedVariables(parameters, true); 
-        findVariablesInExpressions(archive, unit, parameters, true);
-        findModifiedVariables(archive, unit, parameters, true);
-        findNonCommentStatements(archive, unit);
-
-        srcml_unit_free(unit);
-        srcml_archive_close(archive);
-        srcml_archive_free(archive); 
+
+        std::string returnedName = returnedExpr;
+        trimWhitespace(returnedName);
+        if (!returnedExpr.empty() && parameters.find(returnedName) == parameters.end()) {
+            shortcutName = returnedName;
+            shortcutTaken = dataMembers->find(returnedName) != dataMembers->end();
+        }
+        if (shortcutTaken) {
+            returnExpressions.push_back(returnedExpr);
+            expressionNames.push_back(returnedName);
+            if (matchSubstringAtBeginning(returnedExpr, "new")) 
+                newReturned = true; 
+            tier = SIMPLE_RETURN;
+        }
+        else {
+            findLocalVariableName(archive, unit);
+            findLocalVariableType(archive, unit); 
+            findReturnExpression(archive, unit);
+
+            findCallName(archive, unit);
+            findCallArgument(archive, unit);
+            findNewAssignedVariables(archive, unit);
+
+            findUniqueNames(archive, unit, "expression_name", expressionNames);
+            findUniqueNames(archive, unit, "expression_assignment", assignedNames);
+        }
     }
+
+    srcml_unit_free(unit);
+    srcml_archive_close(archive);
+    srcml_archive_free(archive); 
+
+    // Ignored calls are removed by the analysis, since a profile (-P) can ignore other calls
+    functionCallsFound = functionCalls;
+    methodCallsFound = methodCalls;
+    newConstructorCallsFound = newConstructorCalls;
+    extracted = true;
+    extractedForClass = dataMembers != nullptr;
+    recordFacts();
+
+    // Not needed anymore
+    releaseSrcML();
+}
+
+// Frees the method srcML. Also used by the skeleton pass (--two-phase), which only needs the name signature
+//
+void methodModel::releaseSrcML() {
+    srcML.clear();
+    srcML.shrink_to_fit();
+}
+
+// Determines which data members, parameters, locals, and methods are used
+// Can be repeated with more data members and methods (e.g., inherited ones) since everything it sets is reset first
+//
+void methodModel::analyzeData(std::unordered_map<std::string, variable>& dataMembers, 
+                              const std::unordered_set<std::string>& classMethods) {
+    resetAnalysis();
+
+    // Must only be called after isIgnorableCall()
+    findCallsOnDataMembers(dataMembers, classMethods);
+
+    // Must only be called after findNewAssign()
+    findReturnedVariables(dataMembers, false); 
+    findVariablesInExpressions(dataMembers, false);
+    findModifiedVariables(dataMembers, false);
+
+    analyzed = true;
+}
+
+// Resets everything the analysis sets, and keeps the calls that are not ignored
+//
+void methodModel::resetAnalysis() {
+    functionCalls                        = functionCallsFound;
+    methodCalls                          = methodCallsFound;
+    newConstructorCalls                  = newConstructorCallsFound;
+    findIgnorableCalls(methodCalls);
+    findIgnorableCalls(functionCalls);
+    findIgnorableCalls(newConstructorCalls);
+    unresolvedCallSignatures.clear();
+    externalFunctionCallsCount           = 0;
+    externalMethodCallsCount             = 0;
+    dataMembersModifiedCount             = 0;
+    dataMemberUsed                       = false;
+    parameterUsed                        = false;
+    simpleReturn                         = false;
+    complexReturn                        = false;
+    parameterRefModified                 = false;
+    nonPrimitiveLocalOrParameterModified = false;
+    globalOrStaticVariableModified       = false;
+    nonPrimitiveDataMemberExternal       = false;
+    variableCreatedWithNewAndReturned    = false;
+}
+
+// Analyzes a copy of the method again with the primitive types and ignored calls of a profile (-P)
+// The non-primitive facts of the extraction are found again from the types, so nothing is extracted again
+// 'dataMembers' and 'classMethods' are null for a free function (see classModelCollection::copyModelsForPass())
+//
+void methodModel::reanalyze(std::size_t profile, std::unordered_map<std::string, variable>* dataMembers,
+                            const std::unordered_set<std::string>* classMethods) {
+    if (constructorOrDestructor || !extracted) return;
+    tablesProfile = profile;
+    const primitiveTypes& primitives = settings->getPrimitives(tablesProfile);
+
+    variable v;
+    checkNonPrimitiveType(returnTypeFound, v, unitLanguage, classNameParsed, primitives);
+    nonPrimitiveReturnType = v.getNonPrimitive();
+    nonPrimitiveReturnTypeExternal = v.getNonPrimitiveExternal();
+
+    for (auto* variables : {&localsOrdered, &parametersOrdered}) {
+        bool external = false;
+        for (variable& var : *variables) {
+            var.setNonPrimitive(false);
+            var.setNonPrimitiveExternal(false);
+            checkNonPrimitiveType(var.getType(), var, unitLanguage, classNameParsed, primitives);
+            external = var.getNonPrimitiveExternal();
+        }
+        if (variables == &localsOrdered) nonPrimitiveLocalExternal = external;
+        else nonPrimitiveParamaterExternal = external;
+    }
+    for (auto* variables : {&locals, &parameters}) {
+        for (auto& pair : *variables) {
+            pair.second.setNonPrimitive(false);
+            pair.second.setNonPrimitiveExternal(false);
+            checkNonPrimitiveType(pair.second.getType(), pair.second, unitLanguage, classNameParsed, primitives);
+        }
+    }
+
+    if (dataMembers) 
+        analyzeData(*dataMembers, *classMethods);
+    else
+        analyzeFreeFunction();
+}
+
+// Re-checks the references that could not be resolved when the method was analyzed
+//  using the final data members and method signatures (including inherited ones)
+// The analysis is only repeated if one of them now resolves differently
+// Returns true if the analysis was repeated
+//
+bool methodModel::resolvePending(std::unordered_map<std::string, variable>& dataMembers, 
+                                 const std::unordered_set<std::string>& classMethods) {
+    if (!analyzed) return false;
+
+    bool changed = false;
+    for (const std::string& signature : unresolvedCallSignatures) {
+        if (classMethods.find(signature) != classMethods.end()) {
+            changed = true;
+            break;
+        }
+    }
+
+    for (int returnCheck = 0; returnCheck < 2; ++returnCheck) {
+        for (auto& pair : returnCheck ? resolvedReturnNames : resolvedNames) {
+            if (!pair.second.pending) continue;
+
+            resolvedName resolved;
+            resolveExpression(dataMembers, pair.first, returnCheck, resolved);
+            if (resolved.nameKind != pair.second.nameKind || resolved.name != pair.second.name) {
+                pair.second.nameKind = resolved.nameKind;
+                pair.second.name = resolved.name;
+                changed = true;
+            }
+            pair.second.pending = resolved.pending;
+        }
+    }
+
+    if (changed) analyzeData(dataMembers, classMethods);
+    return changed;
 }
 
 // Gets the method name
 //
 void methodModel::findName(srcml_archive* archive, srcml_unit* unit) {
     if (constructorOrDestructor)
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"constructor_destructor_name").c_str());
+        srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"constructor_destructor_name").c_str());
     else
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"name").c_str());
+        srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"name").c_str());
 
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
@@ -156,9 +456,9 @@ void methodModel::findName(srcml_archive* archive, srcml_unit* unit) {
 //
 void methodModel::findParameterList(srcml_archive* archive, srcml_unit* unit) {
     if (constructorOrDestructor)
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"constructor_destructor_parameter_list").c_str());
+        srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"constructor_destructor_parameter_list").c_str());
     else
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"method_parameter_list").c_str());
+        srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"method_parameter_list").c_str());
    
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
@@ -186,7 +486,7 @@ void methodModel::findParameterList(srcml_archive* archive, srcml_unit* unit) {
  //
 void methodModel::findReturnType(srcml_archive* archive, srcml_unit* unit) {
     if (returnType.empty()) { // If method was a property (C#), type is found in previous steps
-        srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"method_return_type").c_str());
+        srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"method_return_type").c_str());
         srcml_transform_result* result = nullptr;
         srcml_unit_apply_transforms(archive, unit, &result);
         int n = srcml_transform_get_unit_size(result);
@@ -199,8 +499,9 @@ void methodModel::findReturnType(srcml_archive* archive, srcml_unit* unit) {
         srcml_transform_free(result);
     }
 
+    returnTypeFound = returnType;
     variable v;
-    checkNonPrimitiveType(returnType, v, unitLanguage, classNameParsed);
+    checkNonPrimitiveType(returnType, v, unitLanguage, classNameParsed, settings->getPrimitives(tablesProfile));
     if (v.getNonPrimitive()) nonPrimitiveReturnType = true; 
     nonPrimitiveReturnTypeExternal = v.getNonPrimitiveExternal();
     
@@ -214,7 +515,7 @@ void methodModel::findReturnType(srcml_archive* archive, srcml_unit* unit) {
 // Collects the names of local variables
 //
 void methodModel::findLocalVariableName(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"local_variable_name").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"local_variable_name").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -244,7 +545,7 @@ void methodModel::findLocalVariableName(srcml_archive* archive, srcml_unit* unit
 // Collects the types of local variables
 //
 void methodModel::findLocalVariableType(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"local_variable_type").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"local_variable_type").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -267,7 +568,7 @@ void methodModel::findLocalVariableType(srcml_archive* archive, srcml_unit* unit
             prev = type;
         }  
         localsOrdered[i].setType(type);
-        checkNonPrimitiveType(type, localsOrdered[i], unitLanguage, classNameParsed);
+        checkNonPrimitiveType(type, localsOrdered[i], unitLanguage, classNameParsed, settings->getPrimitives(tablesProfile));
         locals.insert({localsOrdered[i].getName(), localsOrdered[i]});
         nonPrimitiveLocalExternal = localsOrdered[i].getNonPrimitiveExternal();
   
@@ -280,7 +581,7 @@ void methodModel::findLocalVariableType(srcml_archive* archive, srcml_unit* unit
 // Collects the names of parameters in each method
 //
 void methodModel::findParameterName(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"parameter_name").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"parameter_name").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -314,7 +615,7 @@ void methodModel::findParameterName(srcml_archive* archive, srcml_unit* unit) {
  // Therefore, the type is only collected if there is a name
  //
 void methodModel::findParameterType(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"parameter_type").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"parameter_type").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -329,7 +630,7 @@ void methodModel::findParameterType(srcml_archive* archive, srcml_unit* unit) {
         std::string type = unparsed;
     
         parametersOrdered[i].setType(type);
-        checkNonPrimitiveType(type, parametersOrdered[i], unitLanguage, classNameParsed);
+        checkNonPrimitiveType(type, parametersOrdered[i], unitLanguage, classNameParsed, settings->getPrimitives(tablesProfile));
         parameters.insert({parametersOrdered[i].getName(), parametersOrdered[i]});
         nonPrimitiveParamaterExternal = parametersOrdered[i].getNonPrimitiveExternal();
         free(unparsed);
@@ -343,7 +644,7 @@ void methodModel::findParameterType(srcml_archive* archive, srcml_unit* unit) {
 // Collects all return expressions
 //
 void methodModel::findReturnExpression(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"return_expression").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"return_expression").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -373,11 +674,11 @@ void methodModel::findReturnExpression(srcml_archive* archive, srcml_unit* unit)
 void methodModel::findCallName(srcml_archive* archive, srcml_unit* unit) {   
     for (const std::string& c : callType) {
         if (c == "function") 
-            srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"function_call_name").c_str());
+            srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"function_call_name").c_str());
         else if (c == "method") 
-            srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"method_call_name").c_str());
+            srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"method_call_name").c_str());
         else if (c == "constructor") 
-            srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"constructor_call_name").c_str());
+            srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"constructor_call_name").c_str());
 
         srcml_transform_result* result = nullptr;
         srcml_unit_apply_transforms(archive, unit, &result);
@@ -416,11 +717,11 @@ void methodModel::findCallName(srcml_archive* archive, srcml_unit* unit) {
 void methodModel::findCallArgument(srcml_archive* archive, srcml_unit* unit) {   
     for (const std::string& c : callType) {
         if (c == "function") 
-            srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"function_call_arglist").c_str());
+            srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"function_call_arglist").c_str());
         else if (c == "method") 
-            srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"method_call_arglist").c_str());
+            srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"method_call_arglist").c_str());
         else if (c == "constructor") 
-            srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"constructor_call_arglist").c_str());
+            srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"constructor_call_arglist").c_str());
         
         srcml_transform_result* result = nullptr;
         srcml_unit_apply_transforms(archive, unit, &result);
@@ -457,7 +758,7 @@ void methodModel::findCallArgument(srcml_archive* archive, srcml_unit* unit) {
 // Finds all variables that are declared or initialized with the 'new' operator
 //
 void methodModel::findNewAssignedVariables(srcml_archive* archive, srcml_unit* unit) {  
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"new_operator_assign").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"new_operator_assign").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -482,7 +783,7 @@ void methodModel::findNewAssignedVariables(srcml_archive* archive, srcml_unit* u
 // Determines if method is empty
 //
 void methodModel::findNonCommentStatements(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"non_comment_statements").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"non_comment_statements").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -492,10 +793,40 @@ void methodModel::findNonCommentStatements(srcml_archive* archive, srcml_unit* u
     srcml_transform_free(result);
 }
 
+// Finds the expression of a method whose only statement returns a single name (e.g., return dm;)
+// Returns an empty string if the method is not like that or the name is qualified (e.g., return a.b;)
+// 'this' is excluded since it is neither a simple nor a complex return
+//
+std::string methodModel::findSimpleReturn(srcml_archive* archive, srcml_unit* unit) {
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"simple_return").c_str());
+    srcml_transform_result* result = nullptr;
+    srcml_unit_apply_transforms(archive, unit, &result);
+    int n = srcml_transform_get_unit_size(result);
+
+    std::string expr;
+    if (n == 1) {
+        char* unparsed = nullptr;
+        std::size_t size = 0;
+        srcml_unit_unparse_memory(srcml_transform_get_unit(result, 0), &unparsed, &size);
+        expr = unparsed;
+        free(unparsed);
+
+        std::string returnedName = expr;
+        trimWhitespace(returnedName);
+        bool identifier = !returnedName.empty() && returnedName != "this" &&
+                          std::all_of(returnedName.begin(), returnedName.end(), [](unsigned char c) { return std::isalnum(c) || c == '_'; });
+        if (!identifier) expr.clear();
+    }
+    
+    srcml_clear_transforms(archive);
+    srcml_transform_free(result);
+    return expr;
+}
+
 // Determines if method is const (C++ only)
 //
 void methodModel::findConst(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"const").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"const").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -509,7 +840,7 @@ void methodModel::findConst(srcml_archive* archive, srcml_unit* unit) {
 // Check if method is a constructor or a destructor
 //
 void methodModel::findConstructorOrDestructor(srcml_archive* archive, srcml_unit* unit) {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"constructor_or_destructor").c_str());
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage,"constructor_or_destructor").c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
@@ -543,7 +874,7 @@ void methodModel::findModifiedRefParameter(std::string para, bool propertyCheck)
             parameterRefModified = true;   
         }
         else if (unitLanguage == "C#"){
-            bool nonPrimitive = !isPrimitiveType(type, unitLanguage);
+            bool nonPrimitive = !isPrimitiveType(type, unitLanguage, settings->getPrimitives(tablesProfile));
             bool referenceOut = type.find("out") != std::string::npos ||
                                 type.find("ref") != std::string::npos;
 
@@ -561,7 +892,7 @@ void methodModel::findModifiedRefParameter(std::string para, bool propertyCheck)
         }       
     }
     else if (unitLanguage == "Java"){
-        bool nonPrimitive = !isPrimitiveType(type, unitLanguage);
+        bool nonPrimitive = !isPrimitiveType(type, unitLanguage, settings->getPrimitives(tablesProfile));
         trimWhitespace(type);
         bool referenceArray = type.find("[]") != std::string::npos; 
         if (referenceArray || (nonPrimitive && propertyCheck))                
@@ -594,64 +925,60 @@ void methodModel::findReturnedVariables(std::unordered_map<std::string, variable
     }
 }
 
-// Determines if a data member or a parameter is used in an expression
+// Collects the unparsed results of an xpath with duplicates removed
+// Names are kept in the order of their last occurrence, so applying them in order
+//  leaves the method in the same state as applying every occurrence
 //
-void methodModel::findVariablesInExpressions(srcml_archive* archive, srcml_unit* unit, 
-                                             std::unordered_map<std::string, variable>& variables, bool isParameterCheck)  {
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"expression_name").c_str());
+void methodModel::findUniqueNames(srcml_archive* archive, srcml_unit* unit, const std::string& xpathName, std::vector<std::string>& names) {
+    srcml_append_transform_xpath(archive, settings->xpaths.getXpath(unitLanguage, xpathName).c_str());
     srcml_transform_result* result = nullptr;
     srcml_unit_apply_transforms(archive, unit, &result);
     int n = srcml_transform_get_unit_size(result);
-    srcml_unit* resultUnit = nullptr;
 
+    std::vector<std::string> occurrences;
+    occurrences.reserve(n);
+    srcml_unit* resultUnit = nullptr;
     for (int i = 0; i < n; i++) {
         resultUnit = srcml_transform_get_unit(result, i);
         char *unparsed = nullptr;
         std::size_t size = 0;
         srcml_unit_unparse_memory(resultUnit, &unparsed, &size);
-        isVariableUsed(variables, nullptr, unparsed, false, false, false, isParameterCheck, false);
-        
+        occurrences.emplace_back(unparsed);
         free(unparsed);  
     }        
     srcml_clear_transforms(archive);
     srcml_transform_free(result);    
+
+    std::unordered_set<std::string> seen;
+    for (auto it = occurrences.rbegin(); it != occurrences.rend(); ++it)
+        if (seen.insert(*it).second) names.push_back(*it);
+    std::reverse(names.begin(), names.end());
+}
+
+// Determines if a data member or a parameter is used in an expression
+// Each unique name is resolved once no matter how many times it appears
+//
+void methodModel::findVariablesInExpressions(std::unordered_map<std::string, variable>& variables, bool isParameterCheck)  {
+    for (const std::string& name : expressionNames) {
+        isVariableUsed(variables, nullptr, name, false, false, false, isParameterCheck, false);
+    }
 }
 
 // Finds if a data member, local, or a parameter (normal and passed by reference) is modified
 // Multiple modifications to the same data member or parameter are only considered as 1 modification
 //
-void methodModel::findModifiedVariables(srcml_archive* archive, srcml_unit* unit, 
-                                        std::unordered_map<std::string, variable>& variables, bool isParameterCheck) { 
+void methodModel::findModifiedVariables(std::unordered_map<std::string, variable>& variables, bool isParameterCheck) { 
     std::unordered_set<std::string> checked; 
 
-    srcml_append_transform_xpath(archive, XPATH_TRANSFORMATION.getXpath(unitLanguage,"expression_assignment").c_str());
-    srcml_transform_result* result = nullptr;
-    srcml_unit_apply_transforms(archive, unit, &result);
-    
-    int n = srcml_transform_get_unit_size(result);
-
-    srcml_unit* resultUnit = nullptr;
-    for (int j = 0; j < n; ++j) {
-        resultUnit = srcml_transform_get_unit(result, j);
-        char *unparsed = nullptr;
-        std::size_t size = 0;
-        srcml_unit_unparse_memory(resultUnit, &unparsed, &size);
-        std::string possibleVariable = unparsed;
-        free(unparsed);  
-
-        std::size_t oldSize = checked.size();
+    for (const std::string& possibleVariable : assignedNames) {
         if (isParameterCheck)
             isVariableUsed(variables, nullptr, possibleVariable, false, true, false, true, false);
-        else if (isVariableUsed(variables, &checked, possibleVariable, false, true, true, false, false)) {
-            if (checked.size() > oldSize) { // 'checked' will not increase in size unless you add a new unique data member to it 
-                ++dataMembersModifiedCount; // That way this only increase if a new data member is changed
-                oldSize = checked.size();
-            }         
-        }
+        else 
+            isVariableUsed(variables, &checked, possibleVariable, false, true, true, false, false);
     }
 
-    srcml_clear_transforms(archive);
-    srcml_transform_free(result);  
+    // 'checked' only holds unique data members, so each one is counted once
+    dataMembersModifiedCount = static_cast<int>(checked.size());
 }
 
 // Ignore calls from analysis
@@ -659,6 +986,7 @@ void methodModel::findModifiedVariables(srcml_archive* archive, srcml_unit* unit
 // However, usage of data members within these calls are not ignored (e.g., in arguments)
 //
 void methodModel::findIgnorableCalls(std::vector<call>& calls) {
+    const ignorableCalls& ignoredCalls = settings->getIgnoredCalls(tablesProfile);
     for (auto it = calls.begin(); it != calls.end();) {
         std::string callName = it->getName();
 
@@ -667,7 +995,7 @@ void methodModel::findIgnorableCalls(std::vector<call>& calls) {
             callName = callName.substr(0, listOpen);
             
         // Try to match the whole call
-        if (IGNORED_CALLS.isIgnored(callName, unitLanguage)) { 
+        if (ignoredCalls.isIgnored(callName, unitLanguage)) { 
             it = calls.erase(it);
         }
         else {
@@ -685,7 +1013,7 @@ void methodModel::findIgnorableCalls(std::vector<call>& calls) {
                 }
             }
  
-            if (IGNORED_CALLS.isIgnored(callName, unitLanguage)) 
+            if (ignoredCalls.isIgnored(callName, unitLanguage)) 
                 it = calls.erase(it);
             else ++it;                      
         }
@@ -713,6 +1041,7 @@ void methodModel::findCallsOnDataMembers(std::unordered_map<std::string, variabl
     // Check on function calls (Should be done before checking on method calls)
     for (auto it = functionCalls.begin(); it != functionCalls.end();) {  
         if (classMethods.find(it->getSignature()) == classMethods.end()) { 
+            unresolvedCallSignatures.push_back(it->getSignature());
             it = functionCalls.erase(it);
             ++externalFunctionCallsCount;
         }
@@ -752,18 +1081,91 @@ void methodModel::findCallsOnDataMembers(std::unordered_map<std::string, variabl
 }
 
 // Checks if an expression uses an data member, local, or a parameter 
+// The expression is resolved by resolveVariable() and the flags determine which effects are applied
+//
+bool methodModel::isVariableUsed(std::unordered_map<std::string, variable>& variables, 
+                                       std::unordered_set<std::string>* dataMembersModified, 
+                                       const std::string& expression, bool returnCheck, 
+                                       bool parameterModifiedCheck,  bool localModifiedCheck,
+                                       bool isParamaterCheck, bool isLocalCheck) {
+    const resolvedName& resolved = resolveVariable(variables, expression, returnCheck);
+    const std::string& possibleVar = resolved.name;
+
+    switch (resolved.nameKind) {
+        case resolvedName::INVALID:
+            return false;
+
+        case resolvedName::LOCAL:
+            if (localModifiedCheck && locals.at(possibleVar).getNonPrimitive()) 
+                nonPrimitiveLocalOrParameterModified = true;
+            if (returnCheck) { 
+                if (variablesCreatedWithNew.find(possibleVar) != variablesCreatedWithNew.end())
+                    if (!variableCreatedWithNewAndReturned) variableCreatedWithNewAndReturned = true;
+            }
+            return isLocalCheck;
+
+        case resolvedName::PARAMETER:
+            parameterUsed = true;
+            if (parameterModifiedCheck) {
+                if (parameters.at(possibleVar).getNonPrimitive()) nonPrimitiveLocalOrParameterModified = true;
+                findModifiedRefParameter(possibleVar, resolved.isMatched);
+            }
+            if (returnCheck) {        
+                if (variablesCreatedWithNew.find(possibleVar) != variablesCreatedWithNew.end())
+                    if (!variableCreatedWithNewAndReturned) variableCreatedWithNewAndReturned = true;
+            }
+            return isParamaterCheck;
+
+        case resolvedName::MEMBER:
+            if (dataMembersModified)
+                if (dataMembersModified->find(possibleVar) == dataMembersModified->end())
+                    dataMembersModified->insert(possibleVar);
+                
+            dataMemberUsed = true;
+            nonPrimitiveDataMemberExternal = variables.at(possibleVar).getNonPrimitiveExternal(); 
+            if (returnCheck) {    
+                if (variablesCreatedWithNew.find(possibleVar) != variablesCreatedWithNew.end())
+                    if (!variableCreatedWithNewAndReturned) variableCreatedWithNewAndReturned = true;
+            }            
+            return true;   
+
+        case resolvedName::NONE:
+            break;
+    }
+
+    // If you get here, then whatever is modified is definitely not a data member, local, or a parameter
+    //   so, it is safe to assume that it is a global or a static
+    if (parameterModifiedCheck) globalOrStaticVariableModified = true;
+
+    return false;  
+}
+
+// Resolves an expression to the data member, local, or a parameter it uses
 // Possible cases: 
 // C++: this->a; (*this).a; Foo::a; this->a.b; (*this).a.b; Foo::a.b; a.b; a
 // Java: super.a; this.a; Foo.a; super.a.b; this.a.b; Foo.a.b; a.b; a
 // C#: base.a; this.a; Foo.a; base.a.b; this.a.b; Foo.a.b; a.b; a
 // Where 'a' is a variable and Foo is class itself if the variable is an data member
 // Can match with complex uses of variables (e.g., this->a.b.c or a[]->b or (*a).b.c)
+//
+// Results are cached per method, so the same expression is only resolved once
+// The cache is cleared before analyzing a free function since 'variables' are then the parameters
 // 
-bool methodModel::isVariableUsed(std::unordered_map<std::string, variable>& variables, 
-                                       std::unordered_set<std::string>* dataMembersModified, 
-                                       const std::string& expression, bool returnCheck, 
-                                       bool parameterModifiedCheck,  bool localModifiedCheck,
-                                       bool isParamaterCheck, bool isLocalCheck) {
+resolvedName& methodModel::resolveVariable(std::unordered_map<std::string, variable>& variables, 
+                                           const std::string& expression, bool returnCheck) {
+    std::unordered_map<std::string, resolvedName>& cache = returnCheck ? resolvedReturnNames : resolvedNames;
+    auto cached = cache.find(expression);
+    if (cached != cache.end()) return cached->second;
+
+    resolvedName& resolved = cache[expression];
+    resolveExpression(variables, expression, returnCheck, resolved);
+    return resolved;
+}
+
+// Computes the resolution of an expression without using the cache
+//
+void methodModel::resolveExpression(std::unordered_map<std::string, variable>& variables, 
+                                    const std::string& expression, bool returnCheck, resolvedName& resolved) {
     std::string expr = expression; 
     trimWhitespace(expr);
                
@@ -799,36 +1201,33 @@ bool methodModel::isVariableUsed(std::unordered_map<std::string, variable>& vari
     if (unitLanguage != "Java") 
         removeLeadingAsterisks(expr);     
     
-    if (expr.empty()) return false;  
+    if (expr.empty()) return;  
 
     // ^ indicates that we should only match from the beginning
     // We only care about the first two variables. For example, in a.b.c() the a.b is sufficient to determine what "a" is
     // Each regex has only two capturing or matching groups
-    bool isMatched = false;
-    std::smatch match;
-    std::string pattern;
-    if (!returnCheck) {
-        if (unitLanguage == "C++") 
-            pattern = R"(^(?:\(\*this\)\.|this->|([^.->]*)(?:::|\.|->))([^.->]*))";
-        else if (unitLanguage == "Java")
-            pattern = R"(^(?:super|this|([^.]*))\.([^.]*))";
-        else if (unitLanguage == "C#")
-            pattern = R"(^(?:base|this|([^.->]*))(?:\.|->)([^.->]*))";
-    }
-    else {
-        // $ Used to match end of line. For example, return this.a; matches but return this.a.b; doesn't
-        if (unitLanguage == "C++") 
-            pattern = R"(^(?:\(\*this\)\.|this->|([^.->]*)(?:::|\.|->))([^.->\(\){}]*)$)";
-        else if (unitLanguage == "Java")
-            pattern = R"(^(?:super|this|([^.]*))\.([^.\(\)]*)$)";
-        else if (unitLanguage == "C#")
-            pattern = R"(^(?:base|this|([^.->]*))(?:\.|->)([^.->\(\)]*)$)";
-    }
+    // $ Used to match end of line for returns. For example, return this.a; matches but return this.a.b; doesn't
+    // Compiled once since building a regex costs more than matching it
+    static const std::regex cppPattern          (R"(^(?:\(\*this\)\.|this->|([^.->]*)(?:::|\.|->))([^.->]*))");
+    static const std::regex javaPattern         (R"(^(?:super|this|([^.]*))\.([^.]*))");
+    static const std::regex csharpPattern       (R"(^(?:base|this|([^.->]*))(?:\.|->)([^.->]*))");
+    static const std::regex cppReturnPattern    (R"(^(?:\(\*this\)\.|this->|([^.->]*)(?:::|\.|->))([^.->\(\){}]*)$)");
+    static const std::regex javaReturnPattern   (R"(^(?:super|this|([^.]*))\.([^.\(\)]*)$)");
+    static const std::regex csharpReturnPattern (R"(^(?:base|this|([^.->]*))(?:\.|->)([^.->\(\)]*)$)");
+
+    const std::regex* regexPattern = nullptr;
+    if (unitLanguage == "C++") 
+        regexPattern = returnCheck ? &cppReturnPattern : &cppPattern;
+    else if (unitLanguage == "Java")
+        regexPattern = returnCheck ? &javaReturnPattern : &javaPattern;
+    else 
+        regexPattern = returnCheck ? &csharpReturnPattern : &csharpPattern;
 
-    const std::regex regexPattern(pattern);
-    isMatched = std::regex_search(expr, match, regexPattern);
+    std::smatch match;
+    bool isMatched = std::regex_search(expr, match, *regexPattern);
     int count = isMatched ? 2 : 1;
     bool overShadow = true; // Needed in cases such as this.data = data where this.data is an data member and data is a local or a parameter 
+    resolved.isMatched = isMatched;
 
     // Regex uses the original 'expr' to extract the matches. Therefore, we should not modify the original 'expr'
     // 'possibleVar' is assigned 'expr' initially as it could be the variable itself especially for returns (e.g., return a;)
@@ -855,66 +1254,26 @@ bool methodModel::isVariableUsed(std::unordered_map<std::string, variable>& vari
                 possibleVar = match[2];
         }
 
+        resolved.name = possibleVar;
         if (overShadow) {
             // Checked first in case of overshadowing if variables = data members
             if (locals.find(possibleVar) != locals.end()) {
-                if (localModifiedCheck && locals.at(possibleVar).getNonPrimitive()) 
-                    nonPrimitiveLocalOrParameterModified = true;
-                if (returnCheck) { 
-                    if (variablesCreatedWithNew.find(possibleVar) != variablesCreatedWithNew.end())
-                        if (!variableCreatedWithNewAndReturned) variableCreatedWithNewAndReturned = true;
-                }
-                if (isLocalCheck) return true;
-                else return false;
+                resolved.nameKind = resolvedName::LOCAL;
+                return;
             }
-
             else if (parameters.find(possibleVar) != parameters.end()) {
-                parameterUsed = true;
-                if (parameterModifiedCheck) {
-                    if (parameters.at(possibleVar).getNonPrimitive()) nonPrimitiveLocalOrParameterModified = true;
-                    findModifiedRefParameter(possibleVar, isMatched);
-                }
-                if (returnCheck) {        
-                    if (variablesCreatedWithNew.find(possibleVar) != variablesCreatedWithNew.end())
-                        if (!variableCreatedWithNewAndReturned) variableCreatedWithNewAndReturned = true;
-                }
-                if (isParamaterCheck) return true;
-                else return false;      
+                resolved.nameKind = resolvedName::PARAMETER;
+                return;
             }
         }
         
         // You only ever get here if variables = data members
         if (variables.find(possibleVar) != variables.end()) {
-            if (dataMembersModified)
-                if (dataMembersModified->find(possibleVar) == dataMembersModified->end())
-                    dataMembersModified->insert(possibleVar);
-                
-            dataMemberUsed = true;
-            nonPrimitiveDataMemberExternal = variables.at(possibleVar).getNonPrimitiveExternal(); 
-            if (returnCheck) {    
-                if (variablesCreatedWithNew.find(possibleVar) != variablesCreatedWithNew.end())
-                    if (!variableCreatedWithNewAndReturned) variableCreatedWithNewAndReturned = true;
-            }            
-            return true;                                  
+            resolved.nameKind = resolvedName::MEMBER;
+            return;                                  
         }
+        resolved.pending = true; // Could still be an inherited data member
     }
 
-    // If you get here, then whatever is modified is definitely not a data member, local, or a parameter
-    //   so, it is safe to assume that it is a global or a static
-    if (parameterModifiedCheck) globalOrStaticVariableModified = true;
-
-    return false;  
-}
-
-
-std::string methodModel::getStereotype() const {
-    std::string result;
-
-    for (const std::string &value : stereotype)
-        result += value + " ";
-
-    if (result != "") 
-        Rtrim(result);
-
-    return result;
+    resolved.nameKind = resolvedName::NONE;
 }
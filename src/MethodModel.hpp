@@ -13,33 +13,53 @@
 #include <srcml.h>
 #include "utils.hpp"
 #include "variable.hpp"
-#include "XPathBuilder.hpp"
+#include "AnalysisSettings.hpp"
 #include "IgnorableCalls.hpp"
 #include "call.hpp"
+#include "StereotypeMask.hpp"
+#include "CacheRecord.hpp"
+
+// Outcome of resolving an expression to the variable it refers to
+// Resolution does not depend on how the expression is used, so it is computed once per unique expression 
+//  and the effects (used, modified, returned) are applied by each caller of isVariableUsed()
+//
+struct resolvedName {
+    enum kind { INVALID, NONE, LOCAL, PARAMETER, MEMBER };
+
+    kind              nameKind{INVALID};     // What the expression refers to
+    std::string       name;                  // Variable name (empty if INVALID)
+    bool              isMatched{false};      // Did the expression match the member access pattern? (e.g., a.b or this->a)
+    bool              pending{false};        // A data member lookup failed, so the result can change once inherited data members are known
+};
+
+// Analysis stages, cheapest first. A method stops at the first stage that decides its stereotype
+//
+enum analysisTier { FULL, CONSTRUCTOR_DESTRUCTOR, MAIN, EMPTY, SIMPLE_RETURN };
 
 class methodModel {
 public:
-    methodModel(srcml_archive*, srcml_unit*, const std::string&, const std::string&, const std::string&, int);
+    methodModel(srcml_archive*, srcml_unit*, int, const std::string&, const std::string&, int, const analysisSettings&);
+    methodModel(const std::string&, int, const analysisSettings&);
 
-    std::string                     getStereotype                          () const;
+    std::string                     getStereotype                          () const                { return stereotypeLabel(stereotype, METHOD_STEREOTYPE_LABELS); }
     const std::vector<variable>&    getParametersOrdered                   () const                { return parametersOrdered;                    }
     const std::vector<call>&        getFunctionCalls                       () const                { return functionCalls;                        }
     const std::vector<call>&        getMethodCalls                         () const                { return methodCalls;                          }
     const std::vector<call>&        getNewConstructorCalls                 () const                { return newConstructorCalls;                  }
-    const std::vector<std::string>& getStereotypeList                      () const                { return stereotype;                           }
     const std::string&              getName                                () const                { return name;                                 }
     const std::string&              getNameSignature                       () const                { return nameSignature;                        }
     const std::string&              getParameterList                       () const                { return parameterList;                        }
-    const std::string&              getSrcML                               () const                { return srcML;                                }
     const std::string&              getReturnType                          () const                { return returnType;                           }
     const std::string&              getReturnTypeParsed                    () const                { return returnTypeParsed;                     }
-    const std::string&              getXpath                               () const                { return xpath;                                }
     const std::string&              getUnitLanguage                        () const                { return unitLanguage;                         }
+    std::uint32_t                   getStereotypeMask                      () const                { return stereotype;                           }
     int                             getDataMembersModifiedCount            () const                { return dataMembersModifiedCount;             }
     int                             getUnitNumber                          () const                { return unitNumber;                           }
+    int                             getOrdinal                             () const                { return ordinal;                              }
     int                             getExternalFunctionCallsCount          () const                { return externalFunctionCallsCount;           }
     int                             getExternalMethodCallsCount            () const                { return externalMethodCallsCount;             }
     int                             getNonCommentStatementsCount           () const                { return nonCommentStatementsCount;            }
+    analysisTier                    getAnalysisTier                        () const                { return tier;                                 }
     bool                            isMethodConst                          () const                { return methodConst;                          }
     bool                            isDataMemberUsed                       () const                { return dataMemberUsed;                       }
     bool                            isParameterUsed                        () const                { return parameterUsed;                        }
@@ -55,13 +75,36 @@ public:
     bool                            isNonPrimitiveParamaterExternal        () const                { return nonPrimitiveParamaterExternal;        }
     bool                            isNonPrimitiveReturnType               () const                { return nonPrimitiveReturnType;               }
     bool                            isConstructorOrDestructor              () const                { return constructorOrDestructor;              }
+    bool                            isDestructor                           () const                { return destructor;                           }
+    bool                            isAnalyzed                             () const                { return analyzed;                             }
     bool                            isVariableCreatedAndReturnedWithNew    () const                { return variableCreatedWithNewAndReturned;    }
     bool                            isNonPrimitiveLocalOrParameterModified () const                { return nonPrimitiveLocalOrParameterModified; }
     bool                            isVariableUsed                         (std::unordered_map<std::string, variable>&, std::unordered_set<std::string>*, const std::string&, bool, bool, bool, bool, bool);
+    resolvedName&                   resolveVariable                        (std::unordered_map<std::string, variable>&, const std::string&, bool);
+    void                            resolveExpression                      (std::unordered_map<std::string, variable>&, const std::string&, bool, resolvedName&);
+    bool                            resolvePending                         (std::unordered_map<std::string, variable>&, const std::unordered_set<std::string>&);
+    bool                            isCached                               () const                { return cached;                               }
+    bool                            isExtractionValid                      (const std::unordered_map<std::string, variable>*, const std::string&) const;
+    const std::string&              getFacts                               () const                { return facts;                                }
+    std::string                     takeFacts                              ()                      { return std::move(facts);                     }
+    int                             getFunctionIndex                       () const                { return functionIndex;                        }
+    void                            setFunctionIndex                       (int index)             { functionIndex = index;                       }
+    void                            setSrcML                               (const std::string& s)  { srcML = s;                                   }
  
     void                     findNameSignature          ();
     void                     findFreeFunctionData       ();
+    void                     analyzeFreeFunction        ();
+    void                     reanalyze                  (std::size_t, std::unordered_map<std::string, variable>*, const std::unordered_set<std::string>*);
     void                     findData                   (std::unordered_map<std::string, variable>&, const std::unordered_set<std::string>&, const std::string&);
+    void                     extractData                (std::unordered_map<std::string, variable>*);
+    void                     releaseSrcML               ();
+    void                     writeFacts                 (cacheWriter&) const;
+    void                     recordFacts                ();
+    void                     discardCachedFacts         ();
+    methodModel              copyForUnit                (int) const;
+    std::string              findSimpleReturn           (srcml_archive*, srcml_unit*);
+    void                     analyzeData                (std::unordered_map<std::string, variable>&, const std::unordered_set<std::string>&);
+    void                     resetAnalysis              ();
     void                     findName                   (srcml_archive*, srcml_unit*);
     void                     findReturnType             (srcml_archive*, srcml_unit*);
     void                     findParameterList          (srcml_archive*, srcml_unit*);
@@ -78,11 +121,12 @@ public:
     void                     findIgnorableCalls         (std::vector<call>&);
     void                     findCallsOnDataMembers     (std::unordered_map<std::string, variable>&, const std::unordered_set<std::string>&);   
     void                     findReturnedVariables      (std::unordered_map<std::string, variable>&, bool);
-    void                     findModifiedVariables      (srcml_archive*, srcml_unit*, std::unordered_map<std::string, variable>&, bool);                             
-    void                     findVariablesInExpressions (srcml_archive*, srcml_unit*, std::unordered_map<std::string, variable>&, bool);
+    void                     findModifiedVariables      (std::unordered_map<std::string, variable>&, bool);                             
+    void                     findVariablesInExpressions (std::unordered_map<std::string, variable>&, bool);
     void                     findNonCommentStatements   (srcml_archive*, srcml_unit*);
+    void                     findUniqueNames            (srcml_archive*, srcml_unit*, const std::string&, std::vector<std::string>&);
     void                     findModifiedRefParameter   (std::string, bool);      
-    void                     setStereotype              (const std::string& s) { stereotype.push_back(s);}
+    void                     setStereotype              (std::uint32_t mask)   { stereotype = mask;     }
                                              
 private:
     std::vector<std::string>                          callType;
@@ -90,21 +134,29 @@ private:
     std::string                                       nameSignature;                              // Name without namespaces + parameters list (commas only). For example, foo(,,)
     std::string                                       returnType;                                 // Return type without whitespaces
     std::string                                       returnTypeParsed;                           // Return type without specifiers, containers, and whitespaces
+    std::string                                       returnTypeFound;                            // Return type as found (Needed to check it again in reanalyze())
     std::string                                       parameterList;                              // Parameter list
     std::string                                       unitLanguage;                               // Unit language
-    std::string                                       xpath;                                      // Unique xpath
-    std::string                                       srcML;                                      // Method srcML
+    std::string                                       srcML;                                      // Method srcML (released once the data is extracted)
     std::vector<variable>                             parametersOrdered;                          // List of all parameters (Needed in order to build the parameters map)
     std::vector<variable>                             localsOrdered;                              // List of all local (Needed in order to build the locals map)     
     std::unordered_map<std::string, variable>         parameters;                                 // Map of all parameters. Key is parameter name
     std::unordered_map<std::string, variable>         locals;                                     // Map of all locals. Key is local name         
     std::string                                       classNameParsed;                            // Class name without whitespaces, namespaces, and generic types <>
     std::unordered_set<std::string>                   variablesCreatedWithNew;                    // List of variables that are declared/initialized with the "new" operator
-    std::vector<std::string>                          stereotype;                                 // Method stereotype
+    std::uint32_t                                     stereotype{0};                              // Method stereotype(s) as a mask of methodStereotype bits
     std::vector<call>                                 functionCalls;                              // List of function calls (e.g., foo()) to methods in class
     std::vector<call>                                 methodCalls;                                // List of method calls (e.g., a.foo()) where 'a' is an data member
     std::vector<call>                                 newConstructorCalls;                        // List of constructor calls that uses the 'new' operator
+    std::vector<call>                                 functionCallsFound;                         // Function calls before filtering (Needed to repeat the analysis)
+    std::vector<call>                                 methodCallsFound;                           // Method calls before filtering (Needed to repeat the analysis)
+    std::vector<call>                                 newConstructorCallsFound;                   // Constructor calls before the ignored calls are removed
+    std::vector<std::string>                          unresolvedCallSignatures;                   // Signatures of function calls that are not to methods in class
+    std::vector<std::string>                          expressionNames;                            // Unique names used in expressions (in order of last occurrence)
+    std::vector<std::string>                          assignedNames;                              // Unique names that are assigned (in order of last occurrence)
     std::vector<std::string>                          returnExpressions;                          // List of all return expressions in a method
+    std::unordered_map<std::string, resolvedName>     resolvedNames;                              // Resolved expressions. Key is the unparsed expression
+    std::unordered_map<std::string, resolvedName>     resolvedReturnNames;                        // Resolved return expressions. Key is the unparsed expression
     bool                                              methodConst{false};                         // Is it a const method? (C++ only)
     bool                                              dataMemberUsed{false};                      // Does it use at least 1 data member in an expression? 
     bool                                              parameterUsed{false};                       // Does it use at least 1 parameter in an expression?
@@ -121,12 +173,29 @@ private:
     bool                                              nonPrimitiveParamaterExternal{false};       // True if method uses at least 1 a non-primitive parameter that is not of the same type as class                                                
     bool                                              newReturned{false};                         // There is at least one return that a return a "new" call
     bool                                              constructorOrDestructor{false};             // Method is a constructor or a destructor
+    bool                                              destructor{false};                          // Method is a destructor
+    bool                                              extracted{false};                           // Has the data been extracted from srcML yet?
+    bool                                              analyzed{false};                            // Has the method been analyzed against its class yet?
+    analysisTier                                      tier{FULL};                                 // Stage that decided the stereotype
     bool                                              variableCreatedWithNewAndReturned{false};   // There is at least 1 return expression that returns a data member, a local, a parameter, a static, or a global created with the 'new' operator 
     int                                               unitNumber{-1};                             // srcML Unit number   
+    int                                               ordinal{-1};                                // Element ordinal in the unit (see UnitElements.hpp)
     int                                               dataMembersModifiedCount{0};                // Number of modified data members
     int                                               externalFunctionCallsCount{0};              // Number of function calls that are filtered (removed)
     int                                               externalMethodCallsCount{0};                // Number of method calls that are filtered (removed)
     int                                               nonCommentStatementsCount{0};               // Number of non-comment statements 
+    const analysisSettings*                           settings{nullptr};                          // Settings of the analysis that found the method
+    std::size_t                                       tablesProfile{0};                           // Pass whose primitive types and ignored calls are used (see reanalyze())
+
+    // Analysis cache (--cache) and units with the same content
+    // The extraction only depends on the rest of the class through the class name and, for a simple return, 
+    //  whether the returned name is a data member, so these are kept to check if the facts of a cached or copied unit still hold
+    std::string                                       facts;                                      // Extracted facts as a cache record (empty if not recorded)
+    std::string                                       shortcutName;                               // Returned name checked against the data members by extractData() (empty if none)
+    bool                                              shortcutTaken{false};                       // Was 'shortcutName' a data member?
+    bool                                              extractedForClass{false};                   // Was it extracted as a method (and not as a free function)?
+    bool                                              cached{false};                              // Were the facts read from the cache?
+    int                                               functionIndex{-1};                          // Position among the free functions of the unit (-1 for methods found in a class)
 
 
 };
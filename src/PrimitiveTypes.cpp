@@ -14,7 +14,7 @@ extern std::vector<std::string> LANGUAGE;
 // Checks if 'type' is a primitive
 // User-defined primitives are checked for all languages
 //
-bool primitiveTypes::isPrimitive(const std::string& type, const std::string& unitLanguage) {
+bool primitiveTypes::isPrimitive(const std::string& type, const std::string& unitLanguage) const {
     return (ptypes.at(unitLanguage).find(type) != ptypes.at(unitLanguage).end() || 
            userTypes.find(type) != userTypes.end());
 }
@@ -57,8 +57,10 @@ void primitiveTypes::outputPrimitives() {
 // Specific primitives are used based on the language of the unit (i.e., source file)
 // Generic types (e.g., T), auto (C++), and var (C# and Java) 
 //  are considered as non-primitive unless added by user
+// The list is only created once (--serve analyzes many archives)
 //
 void primitiveTypes::createPrimitiveList() {
+    if (!ptypes.empty()) return;
     for (const auto& l : LANGUAGE) {
         if (l == "C++") {
             ptypes.insert({l, {
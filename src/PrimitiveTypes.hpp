@@ -19,11 +19,12 @@
 
 class primitiveTypes {
 public:
-    bool                 isPrimitive             (const std::string&, const std::string&);
+    bool                 isPrimitive             (const std::string&, const std::string&) const;
 
     void                 addPrimitive            (const std::string&);
     void                 createPrimitiveList     ();
     void                 outputPrimitives        ();
+    const std::unordered_set<std::string>& getUserPrimitives () const { return userTypes; }
 
     friend std::istream& operator>>              (std::istream&, primitiveTypes&);
 private:
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file ReportWriter.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "ReportWriter.hpp"
+
+reportWriter::reportWriter(const std::string& fileName) {
+    file = std::fopen(fileName.c_str(), "w");
+    if (file == nullptr) return;
+    chunk.reserve(CHUNK_SIZE);
+    writer = std::thread(&reportWriter::writeChunks, this);
+}
+
+reportWriter::~reportWriter() {
+    close();
+}
+
+reportWriter& reportWriter::operator<<(const std::string& text) {
+    append(text.data(), text.size());
+    return *this;
+}
+
+reportWriter& reportWriter::operator<<(const char* text) {
+    append(text, std::char_traits<char>::length(text));
+    return *this;
+}
+
+reportWriter& reportWriter::operator<<(char c) {
+    append(&c, 1);
+    return *this;
+}
+
+reportWriter& reportWriter::operator<<(int number) {
+    return *this << std::to_string(number);
+}
+
+// Text in double quotes (CSV field)
+//
+void reportWriter::writeQuoted(const std::string& text) {
+    *this << '"' << text << '"';
+}
+
+// Text left aligned in a column of the given width (i.e., std::left with std::setw)
+//
+void reportWriter::writePadded(const std::string& text, std::size_t width) {
+    *this << text;
+    if (file == nullptr || text.size() >= width) return;
+    chunk.append(width - text.size(), ' ');
+    if (chunk.size() >= CHUNK_SIZE) submitChunk();
+}
+
+// Queues the rest of the report and waits until it is written
+//
+void reportWriter::close() {
+    if (file == nullptr) return;
+    if (!chunk.empty()) submitChunk();
+    {
+        std::lock_guard<std::mutex> guard(mu);
+        closing = true;
+    }
+    chunkQueued.notify_one();
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void reportWriter::append(const char* text, std::size_t length) {
+    if (file == nullptr) return;
+    chunk.append(text, length);
+    if (chunk.size() >= CHUNK_SIZE) submitChunk();
+}
+
+// Queues the current chunk, waiting while too many are queued
+//
+void reportWriter::submitChunk() {
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        chunkWritten.wait(lock, [&]() { return chunks.size() < QUEUED_CHUNKS; });
+        chunks.push_back(std::move(chunk));
+    }
+    chunkQueued.notify_one();
+    chunk.clear();
+    chunk.reserve(CHUNK_SIZE);
+}
+
+void reportWriter::writeChunks() {
+    while (true) {
+        std::string text;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            chunkQueued.wait(lock, [&]() { return !chunks.empty() || closing; });
+            if (chunks.empty()) return;
+            text = std::move(chunks.front());
+            chunks.pop_front();
+        }
+        chunkWritten.notify_one();
+        std::fwrite(text.data(), 1, text.size(), file);
+    }
+}
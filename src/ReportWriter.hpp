@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file ReportWriter.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef REPORTWRITER_HPP
+#define REPORTWRITER_HPP
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+
+// Report file that is filled in large chunks and written by its own thread
+// Each report file has a writer, so the report formats are written in parallel while the
+//  collection is traversed once. At most two full chunks wait to be written, so memory
+//  is bounded by the chunk size and not by the number of classes
+// Nothing is written if the file cannot be created
+//
+class reportWriter {
+public:
+                        reportWriter            (const std::string&);
+                        ~reportWriter           ();
+
+    reportWriter&       operator<<              (const std::string&);
+    reportWriter&       operator<<              (const char*);
+    reportWriter&       operator<<              (char);
+    reportWriter&       operator<<              (int);
+    void                writeQuoted             (const std::string&);
+    void                writePadded             (const std::string&, std::size_t);
+    void                close                   ();
+
+private:
+    void                append                  (const char*, std::size_t);
+    void                submitChunk             ();
+    void                writeChunks             ();
+
+    static const std::size_t                    CHUNK_SIZE = 1024 * 1024;
+    static const std::size_t                    QUEUED_CHUNKS = 2;
+
+    std::FILE*                                  file{nullptr};
+    std::string                                 chunk;              // Text not yet queued
+    std::mutex                                  mu;
+    std::condition_variable                     chunkQueued, chunkWritten;
+    std::deque<std::string>                     chunks;             // Chunks not yet written, in order
+    std::thread                                 writer;
+    bool                                        closing{false};
+};
+
+#endif
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file Sha256.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <string>
+#include <array>
+#include <cstdint>
+
+// SHA-256 (FIPS 180-4) of bytes given in one or more parts
+// Units are matched by their digest (see analysisCache::hashUnit()), so two different units must not have the same one
+//
+class sha256 {
+public:
+    static const std::size_t    DIGEST_SIZE = 32;
+
+                                sha256              ();
+
+    void                        update              (const char*, std::size_t);
+    std::string                 digest              ();                         // DIGEST_SIZE bytes. Ends the hash
+
+private:
+    void                        transform           (const unsigned char*);
+
+    std::array<std::uint32_t, 8>                    state;
+    std::array<unsigned char, 64>                   block;
+    std::size_t                                     blockSize{0};
+    std::uint64_t                                   totalSize{0};
+};
+
+#endif
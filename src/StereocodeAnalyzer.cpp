@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereocodeAnalyzer.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "StereocodeAnalyzer.hpp"
+#include <fstream>
+
+// Tables of the analysis shared by the process. The user-defined entries are set by the options of the stereocode executable
+// The settings of each analysis are given to it (see analysisSettings)
+primitiveTypes                     PRIMITIVES;
+ignorableCalls                     IGNORED_CALLS;
+typeModifiers                      TYPE_MODIFIERS;
+std::vector<std::string>           LANGUAGE = {"C++", "C#", "Java"};   // Supported languages
+
+// The rules and xpaths of the analyzer are created once. The shared tables are created by the first analyzer
+//
+stereocodeAnalyzer::stereocodeAnalyzer(const analyzerSettings& analyzer) : settings(analyzer) {
+    analysis.freeFunction = settings.freeFunction;
+    analysis.structs      = settings.structs;
+    analysis.interfaces   = settings.interfaces;
+    analysis.unions       = settings.unions;
+    analysis.enums        = settings.enums;
+    analysis.memoryBudget = settings.memoryBudget;
+    if (settings.jobs != 0) analysis.jobs = settings.jobs;
+
+    analysis.rules.setLargeClassThreshold(settings.largeClass);
+    if (settings.rulesFile != "") {
+        std::ifstream in(settings.rulesFile);
+        if (in.is_open())
+            in >> analysis.rules;
+        else
+            error = "Stereotype rules file not found: " + settings.rulesFile;
+        in.close();
+
+        if (analysis.rules.getError() != "") error = "Invalid stereotype rules file: " + settings.rulesFile + ", " + analysis.rules.getError();
+    }
+    analysis.prepare();
+
+    static std::once_flag tablesCreated;
+    std::call_once(tablesCreated, []() {
+        PRIMITIVES.createPrimitiveList();
+        IGNORED_CALLS.createCallList();
+        TYPE_MODIFIERS.createModifierList();
+    });
+}
+
+// Analyzes a srcML archive or unit in memory (see the other analyze())
+// Units past the memory budget are read again from the buffer for output
+// Returns false if the buffer is not srcML
+//
+bool stereocodeAnalyzer::analyze(const char* srcML, std::size_t size, const analysisCallbacks& callbacks, srcml_archive* outputArchive) {
+    srcml_archive* archive = srcml_archive_create();
+    if (srcml_archive_read_open_memory(archive, srcML, size)) {
+        srcml_archive_free(archive);
+        if (outputArchive) {
+            srcml_archive_close(outputArchive);
+            srcml_archive_free(outputArchive);
+        }
+        return false;
+    }
+    return run(archive, callbacks, outputArchive, [srcML, size](srcml_archive* again) {
+        return srcml_archive_read_open_memory(again, srcML, size);
+    });
+}
+
+// Analyzes an archive opened for reading and hands the results to the callbacks
+// Both archives are closed and freed, as with classModelCollection
+// The archive cannot be read again, so units past the memory budget are spooled to a temporary file for output
+// Returns false if the settings are invalid or the analysis was stopped (see getError())
+// Profiles, report files, and the analysis cache are not used
+//
+bool stereocodeAnalyzer::analyze(srcml_archive* archive, const analysisCallbacks& callbacks, srcml_archive* outputArchive) {
+    return run(archive, callbacks, outputArchive, nullptr);
+}
+
+bool stereocodeAnalyzer::run(srcml_archive* archive, const analysisCallbacks& callbacks, srcml_archive* outputArchive,
+                             const std::function<int(srcml_archive*)>& reopenInput) {
+    if (error != "") {
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        if (outputArchive) {
+            srcml_archive_close(outputArchive);
+            srcml_archive_free(outputArchive);
+        }
+        return false;
+    }
+
+    classModelCollection classObj(analysis, archive, outputArchive, "-", false, false, false, settings.comment, "", nullptr, "", 
+                                  &callbacks, reopenInput);
+    analysisError = classObj.getError();
+    return analysisError == "";
+}
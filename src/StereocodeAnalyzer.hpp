@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereocodeAnalyzer.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef STEREOCODEANALYZER_HPP
+#define STEREOCODEANALYZER_HPP
+
+#include <string>
+#include <srcml.h>
+#include "ClassModelCollection.hpp"
+
+// Settings of one analyzer. They match the options of the same name of the stereocode executable
+//
+struct analyzerSettings {
+    bool                                            freeFunction{false};        // -f
+    bool                                            structs{false};             // -s
+    bool                                            interfaces{false};          // -i
+    bool                                            unions{false};              // -n
+    bool                                            enums{false};               // -m
+    bool                                            comment{false};             // -c
+    int                                             largeClass{21};             // -l
+    std::string                                     rulesFile;                  // -r (built-in rules if empty)
+    unsigned int                                    jobs{0};                    // -j (number of cores if 0)
+    std::size_t                                     memoryBudget{512};          // -b
+};
+
+// Entry point of libstereocode for programs that classify srcML in process
+// Input is a srcML buffer or an archive opened for reading by the caller (e.g., from its own I/O callbacks), and the
+//  results are handed to analysisCallbacks: the models of each class, method, and free function, and each unit with
+//  its stereotypes as a srcml_unit*. An output archive opened by the caller can be given instead of or with the callbacks
+// Each analyzer has its own settings, rules, and xpaths, which an analysis only reads, and each analysis has its own
+//  results. The tables of primitives, ignored calls, and type modifiers (including the user-defined ones) are created
+//  once and shared by the process
+// Analyzers can analyze at the same time from several threads. getError() is about the last analysis of an analyzer,
+//  so each analyzer is used by one thread at a time
+//
+class stereocodeAnalyzer {
+public:
+                         stereocodeAnalyzer             (const analyzerSettings& = analyzerSettings());
+
+    bool                 analyze                        (const char*, std::size_t, const analysisCallbacks&, srcml_archive* = nullptr);
+    bool                 analyze                        (srcml_archive*, const analysisCallbacks&, srcml_archive* = nullptr);
+
+    const std::string&   getError                       () const                    { return error != "" ? error : analysisError; }
+
+private:
+    bool                 run                            (srcml_archive*, const analysisCallbacks&, srcml_archive*, 
+                                                         const std::function<int(srcml_archive*)>&);
+
+    analyzerSettings                                settings;
+    analysisSettings                                analysis;                   // Settings of each analysis (see classModelCollection)
+    std::string                                     error;                      // Why the settings are invalid (empty if valid)
+    std::string                                     analysisError;              // Why the last analysis was stopped (empty if it was not)
+};
+
+#endif
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereotypeMask.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef STEREOTYPEMASK_HPP
+#define STEREOTYPEMASK_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+// Method and free function stereotypes as bit positions in a mask
+// Bits are listed in the order the labels are output (e.g., "get collaborator")
+//
+enum methodStereotype {
+    METHOD_GET, METHOD_PREDICATE, METHOD_PROPERTY, METHOD_VOID_ACCESSOR, METHOD_SET,
+    METHOD_GLOBAL_COMMAND, METHOD_COMMAND, METHOD_NON_VOID_COMMAND, METHOD_FACTORY, METHOD_LITERAL,
+    METHOD_WRAPPER, METHOD_CONTROLLER, METHOD_COLLABORATOR, METHOD_INCIDENTAL, METHOD_STATELESS,
+    METHOD_CONSTRUCTOR, METHOD_COPY_CONSTRUCTOR, METHOD_DESTRUCTOR, METHOD_MAIN, METHOD_EMPTY,
+    METHOD_UNCLASSIFIED, METHOD_STEREOTYPE_COUNT
+};
+
+inline const std::array<std::string, METHOD_STEREOTYPE_COUNT> METHOD_STEREOTYPE_LABELS = {
+    "get", "predicate", "property", "void-accessor", "set",
+    "global-command", "command", "non-void-command", "factory", "literal",
+    "wrapper", "controller", "collaborator", "incidental", "stateless",
+    "constructor", "copy-constructor", "destructor", "main", "empty",
+    "unclassified"
+};
+
+// Class stereotypes as bit positions in a mask
+// Bits are listed in the order the labels are output (e.g., "boundary small-class")
+//
+enum classStereotype {
+    CLASS_ENTITY, CLASS_MINIMAL_ENTITY, CLASS_DATA_PROVIDER, CLASS_COMMANDER, CLASS_BOUNDARY,
+    CLASS_FACTORY, CLASS_CONTROLLER, CLASS_PURE_CONTROLLER, CLASS_LARGE_CLASS, CLASS_LAZY_CLASS,
+    CLASS_DEGENERATE, CLASS_DATA_CLASS, CLASS_SMALL_CLASS, CLASS_EMPTY, CLASS_UNCLASSIFIED,
+    CLASS_STEREOTYPE_COUNT
+};
+
+inline const std::array<std::string, CLASS_STEREOTYPE_COUNT> CLASS_STEREOTYPE_LABELS = {
+    "entity", "minimal-entity", "data-provider", "commander", "boundary",
+    "factory", "controller", "pure-controller", "large-class", "lazy-class",
+    "degenerate", "data-class", "small-class", "empty", "unclassified"
+};
+
+// Joins the labels of the bits set in a mask with spaces
+//
+template <std::size_t N>
+std::string stereotypeLabel(std::uint32_t mask, const std::array<std::string, N>& labels) {
+    std::string result;
+    for (std::size_t bit = 0; bit < N; ++bit) {
+        if (!(mask & (std::uint32_t(1) << bit))) continue;
+        if (!result.empty()) result += ' ';
+        result += labels[bit];
+    }
+    return result;
+}
+
+// Adds one to the count of each bit set in a mask
+//
+template <std::size_t N>
+void countStereotypes(std::uint32_t mask, std::array<int, N>& counts) {
+    for (std::size_t bit = 0; bit < N; ++bit)
+        counts[bit] += (mask >> bit) & 1;
+}
+
+// Stereotype of a method, free function, or class kept as a mask until it is output
+// 'profiles' holds the stereotype found with each profile (--profile), in the order the profiles are given
+// A pass that does not classify the element (e.g., a profile without its kind of class) leaves it NOT_CLASSIFIED
+//
+struct stereotypeMask {
+    static constexpr std::uint32_t  NOT_CLASSIFIED = std::uint32_t(1) << 31;
+
+    std::uint32_t                   bits{NOT_CLASSIFIED};
+    bool                            isClass{false};
+    std::vector<std::uint32_t>      profiles;
+
+    std::string label() const { return label(bits); }
+
+    std::string label(std::uint32_t mask) const {
+        return isClass ? stereotypeLabel(mask, CLASS_STEREOTYPE_LABELS) : stereotypeLabel(mask, METHOD_STEREOTYPE_LABELS);
+    }
+};
+
+// Stereotypes of the elements of each unit written to the output archive. Key = unit number
+// Each value maps the element ordinal to its stereotype mask
+//
+using annotationList = std::unordered_map<int, std::map<int, stereotypeMask>>;
+
+#endif
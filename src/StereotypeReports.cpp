@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereotypeReports.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "StereotypeReports.hpp"
+
+// Number of methods in each category from the number of methods with each stereotype
+//
+std::array<int, CATEGORY_COUNT> stereotypeCategories(const std::array<int, METHOD_STEREOTYPE_COUNT>& methodStereotypes) {
+    std::array<int, CATEGORY_COUNT> categories{};
+
+    int getters = methodStereotypes[METHOD_GET];
+    categories[CATEGORY_ACCESSOR] = getters + methodStereotypes[METHOD_PREDICATE] +
+                                    methodStereotypes[METHOD_PROPERTY] +
+                                    methodStereotypes[METHOD_VOID_ACCESSOR];
+
+    int setters = methodStereotypes[METHOD_SET];
+    int commands = methodStereotypes[METHOD_COMMAND] + methodStereotypes[METHOD_NON_VOID_COMMAND];
+    categories[CATEGORY_MUTATOR] = setters + commands;
+
+    int controllers = methodStereotypes[METHOD_CONTROLLER];
+    int collaborator =  methodStereotypes[METHOD_COLLABORATOR] + methodStereotypes[METHOD_WRAPPER];
+    categories[CATEGORY_COLLABORATIONAL] = controllers + collaborator;
+
+    categories[CATEGORY_CREATIONAL] = methodStereotypes[METHOD_FACTORY] + methodStereotypes[METHOD_CONSTRUCTOR] + 
+                                      methodStereotypes[METHOD_COPY_CONSTRUCTOR] + methodStereotypes[METHOD_DESTRUCTOR];
+
+    categories[CATEGORY_DEGENERATE] = methodStereotypes[METHOD_INCIDENTAL] + methodStereotypes[METHOD_STATELESS] + methodStereotypes[METHOD_EMPTY];
+
+    categories[CATEGORY_UNCLASSIFIED] = methodStereotypes[METHOD_UNCLASSIFIED];
+    return categories;
+}
+
+// Optional TXT report file containing stereotype information
+// Format:
+//
+// Class Name:                  Class Stereotype:
+// ...                          ...
+// Method Name:                 Method Stereotype:
+// ...                          ...
+//---------------------------------------------------------------
+// Class Name:                  Class Stereotype:
+// ...                          ...
+// Method Name:                 Method Stereotype:
+// ...                          ...
+//
+// Optional CSV report file containing stereotype information
+// Format: "Class Name","Class Stereotype","Method Name","Method Stereotype"
+//
+// The free functions are written to their own TXT and CSV report files
+// 'fileNoExt' is the input file name without extension, followed by the profile name if any
+//
+stereotypeReports::stereotypeReports(const std::string& reportFileNoExt, bool outputTxtReport, bool outputCsvReport, bool outputVerbose) :
+                                     fileNoExt(reportFileNoExt), verbose(outputVerbose) {
+    if (outputTxtReport) {
+        txt     = std::make_unique<reportWriter>(fileNoExt + ".stereotypes.txt");
+        txtFree = std::make_unique<reportWriter>(fileNoExt + ".free_functions_stereotypes.txt");
+        txtFree->writePadded("Free Function Name:", WIDTH);
+        txtFree->writePadded("Free Function Stereotype:", WIDTH);
+        *txtFree << '\n';
+    }
+    if (outputCsvReport) {
+        csv     = std::make_unique<reportWriter>(fileNoExt + ".stereotypes.csv");
+        csvFree = std::make_unique<reportWriter>(fileNoExt + ".free_functions_stereotypes.csv");
+        *csv     << "Class Name,Class Stereotype,Method Name,Method Stereotype" << '\n';
+        *csvFree << "Free Function Name,Free Function Stereotype" << '\n';
+    }
+}
+
+stereotypeReports::~stereotypeReports() {
+    close();
+}
+
+void stereotypeReports::addClass(const std::string& name, std::uint32_t mask) {
+    const std::string stereotype = stereotypeLabel(mask, CLASS_STEREOTYPE_LABELS);
+    if (txt) {
+        txt->writePadded("Class Name:", WIDTH);
+        txt->writePadded("Class Stereotype:", WIDTH);
+        *txt << '\n';
+        txt->writePadded(name, WIDTH);
+        txt->writePadded(stereotype, WIDTH);
+        *txt << "\n\n";
+        txt->writePadded("Method Name:", WIDTH);
+        txt->writePadded("Method Stereotype:", WIDTH);
+        *txt << '\n';
+    }
+    if (csv) classFields = "\"" + name + "\",\"" + stereotype + "\",";
+    if (verbose) {
+        uniqueClassStereotypes[mask]++;
+        countStereotypes(mask, classStereotypes);
+    }
+}
+
+void stereotypeReports::addMethod(const std::string& name, std::uint32_t mask) {
+    const std::string stereotype = stereotypeLabel(mask, METHOD_STEREOTYPE_LABELS);
+    if (txt) {
+        txt->writePadded(name, WIDTH);
+        txt->writePadded(stereotype, WIDTH);
+        *txt << '\n';
+    }
+    if (csv) {
+        *csv << classFields;
+        csv->writeQuoted(name);
+        *csv << ',';
+        csv->writeQuoted(stereotype);
+        *csv << '\n';
+    }
+    if (verbose) {
+        uniqueMethodStereotypes[mask]++;
+        countStereotypes(mask, methodStereotypes);
+    }
+}
+
+void stereotypeReports::endClass() {
+    if (txt) *txt << std::string(WIDTH * 2, '-') << '\n';
+}
+
+void stereotypeReports::addFreeFunction(const std::string& name, std::uint32_t mask) {
+    const std::string stereotype = stereotypeLabel(mask, METHOD_STEREOTYPE_LABELS);
+    if (txtFree) {
+        txtFree->writePadded(name, WIDTH);
+        txtFree->writePadded(stereotype, WIDTH);
+        *txtFree << '\n';
+    }
+    if (csvFree) {
+        csvFree->writeQuoted(name);
+        *csvFree << ',';
+        csvFree->writeQuoted(stereotype);
+        *csvFree << '\n';
+    }
+}
+
+// Finishes the report files and writes the verbose report files
+//
+void stereotypeReports::close() {
+    if (closed) return;
+    closed = true;
+    if (txtFree) *txtFree << std::string(WIDTH * 2, '-') << '\n';
+    if (txt)     txt->close();
+    if (txtFree) txtFree->close();
+    if (csv)     csv->close();
+    if (csvFree) csvFree->close();
+    if (verbose) outputCsvVerboseReportFile();
+}
+
+// Generates other CSV report files containing stereotype information
+// This includes method_view (e.g., get set ... etc)
+// This includes class view (e.g., entity control ... etc)
+// This includes unique_method_view (e.g., 'get collaborator' ... etc)
+// This includes unique_class_view (e.g., 'entity control' ... etc)
+// This includes category_view (e.g., accessors, mutators ... etc)
+//
+void stereotypeReports::outputCsvVerboseReportFile() {
+    reportWriter outU(fileNoExt + ".unique_method_view.csv");
+    reportWriter outV(fileNoExt + ".unique_class_view.csv");
+    reportWriter outM(fileNoExt + ".method_view.csv");
+    reportWriter outS(fileNoExt + ".class_view.csv");
+    reportWriter outC(fileNoExt + ".category_view.csv");
+
+    // Needed to print method stereotypes in this order. Class stereotypes are printed in bit order
+    const std::vector<methodStereotype> method_ordered_keys = {
+        METHOD_GET, METHOD_PREDICATE, METHOD_PROPERTY, METHOD_VOID_ACCESSOR, METHOD_SET, METHOD_COMMAND, METHOD_NON_VOID_COMMAND,
+        METHOD_COLLABORATOR, METHOD_CONTROLLER, METHOD_WRAPPER, METHOD_CONSTRUCTOR, METHOD_COPY_CONSTRUCTOR, METHOD_DESTRUCTOR, METHOD_FACTORY,
+        METHOD_INCIDENTAL, METHOD_STATELESS, METHOD_EMPTY, METHOD_UNCLASSIFIED
+    };
+
+    int total = 0;
+    // Unique Method View
+    outU << "Unique Method Stereotype,Method Count" << '\n';
+    for (auto& pair : uniqueMethodStereotypes) {
+        outU << stereotypeLabel(pair.first, METHOD_STEREOTYPE_LABELS) << ",";
+        outU << pair.second << '\n';
+        total += pair.second;
+    }
+    outU << "Total" << "," << total;
+
+    // Unique Class View
+    outV << "Unique Class Stereotype,Class Count" << '\n';
+    total = 0;
+    for (auto& pair : uniqueClassStereotypes) {
+        outV << stereotypeLabel(pair.first, CLASS_STEREOTYPE_LABELS) << ",";
+        outV << pair.second << '\n';
+        total += pair.second;
+    }
+    outV << "Total" << "," << total;
+
+    // Method View
+    //
+    outM << "Method Stereotype,Stereotype Count" << '\n';
+    total = 0;
+    for (const auto& key : method_ordered_keys) {
+        outM << METHOD_STEREOTYPE_LABELS[key] << ",";
+        outM << methodStereotypes[key] << '\n';
+        total += methodStereotypes[key];
+    }
+    outM << "Total" << "," << total;
+
+    // Class View
+    //
+    outS << "Class Stereotype,Class Count" << '\n';
+    total = 0;
+    for (int key = 0; key < CLASS_STEREOTYPE_COUNT; ++key) {
+        outS << CLASS_STEREOTYPE_LABELS[key] << ",";
+        outS << classStereotypes[key] << '\n';
+        total += classStereotypes[key];
+    }
+    outS << "Total" << "," << total;
+
+    // Category view
+    std::array<int, CATEGORY_COUNT> categories = stereotypeCategories(methodStereotypes);
+    total = 0;
+    outC << "Stereotype Category,Stereotype Count" << '\n';
+    for (int category = 0; category < CATEGORY_COUNT; ++category) {
+        outC << CATEGORY_LABELS[category] << "," << categories[category] << '\n';
+        total += categories[category];
+    }
+    outC << "Total" << "," << total;
+}
+
+stereotypeRollup::stereotypeRollup(const std::vector<std::string>& unitFilenames, const std::vector<std::string>& unitNamespaces) :
+                                   filenames(unitFilenames), namespaces(unitNamespaces), units(unitFilenames.size()) {}
+
+void stereotypeRollup::rollupCounts::add(const rollupCounts& other) {
+    classes += other.classes;
+    methods += other.methods;
+    for (std::size_t i = 0; i < stereotypes.size(); ++i) stereotypes[i] += other.stereotypes[i];
+}
+
+void stereotypeRollup::addClass(int unitNumber) {
+    if (unitNumber >= 1 && static_cast<std::size_t>(unitNumber) <= units.size()) ++units[unitNumber - 1].classes;
+}
+
+void stereotypeRollup::addMethod(int unitNumber, std::uint32_t mask) {
+    if (unitNumber < 1 || static_cast<std::size_t>(unitNumber) > units.size()) return;
+    rollupCounts& counts = units[unitNumber - 1];
+    ++counts.methods;
+    countStereotypes(mask, counts.stereotypes);
+}
+
+// Rollup report file
+// Format: Scope,Name,Classes,Methods,Accessors,...,Unclassified
+// The scopes are the whole archive (all), each directory and its parent directories, each file, and each
+//  package or namespace and its enclosing ones (separated by . or ::)
+//
+void stereotypeRollup::write(const std::string& fileName) const {
+    rollupCounts all;
+    std::map<std::string, rollupCounts> directories, files, packages;
+    for (std::size_t unit = 0; unit < units.size(); ++unit) {
+        const rollupCounts& counts = units[unit];
+        if (counts.classes == 0 && counts.methods == 0) continue;
+        all.add(counts);
+
+        const std::string& filename = filenames[unit];
+        files[filename].add(counts);
+        for (std::size_t slash = filename.find_first_of("/\\"); slash != std::string::npos; slash = filename.find_first_of("/\\", slash + 1))
+            directories[filename.substr(0, slash + 1)].add(counts);
+
+        const std::string& package = unit < namespaces.size() ? namespaces[unit] : "";
+        if (package == "") continue;
+        packages[package].add(counts);
+        for (std::size_t i = 0; i < package.size(); ++i)
+            if (package[i] == '.' || (package[i] == ':' && i + 1 < package.size() && package[i + 1] == ':'))
+                packages[package.substr(0, i)].add(counts);
+    }
+
+    reportWriter out(fileName);
+    out << "Scope,Name,Classes,Methods";
+    for (const auto& label : CATEGORY_LABELS) out << ',' << label;
+    out << '\n';
+
+    auto writeRow = [&](const char* scope, const std::string& name, const rollupCounts& counts) {
+        out << scope << ',';
+        out.writeQuoted(name);
+        out << ',' << counts.classes << ',' << counts.methods;
+        for (int category : stereotypeCategories(counts.stereotypes)) out << ',' << category;
+        out << '\n';
+    };
+    writeRow("all", "", all);
+    for (const auto& pair : directories) writeRow("directory", pair.first, pair.second);
+    for (const auto& pair : files)       writeRow("file", pair.first, pair.second);
+    for (const auto& pair : packages)    writeRow("namespace", pair.first, pair.second);
+}
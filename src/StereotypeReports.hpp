@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereotypeReports.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef STEREOTYPEREPORTS_HPP
+#define STEREOTYPEREPORTS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <memory>
+#include <cstdint>
+#include "StereotypeMask.hpp"
+#include "ReportWriter.hpp"
+
+// Categories of method stereotypes in the category view and the rollup report
+// A method is counted in the category of each of its stereotypes
+//
+enum stereotypeCategory {
+    CATEGORY_ACCESSOR, CATEGORY_MUTATOR, CATEGORY_CREATIONAL, CATEGORY_COLLABORATIONAL, CATEGORY_DEGENERATE, CATEGORY_UNCLASSIFIED,
+    CATEGORY_COUNT
+};
+
+inline const std::array<std::string, CATEGORY_COUNT> CATEGORY_LABELS = {
+    "Accessors", "Mutators", "Creational", "Collaborational", "Degenerate", "Unclassified"
+};
+
+std::array<int, CATEGORY_COUNT> stereotypeCategories(const std::array<int, METHOD_STEREOTYPE_COUNT>&);
+
+// Report files of one set of stereotypes (-x, -z, -v)
+// The rows are fed in one traversal (a class, its methods, the next class, ..., and then the free functions)
+//  and each row is written to every requested format. Each report file is written by its own writer,
+//  so the formats are written in parallel. The counts of the verbose report files are collected
+//  while the rows are fed and are written on close
+// Used by the analysis and by the query subcommand, which reads the rows from a fact store
+//
+class stereotypeReports {
+public:
+                         stereotypeReports              (const std::string&, bool, bool, bool);
+                         ~stereotypeReports             ();
+
+    void                 addClass                       (const std::string&, std::uint32_t);
+    void                 addMethod                      (const std::string&, std::uint32_t);
+    void                 endClass                       ();
+    void                 addFreeFunction                (const std::string&, std::uint32_t);
+    void                 close                          ();
+
+private:
+    void                 outputCsvVerboseReportFile     ();
+
+    static const std::size_t                        WIDTH = 70;         // Width of a column of the TXT report
+
+    std::string                                     fileNoExt;
+    bool                                            verbose{false};
+    bool                                            closed{false};
+    std::unique_ptr<reportWriter>                   txt, txtFree, csv, csvFree;
+    std::string                                     classFields;        // Quoted class name and stereotype of the CSV rows
+    std::map<std::uint32_t, int>                    uniqueMethodStereotypes;    // Key is stereotype mask
+    std::map<std::uint32_t, int>                    uniqueClassStereotypes;     // Key is stereotype mask
+    std::array<int, CLASS_STEREOTYPE_COUNT>         classStereotypes{};
+    std::array<int, METHOD_STEREOTYPE_COUNT>        methodStereotypes{};
+};
+
+// Stereotype distribution of each directory, file, and package or namespace (--rollup)
+// Counts are added to the unit of each class and method as the rows are fed, and only the per-unit counts
+//  are folded into the directories and namespaces of the units when the report is written
+// Methods include the free functions. A class is counted in its first unit
+//
+class stereotypeRollup {
+public:
+                         stereotypeRollup               (const std::vector<std::string>&, const std::vector<std::string>&);
+
+    void                 addClass                       (int);
+    void                 addMethod                      (int, std::uint32_t);
+    void                 write                          (const std::string&) const;
+
+private:
+    struct rollupCounts {
+        int                                         classes{0};
+        int                                         methods{0};
+        std::array<int, METHOD_STEREOTYPE_COUNT>    stereotypes{};
+
+        void add(const rollupCounts&);
+    };
+
+    const std::vector<std::string>&                 filenames;          // File name of each unit (unit number - 1)
+    const std::vector<std::string>&                 namespaces;         // Package or namespace of each unit
+    std::vector<rollupCounts>                       units;              // Counts of each unit (unit number - 1)
+};
+
+#endif
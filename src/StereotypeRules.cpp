@@ -0,0 +1,949 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereotypeRules.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include "StereotypeRules.hpp"
+#include "MethodFeatures.hpp"
+
+// Built-in rules
+// A rules file (-r) uses the same format
+//
+static const std::string DEFAULT_RULES = R"(
+# Each line is a rule or a definition:
+#   <scope> <stereotype> : <condition>
+#   <scope> let <name> = <condition or count>
+# <scope> is method, function (free functions), or class
+#
+# Conditions combine facts with ! (not), & (and), | (or), and parentheses
+# Counts are combined with + and - (e.g., 2 * set + get) and compared with <, <=, >, >=, ==, or !=
+# A stereotype in a condition is true if an earlier rule of the same scope assigned it
+# 'none' is true if no earlier rule assigned a stereotype
+# Names may contain '-', so a minus between two names needs spaces around it
+# A line that starts with whitespace continues the previous line
+#
+# Rules are evaluated in order, but stereotypes are always output in the same order
+
+
+# constructor copy-constructor destructor
+#
+method destructor       : isConstructorOrDestructor & isDestructor
+method copy-constructor : isConstructorOrDestructor & !isDestructor & isCopyConstructor
+method constructor      : isConstructorOrDestructor & !isDestructor & !isCopyConstructor
+
+# empty
+#
+# 1] Method has no statements except for comments
+#
+method empty            : !isConstructorOrDestructor & nonCommentStatementsCount == 0
+
+method let normal       = !isConstructorOrDestructor & nonCommentStatementsCount != 0
+method let usesClass    = isDataMemberUsed | functionCallsCount > 0
+
+# get
+#
+# 1] Return type is not void
+# 2] Contains at least one simple return expression that
+#     returns a data member (e.g., return dm;) or the value to a data member (e.g., return *dm; or return **dm; ... etc)
+#    The data member 'dm' can be of any data type (e.g., primitive, non-primitive, pointer, reference, etc)
+#
+# Returning "this" by itself is not a getter (e.g., return this;)
+#  as it points to the current object rather than a data member
+#
+method get              : normal & hasSimpleReturn
+
+# predicate
+#
+# 1] Return type is Boolean
+# 2] Contains at least one complex return expression
+# 3] Uses a data member in an expression or has at least
+#     one function call (except constructor calls) to other methods in class
+#
+# Returning "this" by itself is not a predicate (e.g., return this;)
+#  as it points to the current object rather than a bool value found using data members
+#
+method predicate        : normal & isBoolReturnType & hasComplexReturn & usesClass
+
+# property
+#
+# 1] Return type is not void or Boolean
+# 2] Contains at least one complex return statement (e.g., return a+5;)
+# 3] Uses a data member in an expression or has at least
+#     one function call (except constructor calls) to other methods in class
+#
+# Returning "this" by itself is not a property (e.g., return this;)
+#  as it points to the current object rather than a non-bool value found using data members
+#
+method property         : normal & isNonVoidOrBoolReturnType & hasComplexReturn & usesClass
+
+# void-accessor
+#
+# 1] Return type is void
+# 2] Contains at least one parameter that is passed by non-const reference and is assigned a value
+# 3] Uses a data member in an expression or has at least
+#     one function call (except constructor calls) to other methods in class
+#
+# The "this" keyword by itself is considered (e.g., p = this or p = *this)
+#  as an accessor to the state of the object where 'p' is passed by reference
+#
+method void-accessor    : normal & isParameterRefModified & isVoidReturnType & !isVoidPointer & usesClass
+
+# set
+#
+# 1] Only one data member is changed or there is a single call on a data member
+# 2] No calls to methods in class
+#
+# The "this" keyword by itself is considered (e.g., this["index"] = value; for indexers in C#)
+#
+method set              : normal & functionCallsCount == 0 &
+                          (dataMembersModifiedCount == 1 & methodCallsCount == 0 | dataMembersModifiedCount == 0 & methodCallsCount == 1)
+
+# command
+#
+# Method has a void return type
+# Method is not const or const but has mutable data members (C++ only)
+# Cases:
+#   Case 1: More than one data member is modifed
+#
+#   Case 2: one data member is modifed and
+#            there is at least one call on a data member or
+#            at least one function call to other methods (except constructor calls) in class
+#   Case 3: zero data members are modifed and
+#            there is at least two calls on data member or
+#            at least one function call to other methods (except constructor calls) in class
+#
+# The "this" keyword by itself is considered (e.g., this["index"] = value; for indexers in C#)
+#
+# non-void-command
+#   Method return type is not void
+#
+method let isCommand    = normal &
+                          (dataMembersModifiedCount > 1 |
+                           dataMembersModifiedCount == 1 & functionCallsCount + methodCallsCount > 0 |
+                           dataMembersModifiedCount == 0 & (methodCallsCount > 1 | functionCallsCount > 0)) &
+                          (!isMethodConst | dataMembersModifiedCount > 1)
+method let isNonVoid    = !isAnyVoidReturnType & !isVoidPointer
+method non-void-command : isCommand & isNonVoid
+method command          : isCommand & !isNonVoid
+
+# factory
+#
+# 1] Factories must include a non-primitive type in their return type
+#      and their return expression must be a local variable, parameter, or data member, that
+#      call a constructor call or has a return expression with a constructor call (e.g., new)
+#
+method factory          : normal & isNonPrimitiveReturnType & (isNewReturned | isVariableCreatedAndReturnedWithNew)
+
+# wrapper
+#
+# 1] No data members are modified
+# 2] No calls to methods in class
+# 3] No calls on data members
+# 4] Has at least one free function call
+# Constructor calls using the 'new' operator are not considered
+#
+# controller
+#
+# 1] No data members are modified
+# 2] No calls to methods in class
+# 3] No calls on data members
+# 3] Has at least one call to other class methods or mutates a parameter or a local that is non-primitive
+#
+# collaborator
+#
+# 1] It must use at least 1 non-primitive type (not of this class)
+# 2] Type could be a parameter, local variable, return type, or an data member
+#
+method let noClassUse   = dataMembersModifiedCount == 0 & functionCallsCount == 0 & methodCallsCount == 0
+method wrapper          : normal & noClassUse & externalMethodCallsCount == 0 & externalFunctionCallsCount > 0
+method controller       : normal & !wrapper & noClassUse & (externalMethodCallsCount > 0 | isNonPrimitiveLocalOrParameterModified)
+method collaborator     : normal & !wrapper & !controller &
+                          (isNonPrimitiveDataMemberExternal | isNonPrimitiveLocalExternal | isNonPrimitiveParameterExternal |
+                           isNonPrimitiveReturnTypeExternal | isVoidPointer)
+
+# incidental
+#
+# 1] Method contains at least one non-comment statement (i.e., method is not empty)
+# 2] No data members are used or modified (including no use of keyword "this" by itself)
+# 3] No calls of any kind
+#
+method incidental       : normal & !isDataMemberUsed &
+                          functionCallsCount + methodCallsCount + newConstructorCallsCount +
+                          externalMethodCallsCount + externalFunctionCallsCount == 0
+
+# stateless
+#
+# 1] Method contains at least one non-comment statement (i.e., method is not empty)
+# 2] No data members are used or modified (including no use of keyword "this" by itself)
+# 3] No calls to methods in class
+# 4] No calls on data members
+# 5] Has at least one call to other class methods (including constructor calls) or to a free function
+#
+method stateless        : normal & !isDataMemberUsed & functionCallsCount == 0 & methodCallsCount == 0 &
+                          (externalFunctionCallsCount > 0 | externalMethodCallsCount > 0 | newConstructorCallsCount > 0)
+
+# unclassified
+#
+# No stereotype found
+#
+method unclassified     : none
+
+
+# Free functions
+#
+function main           : isMain
+function empty          : !isMain & nonCommentStatementsCount == 0
+
+function let normal     = !isMain & nonCommentStatementsCount != 0
+
+# predicate
+#
+# Returns a bool derived from the parameters
+#
+function predicate      : normal & isBoolReturnType & hasParameterComplexReturn & isParameterUsed
+
+# property
+#
+# Returns a non-bool derived from the parameters
+# A function that has no return type is not a property
+#
+function property       : normal & isNonVoidOrBoolReturnType & hasParameterComplexReturn & isParameterUsed
+
+# global-command
+#
+# Modifies a global or a static variable
+#
+function global-command : normal & isGlobalOrStaticVariableModified
+
+# command
+#
+# Modifies a parameter passed by reference
+#
+function command        : normal & isParameterRefModified
+
+# factory
+#
+# Creates and returns a 'new' locally created object
+# Constructor calls that are not using the 'new' operator are not considered
+#
+function factory        : normal & isNonPrimitiveReturnType & (isNewReturned | isVariableCreatedAndReturnedWithNew)
+
+# literal
+#
+# Does not read or change parameters
+#
+function literal        : normal & !isParameterUsed
+
+# wrapper
+#
+# Does not change parameters passed by reference. Has at least one call to other class methods or to a free function
+# Constructor calls using the 'new' operator are not considered
+#
+function wrapper        : normal & !isParameterRefModified & functionCallsCount + methodCallsCount > 0
+
+function unclassified   : none
+
+
+# Classes
+#
+# Counts are the number of methods with each method stereotype (e.g., get)
+# Constructors and destructors are not counted
+#
+class let accessors     = get + predicate + property + void-accessor
+class let commands      = command + non-void-command
+class let mutators      = set + commands
+class let collaborators = controller + collaborator + wrapper
+class let degenerates   = incidental + stateless + empty
+
+class entity            : accessors - get != 0 & mutators - set != 0 &
+                          collaborators >= 2 * nonCollaboratorsCount & controller == 0
+class minimal-entity    : methodsCount - get - set - commands == 0 & get != 0 & set != 0 & commands != 0 &
+                          collaborators >= 2 * nonCollaboratorsCount
+class data-provider     : accessors > 2 * mutators & accessors > 2 * controller + 2 * factory
+class commander         : mutators > 2 * accessors & mutators > 2 * controller + 2 * factory
+class boundary          : collaborators > nonCollaboratorsCount & factory < 0.5 * methodsCount & controller < 0.33 * methodsCount
+class factory           : factory > 0.67 * methodsCount
+class controller        : controller + factory > 0.67 * methodsCount & (accessors != 0 | mutators != 0)
+class pure-controller   : controller + factory != 0 & accessors + mutators + collaborator + wrapper == 0 & controller != 0
+class large-class       : accessors + mutators > 0.2 * methodsCount & accessors + mutators < 0.67 * methodsCount &
+                          controller + factory > 0.2 * methodsCount & controller + factory < 0.67 * methodsCount &
+                          factory != 0 & controller != 0 & accessors != 0 & mutators != 0 &
+                          methodsCount > largeClassThreshold
+class lazy-class        : get + set != 0 & degenerates > 0.33 * methodsCount &
+                          methodsCount - degenerates - get - set <= 0.2 * methodsCount
+class degenerate        : degenerates > 0.5 * methodsCount
+class data-class        : methodsCount - get - set == 0 & get + set != 0
+class small-class       : methodsCount > 0 & methodsCount < 3
+
+# Empty Class (Considered degenerate)
+#
+class empty             : methodsCount == 0
+class unclassified      : none
+)";
+
+// Facts that method and function rules can use
+// All of them are extracted for rules from a file (see analysisSettings::fastPaths)
+//
+static const std::unordered_map<std::string, std::uint32_t> METHOD_FACTS = {
+    {"isConstructorOrDestructor",                 FEATURE_CONSTRUCTOR_OR_DESTRUCTOR},
+    {"isDestructor",                              FEATURE_DESTRUCTOR},
+    {"isCopyConstructor",                         FEATURE_COPY_CONSTRUCTOR},
+    {"isMain",                                    FEATURE_MAIN},
+    {"isDataMemberUsed",                          FEATURE_DATA_MEMBER_USED},
+    {"isParameterUsed",                           FEATURE_PARAMETER_USED},
+    {"isMethodConst",                             FEATURE_METHOD_CONST},
+    {"hasSimpleReturn",                           FEATURE_SIMPLE_RETURN},
+    {"hasComplexReturn",                          FEATURE_COMPLEX_RETURN},
+    {"hasParameterComplexReturn",                 FEATURE_PARAMETER_COMPLEX_RETURN},
+    {"isParameterRefModified",                    FEATURE_PARAMETER_REF_MODIFIED},
+    {"isGlobalOrStaticVariableModified",          FEATURE_GLOBAL_OR_STATIC_MODIFIED},
+    {"isNewReturned",                             FEATURE_NEW_RETURNED},
+    {"isVariableCreatedAndReturnedWithNew",       FEATURE_CREATED_WITH_NEW_AND_RETURNED},
+    {"isNonPrimitiveReturnType",                  FEATURE_NON_PRIMITIVE_RETURN_TYPE},
+    {"isNonPrimitiveLocalOrParameterModified",    FEATURE_NON_PRIMITIVE_LOCAL_OR_PARAMETER_MODIFIED},
+    {"isNonPrimitiveDataMemberExternal",          FEATURE_NON_PRIMITIVE_DATA_MEMBER_EXTERNAL},
+    {"isNonPrimitiveLocalExternal",               FEATURE_NON_PRIMITIVE_LOCAL_EXTERNAL},
+    {"isNonPrimitiveParameterExternal",           FEATURE_NON_PRIMITIVE_PARAMETER_EXTERNAL},
+    {"isNonPrimitiveReturnTypeExternal",          FEATURE_NON_PRIMITIVE_RETURN_TYPE_EXTERNAL},
+    {"isBoolReturnType",                          FEATURE_RETURN_BOOL},
+    {"isNonVoidOrBoolReturnType",                 FEATURE_RETURN_NOT_VOID_OR_BOOL},
+    {"isVoidReturnType",                          FEATURE_RETURN_VOID},
+    {"isAnyVoidReturnType",                       FEATURE_RETURN_VOID_ANY},
+    {"isVoidPointer",                             FEATURE_VOID_POINTER},
+};
+
+static const std::unordered_map<std::string, int> METHOD_COUNTS = {
+    {"dataMembersModifiedCount",                  COUNT_DATA_MEMBERS_MODIFIED},
+    {"methodCallsCount",                          COUNT_METHOD_CALLS},
+    {"functionCallsCount",                        COUNT_FUNCTION_CALLS},
+    {"newConstructorCallsCount",                  COUNT_NEW_CONSTRUCTOR_CALLS},
+    {"externalFunctionCallsCount",                COUNT_EXTERNAL_FUNCTION_CALLS},
+    {"externalMethodCallsCount",                  COUNT_EXTERNAL_METHOD_CALLS},
+    {"nonCommentStatementsCount",                 COUNT_NON_COMMENT_STATEMENTS},
+};
+
+static const std::array<std::string, RULE_SCOPE_COUNT> SCOPE_NAMES = {"method", "function", "class"};
+
+static const std::size_t MAX_TERMS = 256;               // Limit on the size of a condition in disjunctive normal form
+static const std::size_t RULE_BLOCK_SIZE = 256;         // Number of rows classified together
+
+// Index of stereotype 'name' in the labels of 'scope' or -1 if not found
+//
+static int findLabel(ruleScope scope, const std::string& name) {
+    if (scope == RULE_CLASS) {
+        for (int i = 0; i < CLASS_STEREOTYPE_COUNT; ++i)
+            if (CLASS_STEREOTYPE_LABELS[i] == name) return i;
+    }
+    else {
+        for (int i = 0; i < METHOD_STEREOTYPE_COUNT; ++i)
+            if (METHOD_STEREOTYPE_LABELS[i] == name) return i;
+    }
+    return -1;
+}
+
+// Index of count column 'name' in 'scope' or -1 if not found
+//
+static int findCount(ruleScope scope, const std::string& name) {
+    if (scope == RULE_CLASS) {
+        if (name == "methodsCount")          return CLASS_COUNT_METHODS;
+        if (name == "nonCollaboratorsCount") return CLASS_COUNT_NON_COLLABORATORS;
+        return findLabel(RULE_METHOD, name);
+    }
+    auto it = METHOD_COUNTS.find(name);
+    return it != METHOD_COUNTS.end() ? it->second : -1;
+}
+
+struct ruleToken {
+    enum kind { NAME, NUMBER, SYMBOL, END };
+
+    kind                type{END};
+    std::string         text;
+    double              value{0};
+};
+
+// Recursive descent parser for one rule line
+//
+// condition := and ('|' and)*
+// and       := unary ('&' unary)*
+// unary     := '!' unary | '(' condition ')' | count relation count | name
+// count     := ['-'] term (('+' | '-') term)*
+// term      := number ['*' name] | name
+//
+class ruleParser {
+public:
+    ruleParser(const std::vector<ruleToken>& t, const ruleSet& s, ruleScope sc, int threshold)
+        : tokens(t), set(s), scope(sc), largeClassThreshold(threshold) {}
+
+    ruleNode            parseCondition  ();
+    ruleLinear          parseCount      ();
+    const ruleToken&    peek            (std::size_t ahead = 0) const;
+    bool                accept          (const std::string&);
+    void                expect          (const std::string&);
+    bool                atEnd           () const  { return peek().type == ruleToken::END; }
+    void                fail            (const std::string& message)  { if (error.empty()) error = message; }
+
+    std::size_t                     position{0};
+    std::string                     error;
+
+private:
+    ruleNode            parseAnd        ();
+    ruleNode            parseUnary      ();
+    ruleNode            parseComparison ();
+    void                parseTerm       (ruleLinear&, double);
+    ruleNode            findCondition   (const std::string&);
+    ruleLinear          findCountValue  (const std::string&);
+
+    const std::vector<ruleToken>&   tokens;
+    const ruleSet&                  set;
+    ruleScope                       scope;
+    int                             largeClassThreshold;
+};
+
+const ruleToken& ruleParser::peek(std::size_t ahead) const {
+    std::size_t i = position + ahead;
+    return i < tokens.size() ? tokens[i] : tokens.back();
+}
+
+bool ruleParser::accept(const std::string& text) {
+    const ruleToken& t = peek();
+    if (t.type != ruleToken::END && t.type != ruleToken::NUMBER && t.text == text) {
+        ++position;
+        return true;
+    }
+    return false;
+}
+
+void ruleParser::expect(const std::string& text) {
+    if (!accept(text)) fail("expected '" + text + "'");
+}
+
+ruleNode ruleParser::parseCondition() {
+    ruleNode left = parseAnd();
+    if (!accept("|")) return left;
+
+    ruleNode node;
+    node.type = ruleNode::OR;
+    node.children.push_back(left);
+    do node.children.push_back(parseAnd()); while (error.empty() && accept("|"));
+    return node;
+}
+
+ruleNode ruleParser::parseAnd() {
+    ruleNode left = parseUnary();
+    if (!accept("&")) return left;
+
+    ruleNode node;
+    node.type = ruleNode::AND;
+    node.children.push_back(left);
+    do node.children.push_back(parseUnary()); while (error.empty() && accept("&"));
+    return node;
+}
+
+ruleNode ruleParser::parseUnary() {
+    ruleNode node;
+    if (!error.empty()) return node;
+
+    if (accept("!")) {
+        node.type = ruleNode::NOT;
+        node.children.push_back(parseUnary());
+        return node;
+    }
+    if (accept("(")) {
+        node = parseCondition();
+        expect(")");
+        return node;
+    }
+
+    const ruleToken& t = peek();
+    const ruleToken& next = peek(1);
+    bool countFollows = next.type == ruleToken::SYMBOL && next.text != "&" && next.text != "|" && next.text != ")";
+    if (t.type == ruleToken::NUMBER || t.text == "-" || (t.type == ruleToken::NAME && countFollows))
+        return parseComparison();
+
+    if (t.type == ruleToken::NAME) {
+        ++position;
+        return findCondition(t.text);
+    }
+
+    fail(t.type == ruleToken::END ? "expected a condition" : "unexpected '" + t.text + "'");
+    return node;
+}
+
+// Comparisons are stored as (left - right) compared against zero
+//
+ruleNode ruleParser::parseComparison() {
+    ruleNode node;
+    node.type = ruleNode::COMPARISON;
+
+    ruleLinear left = parseCount();
+    ruleComparison& comparison = node.comparison;
+    if      (accept("<"))  comparison.op = ruleComparison::LESS;
+    else if (accept("<=")) comparison.op = ruleComparison::LESS_EQUAL;
+    else if (accept(">"))  comparison.op = ruleComparison::GREATER;
+    else if (accept(">=")) comparison.op = ruleComparison::GREATER_EQUAL;
+    else if (accept("==")) comparison.op = ruleComparison::EQUAL;
+    else if (accept("!=")) comparison.op = ruleComparison::NOT_EQUAL;
+    else {
+        fail("expected a comparison (<, <=, >, >=, ==, or !=)");
+        return node;
+    }
+    ruleLinear right = parseCount();
+
+    for (const auto& pair : right.coefficients) left.coefficients[pair.first] -= pair.second;
+    for (const auto& pair : left.coefficients)
+        if (pair.second != 0) comparison.terms.push_back(pair);
+    comparison.constant = left.constant - right.constant;
+
+    return node;
+}
+
+ruleLinear ruleParser::parseCount() {
+    ruleLinear count;
+    parseTerm(count, accept("-") ? -1 : 1);
+    while (error.empty()) {
+        if      (accept("+")) parseTerm(count, 1);
+        else if (accept("-")) parseTerm(count, -1);
+        else break;
+    }
+    return count;
+}
+
+void ruleParser::parseTerm(ruleLinear& count, double sign) {
+    const ruleToken& t = peek();
+    double coefficient = sign;
+    if (t.type == ruleToken::NUMBER) {
+        ++position;
+        if (!accept("*")) {
+            count.constant += sign * t.value;
+            return;
+        }
+        coefficient *= t.value;
+    }
+
+    const ruleToken& name = peek();
+    if (name.type != ruleToken::NAME) {
+        fail("expected a count");
+        return;
+    }
+    ++position;
+
+    ruleLinear value = findCountValue(name.text);
+    for (const auto& pair : value.coefficients) count.coefficients[pair.first] += coefficient * pair.second;
+    count.constant += coefficient * value.constant;
+}
+
+ruleNode ruleParser::findCondition(const std::string& name) {
+    ruleNode node;
+    if (name == "none") return node;
+
+    auto condition = set.conditions.find(name);
+    if (condition != set.conditions.end()) return condition->second;
+
+    if (scope != RULE_CLASS) {
+        auto fact = METHOD_FACTS.find(name);
+        if (fact != METHOD_FACTS.end()) {
+            node.type = ruleNode::FACT;
+            node.mask = std::uint64_t(fact->second) << RULE_FACT_SHIFT;
+            return node;
+        }
+    }
+
+    int label = findLabel(scope, name);
+    if (label != -1) {
+        node.type = ruleNode::LABEL;
+        node.mask = std::uint64_t(1) << label;
+        return node;
+    }
+
+    fail("unknown condition '" + name + "'");
+    return node;
+}
+
+ruleLinear ruleParser::findCountValue(const std::string& name) {
+    ruleLinear value;
+
+    auto count = set.counts.find(name);
+    if (count != set.counts.end()) return count->second;
+
+    if (name == "largeClassThreshold") {
+        value.constant = largeClassThreshold;
+        return value;
+    }
+
+    int column = findCount(scope, name);
+    if (column != -1) value.coefficients[column] = 1;
+    else              fail("unknown count '" + name + "'");
+
+    return value;
+}
+
+// Splits a rule line into tokens
+// Names may contain '-' (e.g., void-accessor)
+//
+static bool tokenizeRule(const std::string& line, std::vector<ruleToken>& tokens, std::string& error) {
+    std::size_t i = 0;
+    while (i < line.size()) {
+        unsigned char c = line[i];
+        ruleToken t;
+        if (std::isspace(c)) {
+            ++i;
+            continue;
+        }
+        if (std::isalpha(c) || c == '_') {
+            std::size_t start = i;
+            while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_' || line[i] == '-')) ++i;
+            t.type = ruleToken::NAME;
+            t.text = line.substr(start, i - start);
+        }
+        else if (std::isdigit(c) || c == '.') {
+            std::size_t start = i;
+            while (i < line.size() && (std::isdigit(static_cast<unsigned char>(line[i])) || line[i] == '.')) ++i;
+            t.type = ruleToken::NUMBER;
+            t.text = line.substr(start, i - start);
+            std::istringstream number(t.text);
+            if (!(number >> t.value) || !number.eof()) {
+                error = "invalid number '" + t.text + "'";
+                return false;
+            }
+        }
+        else {
+            std::string two = line.substr(i, 2);
+            t.type = ruleToken::SYMBOL;
+            if (two == "<=" || two == ">=" || two == "==" || two == "!=") t.text = two;
+            else if (std::string("&|!()+-*<>:=").find(c) != std::string::npos) t.text = std::string(1, c);
+            else {
+                error = std::string("unexpected character '") + line[i] + "'";
+                return false;
+            }
+            i += t.text.size();
+        }
+        tokens.push_back(t);
+    }
+    tokens.push_back(ruleToken());
+    return true;
+}
+
+// True if the term can never hold
+//
+static bool isContradiction(const ruleTerm& t) {
+    return (t.comparisonSet & t.comparisonClear) || (t.stateSet & t.stateClear);
+}
+
+// True if the condition depends on the labels of earlier rules
+//
+static bool usesLabels(const ruleNode& node) {
+    if (node.type == ruleNode::LABEL || node.type == ruleNode::NONE) return true;
+    for (const ruleNode& child : node.children)
+        if (usesLabels(child)) return true;
+    return false;
+}
+
+// Converts a condition to disjunctive normal form
+// Negations are pushed down to state bits and comparisons
+// Each distinct comparison is given a bit in 'set'
+//
+static bool toTerms(const ruleNode& node, bool negate, ruleSet& set, int labelCount,
+                    std::vector<ruleTerm>& terms, std::string& error) {
+    terms.clear();
+    ruleTerm term;
+    switch (node.type) {
+        case ruleNode::FACT:
+        case ruleNode::LABEL:
+            (negate ? term.stateClear : term.stateSet) = node.mask;
+            terms.push_back(term);
+            return true;
+
+        case ruleNode::NONE:
+            if (!negate) {
+                term.stateClear = (std::uint64_t(1) << labelCount) - 1;
+                terms.push_back(term);
+            }
+            else {
+                for (int label = 0; label < labelCount; ++label) {
+                    term.stateSet = std::uint64_t(1) << label;
+                    terms.push_back(term);
+                }
+            }
+            return true;
+
+        case ruleNode::COMPARISON: {
+            const ruleComparison& c = node.comparison;
+            std::size_t index = 0;
+            while (index < set.comparisons.size() &&
+                   !(set.comparisons[index].terms == c.terms && set.comparisons[index].constant == c.constant &&
+                     set.comparisons[index].op == c.op))
+                ++index;
+            if (index == set.comparisons.size()) {
+                if (index == 64) {
+                    error = "too many distinct comparisons (at most 64)";
+                    return false;
+                }
+                set.comparisons.push_back(c);
+            }
+            (negate ? term.comparisonClear : term.comparisonSet) = std::uint64_t(1) << index;
+            terms.push_back(term);
+            return true;
+        }
+
+        case ruleNode::NOT:
+            return toTerms(node.children[0], !negate, set, labelCount, terms, error);
+
+        case ruleNode::AND:
+        case ruleNode::OR: {
+            bool conjunction = (node.type == ruleNode::AND) != negate;
+            if (conjunction) terms.push_back(term);
+
+            std::vector<ruleTerm> childTerms;
+            for (const ruleNode& child : node.children) {
+                if (!toTerms(child, negate, set, labelCount, childTerms, error)) return false;
+
+                if (conjunction) {
+                    std::vector<ruleTerm> product;
+                    for (const ruleTerm& a : terms) {
+                        for (const ruleTerm& b : childTerms) {
+                            ruleTerm t;
+                            t.comparisonSet   = a.comparisonSet | b.comparisonSet;
+                            t.comparisonClear = a.comparisonClear | b.comparisonClear;
+                            t.stateSet        = a.stateSet | b.stateSet;
+                            t.stateClear      = a.stateClear | b.stateClear;
+                            if (!isContradiction(t)) product.push_back(t);
+                        }
+                    }
+                    terms.swap(product);
+                }
+                else terms.insert(terms.end(), childTerms.begin(), childTerms.end());
+
+                if (terms.size() > MAX_TERMS) {
+                    error = "condition is too complex";
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+    return true;
+}
+
+// Compiles one rule or definition into its scope in 'sets'
+// The first statement of a scope replaces all rules of that scope
+//
+bool stereotypeRules::compileRule(const std::string& statement, int lineNumber, std::array<ruleSet, RULE_SCOPE_COUNT>& sets,
+                                  std::array<bool, RULE_SCOPE_COUNT>& started, bool userDefined) {
+    std::string message;
+    std::vector<ruleToken> tokens;
+    if (!tokenizeRule(statement, tokens, message)) {
+        error = "line " + std::to_string(lineNumber) + ": " + message;
+        return false;
+    }
+
+    int scope = 0;
+    while (scope < RULE_SCOPE_COUNT && SCOPE_NAMES[scope] != tokens[0].text) ++scope;
+    if (scope == RULE_SCOPE_COUNT) {
+        error = "line " + std::to_string(lineNumber) + ": expected method, function, or class";
+        return false;
+    }
+
+    ruleSet& set = sets[scope];
+    if (!started[scope]) {
+        set = ruleSet();
+        set.userDefined = userDefined;
+        started[scope] = true;
+    }
+
+    int labelCount = scope == RULE_CLASS ? int(CLASS_STEREOTYPE_COUNT) : int(METHOD_STEREOTYPE_COUNT);
+    ruleParser parser(tokens, set, ruleScope(scope), largeClassThreshold);
+    parser.position = 1;
+    const ruleToken& name = parser.peek(1);
+    if (parser.peek().text == "let" && name.type == ruleToken::NAME) {
+        parser.position = 3;
+        parser.expect("=");
+        if (name.text == "none" || name.text == "largeClassThreshold" || findLabel(ruleScope(scope), name.text) != -1 ||
+            findCount(ruleScope(scope), name.text) != -1 || METHOD_FACTS.count(name.text) > 0)
+            parser.fail("'" + name.text + "' is already defined");
+        else {
+            // A definition is a count if it parses as one, otherwise it is a condition
+            std::size_t start = parser.position;
+            ruleLinear count = parser.parseCount();
+            if (parser.error.empty() && parser.atEnd()) {
+                set.counts[name.text] = count;
+                set.conditions.erase(name.text);
+            }
+            else {
+                parser.error.clear();
+                parser.position = start;
+                ruleNode condition = parser.parseCondition();
+                if (!parser.atEnd()) parser.fail("unexpected '" + parser.peek().text + "'");
+
+                // Conditions that do not depend on labels are computed once into a state bit
+                // Otherwise (or if there are no bits left) the condition is expanded where it is used
+                int bit = labelCount + set.definitions;
+                stereotypeRule definition;
+                definition.bit = bit;
+                if (parser.error.empty() && !usesLabels(condition) && bit < RULE_FACT_SHIFT &&
+                    toTerms(condition, false, set, labelCount, definition.terms, parser.error)) {
+                    set.rules.push_back(definition);
+                    ++set.definitions;
+                    condition = ruleNode();
+                    condition.type = ruleNode::FACT;
+                    condition.mask = std::uint64_t(1) << bit;
+                }
+                set.conditions[name.text] = condition;
+                set.counts.erase(name.text);
+            }
+        }
+    }
+    else {
+        stereotypeRule rule;
+        rule.bit = findLabel(ruleScope(scope), parser.peek().text);
+        if (rule.bit == -1) parser.fail("unknown " + SCOPE_NAMES[scope] + " stereotype '" + parser.peek().text + "'");
+        ++parser.position;
+        parser.expect(":");
+
+        ruleNode condition = parser.parseCondition();
+        if (!parser.atEnd()) parser.fail("unexpected '" + parser.peek().text + "'");
+
+        if (parser.error.empty() && toTerms(condition, false, set, labelCount, rule.terms, parser.error))
+            set.rules.push_back(rule);
+    }
+
+    if (!parser.error.empty()) {
+        error = "line " + std::to_string(lineNumber) + ": " + parser.error;
+        return false;
+    }
+    set.source.push_back(statement);
+    return true;
+}
+
+// Returns true if a rules file (-r) defines any scope
+//
+bool stereotypeRules::isUserDefined() const {
+    for (const ruleSet& set : scopes)
+        if (set.userDefined) return true;
+    return false;
+}
+
+// Reads and compiles rules into 'sets'
+// '#' starts a comment and a line that starts with whitespace continues the previous statement
+//
+void stereotypeRules::readRules(std::istream& in, std::array<ruleSet, RULE_SCOPE_COUNT>& sets, bool userDefined) {
+    std::array<bool, RULE_SCOPE_COUNT> started{};
+    std::string line;
+    std::string statement;
+    int lineNumber = 0;
+    int statementLine = 0;
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::size_t last = line.find_last_not_of(" \t\r");
+        if (last == std::string::npos) continue;
+        line.erase(last + 1);
+
+        if (std::isspace(static_cast<unsigned char>(line[0])) && !statement.empty()) {
+            statement += ' ' + line.substr(line.find_first_not_of(" \t"));
+            continue;
+        }
+        if (!statement.empty() && !compileRule(statement, statementLine, sets, started, userDefined)) return;
+        statement = line;
+        statementLine = lineNumber;
+    }
+    if (!statement.empty()) compileRule(statement, statementLine, sets, started, userDefined);
+}
+
+// Reads a user-defined set of rules
+// Scopes not found in the file keep the built-in rules
+//
+std::istream& operator>>(std::istream& in, stereotypeRules& rules) {
+    rules.readRules(in, rules.scopes, true);
+    return in;
+}
+
+// Compiles the built-in rules for scopes without user-defined rules
+// The rules are only compiled once (--serve analyzes many archives)
+//
+void stereotypeRules::createRuleList() {
+    if (created) return;
+    created = true;
+    std::array<ruleSet, RULE_SCOPE_COUNT> defaults;
+    std::istringstream in(DEFAULT_RULES);
+    readRules(in, defaults, false);
+
+    for (int scope = 0; scope < RULE_SCOPE_COUNT; ++scope)
+        if (!scopes[scope].userDefined) scopes[scope] = defaults[scope];
+}
+
+void stereotypeRules::outputRules(const std::string& title) const {
+    std::cerr << "---" << title << "---";
+    for (const ruleSet& set : scopes) {
+        for (const std::string& rule : set.source)
+            std::cerr << "\n[" << (set.userDefined ? "User-Defined" : "Default") << "]: " << rule;
+    }
+    std::cerr << "\n\n";
+}
+
+// Computes the stereotype mask of each row
+// 'flags' holds the fact bits of each row (nullptr if the scope has no facts)
+//  and 'columns' holds the count columns of the scope
+// Rows are evaluated in blocks that stay in cache. Within a block, each comparison
+//  and then each term of each rule is a branch-free loop over the rows
+//
+void stereotypeRules::classify(ruleScope scope, const std::uint32_t* flags, const std::vector<const int*>& columns,
+                               std::size_t n, std::vector<std::uint32_t>& result) const {
+    const ruleSet& set = scopes[scope];
+    const std::uint64_t labels = (std::uint64_t(1) << (scope == RULE_CLASS ? int(CLASS_STEREOTYPE_COUNT) : int(METHOD_STEREOTYPE_COUNT))) - 1;
+    result.assign(n, 0);
+
+    std::array<std::uint64_t, RULE_BLOCK_SIZE> compared;
+    std::array<std::uint64_t, RULE_BLOCK_SIZE> state;
+    std::array<double, RULE_BLOCK_SIZE>        value;
+
+    for (std::size_t first = 0; first < n; first += RULE_BLOCK_SIZE) {
+        const std::size_t size = std::min(RULE_BLOCK_SIZE, n - first);
+
+        compared.fill(0);
+        for (std::size_t c = 0; c < set.comparisons.size(); ++c) {
+            const ruleComparison& comparison = set.comparisons[c];
+            value.fill(comparison.constant);
+            for (const auto& term : comparison.terms) {
+                const int*   column      = columns[term.first] + first;
+                const double coefficient = term.second;
+                for (std::size_t i = 0; i < size; ++i) value[i] += coefficient * column[i];
+            }
+
+            const int bit = c;
+            switch (comparison.op) {
+                case ruleComparison::LESS:          for (std::size_t i = 0; i < size; ++i) compared[i] |= std::uint64_t(value[i] <  0) << bit; break;
+                case ruleComparison::LESS_EQUAL:    for (std::size_t i = 0; i < size; ++i) compared[i] |= std::uint64_t(value[i] <= 0) << bit; break;
+                case ruleComparison::GREATER:       for (std::size_t i = 0; i < size; ++i) compared[i] |= std::uint64_t(value[i] >  0) << bit; break;
+                case ruleComparison::GREATER_EQUAL: for (std::size_t i = 0; i < size; ++i) compared[i] |= std::uint64_t(value[i] >= 0) << bit; break;
+                case ruleComparison::EQUAL:         for (std::size_t i = 0; i < size; ++i) compared[i] |= std::uint64_t(value[i] == 0) << bit; break;
+                case ruleComparison::NOT_EQUAL:     for (std::size_t i = 0; i < size; ++i) compared[i] |= std::uint64_t(value[i] != 0) << bit; break;
+            }
+        }
+
+        for (std::size_t i = 0; i < size; ++i) state[i] = flags ? std::uint64_t(flags[first + i]) << RULE_FACT_SHIFT : 0;
+
+        for (const stereotypeRule& rule : set.rules) {
+            // A rule only sees the stereotypes of earlier rules, not its own
+            const std::uint64_t bit = std::uint64_t(1) << rule.bit;
+            for (const ruleTerm& t : rule.terms) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    const std::uint64_t earlier = state[i] & ~bit;
+                    const bool holds = ((compared[i] & t.comparisonSet) == t.comparisonSet) & ((compared[i] & t.comparisonClear) == 0) &
+                                       ((earlier & t.stateSet) == t.stateSet) & ((earlier & t.stateClear) == 0);
+                    state[i] |= std::uint64_t(holds) << rule.bit;
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < size; ++i) result[first + i] = std::uint32_t(state[i] & labels);
+    }
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file StereotypeRules.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef STEREOTYPERULES_HPP
+#define STEREOTYPERULES_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <iostream>
+#include <cstdint>
+#include "StereotypeMask.hpp"
+
+// What a rule labels
+//
+enum ruleScope { RULE_METHOD, RULE_FUNCTION, RULE_CLASS, RULE_SCOPE_COUNT };
+
+// Count columns of a class
+// The first METHOD_STEREOTYPE_COUNT columns are the number of methods labeled with each method stereotype
+//
+enum classCount {
+    CLASS_COUNT_METHODS = METHOD_STEREOTYPE_COUNT,  // Number of methods (constructors and destructors are not counted)
+    CLASS_COUNT_NON_COLLABORATORS,                  // Number of methods that are not collaborator, controller, or wrapper
+    CLASS_COUNT_COLUMNS
+};
+
+// Linear combination of count columns (e.g., get + 2 * set - 1)
+//
+struct ruleLinear {
+    std::map<int, double>                   coefficients;   // Key is column index
+    double                                  constant{0};
+};
+
+// Comparison of a linear combination of count columns against zero
+// Each distinct comparison is computed once per method and stored as a bit
+//
+struct ruleComparison {
+    enum relation { LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL };
+
+    std::vector<std::pair<int, double>>     terms;          // Column index and coefficient
+    double                                  constant{0};
+    relation                                op{EQUAL};
+};
+
+// Parsed rule condition
+//
+struct ruleNode {
+    enum kind { OR, AND, NOT, FACT, LABEL, NONE, COMPARISON };
+
+    kind                                    type{NONE};
+    std::uint64_t                           mask{0};        // State bit of a fact, a label, or a definition
+    ruleComparison                          comparison;
+    std::vector<ruleNode>                   children;
+};
+
+// Layout of the state bits of a row
+// Labels are the stereotypes assigned by earlier rules. Definitions are named conditions (let)
+//  that do not depend on labels, so they are computed once and then used as a single bit
+//
+// | labels (from 0) | definitions (up to 31) | facts (32 to 63) |
+//
+const int RULE_FACT_SHIFT = 32;
+
+// Conjunction of required and forbidden bits
+//
+struct ruleTerm {
+    std::uint64_t                           comparisonSet{0};
+    std::uint64_t                           comparisonClear{0};
+    std::uint64_t                           stateSet{0};
+    std::uint64_t                           stateClear{0};
+};
+
+// The state bit is set if any of the terms hold (i.e., the condition in disjunctive normal form)
+//
+struct stereotypeRule {
+    int                                     bit{0};
+    std::vector<ruleTerm>                   terms;
+};
+
+// Compiled rules of one scope
+//
+struct ruleSet {
+    std::vector<ruleComparison>                     comparisons;
+    std::vector<stereotypeRule>                     rules;          // Stereotypes and definitions in evaluation order
+    int                                             definitions{0}; // Number of definitions with a state bit
+    std::unordered_map<std::string, ruleNode>       conditions;     // Named conditions (let)
+    std::unordered_map<std::string, ruleLinear>     counts;         // Named counts (let)
+    std::vector<std::string>                        source;         // Rule lines as written
+    bool                                            userDefined{false};
+};
+
+// Stereotype rules read from a small declarative file (-r) and compiled to flat tables of bit masks
+// The built-in rules are used for any scope that the file does not define
+//
+class stereotypeRules {
+public:
+    void                 createRuleList          ();
+    void                 outputRules             (const std::string&) const;
+    void                 classify                (ruleScope, const std::uint32_t*, const std::vector<const int*>&,
+                                                  std::size_t, std::vector<std::uint32_t>&) const;
+    const std::string&   getError                () const                   { return error; }
+    bool                 isUserDefined           () const;
+
+    void                 setLargeClassThreshold  (int threshold)            { largeClassThreshold = threshold; }
+
+    friend std::istream& operator>>              (std::istream&, stereotypeRules&);
+
+private:
+    void                 readRules               (std::istream&, std::array<ruleSet, RULE_SCOPE_COUNT>&, bool);
+    bool                 compileRule             (const std::string&, int, std::array<ruleSet, RULE_SCOPE_COUNT>&,
+                                                  std::array<bool, RULE_SCOPE_COUNT>&, bool);
+
+    std::array<ruleSet, RULE_SCOPE_COUNT>           scopes;
+    std::string                                     error;                      // First error found in the rules file
+    int                                             largeClassThreshold{21};    // Value of 'largeClassThreshold' in class rules (-l)
+    bool                                            created{false};             // Have the built-in rules been compiled yet?
+};
+
+#endif
@@ -15,6 +15,10 @@ const std::string& typeModifiers::getTypeModifiers (const std::string& unitLang)
     return patterns.at(unitLang);
 }
 
+const std::regex& typeModifiers::getTypeModifierRegex (const std::string& unitLang) const {
+    return regexes.at(unitLang);
+}
+
 // Adds "type" to user-defined type modifiers if not already present
 //
 void typeModifiers::addTypeModifier  (const std::string& type) {
@@ -47,8 +51,10 @@ void typeModifiers::outputModifiers() {
 }
 
 // Specific type Modifiers are used based on unit language
+// The patterns are only created and compiled once (--serve analyzes many archives)
 //
 void typeModifiers::createModifierList() {
+    if (!patterns.empty()) return;
     for (const auto& l : LANGUAGE) {
         if (l == "C++") {
             mtypes.insert({l, { "const", "volatile", "inline", "virtual", "friend", "extern", "&", "&&", "\\*", "public", "private", "protected",
@@ -118,5 +124,6 @@ void typeModifiers::createModifierList() {
 
         pattern = "(" + pattern + ")";
         patterns.insert({l, pattern});
+        regexes.insert({l, std::regex(pattern)});
     }
 }
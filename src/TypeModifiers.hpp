@@ -16,21 +16,25 @@
 #include <unordered_map>
 #include <vector>
 #include <cctype>
+#include <regex>
 #include <iostream>
 
 class typeModifiers {
 public:
     const std::string&   getTypeModifiers   (const std::string&) const;
+    const std::regex&    getTypeModifierRegex (const std::string&) const;
    
     void                 addTypeModifier       (const std::string&);
     void                 createModifierList    ();
     void                 outputModifiers       ();
+    const std::unordered_set<std::string>& getUserModifiers () const { return userMtypes; }
     friend std::istream& operator>>         (std::istream&, typeModifiers&);
 
 private:
     std::unordered_map<std::string, std::unordered_set<std::string>>       mtypes;          // List of type modifiers
     std::unordered_set<std::string>                                        userMtypes;      // List of user defined type modifiers
     std::unordered_map<std::string, std::string>                           patterns;                                 
+    std::unordered_map<std::string, std::regex>                            regexes;         // Compiled patterns
 };
 
 #endif
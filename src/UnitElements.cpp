@@ -0,0 +1,444 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file UnitElements.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#include "UnitElements.hpp"
+
+extern std::vector<std::string> LANGUAGE;
+
+enum elementKind { ELEMENT_OTHER, ELEMENT_CLASS, ELEMENT_STRUCT, ELEMENT_UNION, ELEMENT_INTERFACE, ELEMENT_ENUM,
+                   ELEMENT_FUNCTION, ELEMENT_CONSTRUCTOR, ELEMENT_DESTRUCTOR, ELEMENT_PROPERTY,
+                   ELEMENT_TYPE, ELEMENT_SPECIFIER, ELEMENT_NAME, ELEMENT_SUPER };
+
+// What the xpaths need to know about an element
+//
+struct element {
+    elementKind     kind{ELEMENT_OTHER};
+    int             parent{-1};
+    bool            staticSpecifier{false};     // Has a child specifier 'static' (e.g., src:specifier='static')
+    bool            staticType{false};          // Has a child type with a child specifier 'static' (e.g., src:type/src:specifier='static')
+    bool            hasName{false};             // Has a child name (e.g., src:union[src:name])
+    bool            hasSuper{false};            // Has a child super (e.g., src:class[child::src:super[1]])
+};
+
+static elementKind findKind(const std::string& srcML, std::size_t begin, std::size_t end) {
+    static const std::map<std::string, elementKind> KINDS = {
+        {"class", ELEMENT_CLASS}, {"struct", ELEMENT_STRUCT}, {"union", ELEMENT_UNION}, {"interface", ELEMENT_INTERFACE}, {"enum", ELEMENT_ENUM},
+        {"function", ELEMENT_FUNCTION}, {"constructor", ELEMENT_CONSTRUCTOR}, {"destructor", ELEMENT_DESTRUCTOR}, {"property", ELEMENT_PROPERTY},
+        {"type", ELEMENT_TYPE}, {"specifier", ELEMENT_SPECIFIER}, {"name", ELEMENT_NAME}, {"super", ELEMENT_SUPER}
+    };
+    auto kind = KINDS.find(srcML.substr(begin, end - begin));
+    return kind != KINDS.end() ? kind->second : ELEMENT_OTHER;
+}
+
+// Calls 'onStart(nameBegin, nameEnd, tagEnd)' for each start tag, where 'tagEnd' is the offset of the '>'
+//  (or of the '/' in '/>') that closes the tag, 'onEnd()' for each end tag (and after each empty element),
+//  and 'onText(begin, end)' for text
+// Comments, processing instructions, and CDATA are skipped
+//
+template <typename Start, typename End, typename Text>
+static void scanElements(const std::string& srcML, Start onStart, End onEnd, Text onText) {
+    const std::size_t n = srcML.size();
+    std::size_t pos = 0;
+    while (pos < n) {
+        std::size_t open = srcML.find('<', pos);
+        if (open == std::string::npos) {
+            onText(pos, n);
+            break;
+        }
+        if (open > pos) onText(pos, open);
+
+        std::size_t close = std::string::npos;
+        if (srcML.compare(open, 4, "<!--") == 0)
+            close = srcML.find("-->", open);
+        else if (srcML.compare(open, 9, "<![CDATA[") == 0) {
+            close = srcML.find("]]>", open);
+            onText(open + 9, close == std::string::npos ? n : close);
+        }
+        else if (open + 1 < n && (srcML[open + 1] == '?' || srcML[open + 1] == '!'))
+            close = srcML.find('>', open);
+        else if (open + 1 < n && srcML[open + 1] == '/') {
+            onEnd();
+            close = srcML.find('>', open);
+        }
+        else {
+            std::size_t nameEnd = srcML.find_first_of(" \t\r\n/>", open + 1);
+            if (nameEnd == std::string::npos) break;
+
+            // Attribute values may contain '>'
+            char quote = 0;
+            close = nameEnd;
+            for (; close < n; ++close) {
+                char c = srcML[close];
+                if (quote)                      { if (c == quote) quote = 0; }
+                else if (c == '"' || c == '\'')   quote = c;
+                else if (c == '>')                break;
+            }
+            if (close == n) break;
+
+            bool empty = srcML[close - 1] == '/';
+            onStart(open + 1, nameEnd, empty ? close - 1 : close);
+            if (empty) onEnd();
+        }
+
+        if (close == std::string::npos) break;
+        pos = srcML.find('>', close) + 1;
+    }
+}
+
+// Finds the classes, methods, and free functions of a unit
+// Child conditions are only known once the children are read, so the elements are collected first
+//  and then checked in document order, where each element comes after its ancestors
+//
+unitElements::unitElements(const std::string& srcML, const std::string& unitLanguage, const analysisSettings& settings) {
+    const bool cpp    = unitLanguage == "C++";
+    const bool csharp = unitLanguage == "C#";
+    const bool java   = unitLanguage == "Java";
+    if (!cpp && !csharp && !java) return;
+
+    std::vector<element> elements;
+    std::vector<int>     open;
+    std::string          specifierText;
+
+    scanElements(srcML,
+        [&](std::size_t nameBegin, std::size_t nameEnd, std::size_t) {
+            element e;
+            e.kind = findKind(srcML, nameBegin, nameEnd);
+            e.parent = open.empty() ? -1 : open.back();
+            if (e.parent != -1) {
+                if (e.kind == ELEMENT_NAME)  elements[e.parent].hasName = true;
+                if (e.kind == ELEMENT_SUPER) elements[e.parent].hasSuper = true;
+            }
+            if (e.kind == ELEMENT_SPECIFIER) specifierText.clear();
+            open.push_back(elements.size());
+            elements.push_back(e);
+        },
+        [&]() {
+            if (open.empty()) return;
+            const element& e = elements[open.back()];
+            if (e.kind == ELEMENT_SPECIFIER && e.parent != -1 && specifierText == "static") elements[e.parent].staticSpecifier = true;
+            open.pop_back();
+        },
+        [&](std::size_t begin, std::size_t end) {
+            if (!open.empty() && elements[open.back()].kind == ELEMENT_SPECIFIER) specifierText.append(srcML, begin, end - begin);
+        });
+
+    for (const element& e : elements)
+        if (e.kind == ELEMENT_TYPE && e.staticSpecifier && e.parent != -1) elements[e.parent].staticType = true;
+
+    // Kinds counted by ancestor::src:class | ... in each language
+    auto isClassKind = [&](elementKind kind) {
+        if (kind == ELEMENT_CLASS)      return true;
+        if (kind == ELEMENT_STRUCT)     return cpp || csharp;
+        if (kind == ELEMENT_UNION)      return cpp;
+        if (kind == ELEMENT_INTERFACE)  return csharp || java;
+        if (kind == ELEMENT_ENUM)       return java;
+        return false;
+    };
+
+    const std::size_t n = elements.size();
+    std::vector<int> classDepth(n, 0);          // Number of class kind ancestors
+    std::vector<int> nearestClass(n, -1);       // Nearest class kind ancestor
+    std::vector<int> nearestFunction(n, -1);    // Nearest function ancestor
+    std::vector<int> nearestProperty(n, -1);    // Nearest property ancestor
+    std::vector<int> classIndex(n, -1);         // Index in 'classes' if the element is a class
+    std::vector<int> propertyIndex(n, -1);      // Index in 'propertyMethods' of its class if the element is a property
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const element& e = elements[i];
+        const int p = e.parent;
+        if (p != -1) {
+            const element& parent = elements[p];
+            classDepth[i]      = classDepth[p] + (isClassKind(parent.kind) ? 1 : 0);
+            nearestClass[i]    = isClassKind(parent.kind)          ? p : nearestClass[p];
+            nearestFunction[i] = parent.kind == ELEMENT_FUNCTION ? p : nearestFunction[p];
+            nearestProperty[i] = parent.kind == ELEMENT_PROPERTY ? p : nearestProperty[p];
+        }
+
+        // Class
+        bool isClass = false;
+        if (cpp)
+            isClass = e.kind == ELEMENT_CLASS || (settings.extractedStructs && e.kind == ELEMENT_STRUCT) || (settings.extractedUnions && e.kind == ELEMENT_UNION && e.hasName);
+        else if (csharp)
+            isClass = (e.kind == ELEMENT_CLASS || (settings.extractedStructs && e.kind == ELEMENT_STRUCT) || (settings.extractedInterfaces && e.kind == ELEMENT_INTERFACE)) && !e.staticSpecifier;
+        else
+            isClass = (e.kind == ELEMENT_CLASS && !e.hasSuper) || (settings.extractedInterfaces && e.kind == ELEMENT_INTERFACE) || (settings.extractedEnums && e.kind == ELEMENT_ENUM);
+
+        if (isClass && classDepth[i] == 0) {
+            classIndex[i] = classes.size();
+            classes.push_back(i);
+            propertyMethods.emplace_back();
+        }
+
+        // Property and its methods (C# only)
+        const int owner = nearestClass[i] != -1 ? classIndex[nearestClass[i]] : -1;
+        if (csharp && e.kind == ELEMENT_PROPERTY && classDepth[i] == 1 && !e.staticType && owner != -1) {
+            propertyIndex[i] = propertyMethods[owner].size();
+            propertyMethods[owner].emplace_back();
+        }
+        const int property = nearestProperty[i];
+        if (csharp && e.kind == ELEMENT_FUNCTION && property != -1 && propertyIndex[property] != -1 && nearestFunction[i] < property) {
+            const int propertyOwner = classIndex[nearestClass[property]];
+            propertyMethods[propertyOwner][propertyIndex[property]].push_back(i);
+        }
+
+        // Free function
+        bool isFreeFunction = false;
+        if (cpp)
+            isFreeFunction = e.kind == ELEMENT_FUNCTION && (classDepth[i] == 0 || e.staticType);
+        else if (csharp)
+            isFreeFunction = e.kind == ELEMENT_FUNCTION && (e.staticType || (property != -1 && elements[property].staticType));
+        else
+            isFreeFunction = e.kind == ELEMENT_FUNCTION && e.staticType;
+        if (isFreeFunction) freeFunctions.push_back(i);
+    }
+
+    // Methods of each class found above, with the "method" xpath of each language applied to the class
+    // A class takes the parts of the classes with the same name in the other units, which can be in another
+    //  language (e.g., a C++ and a C# class named MyClass), and the methods of a part are found with the
+    //  xpath of the language of the class, not of the unit
+    for (const std::string& language : LANGUAGE) {
+        const bool methodCpp  = language == "C++";
+        const bool methodJava = language == "Java";
+        auto isMethodClassKind = [&](elementKind kind) {
+            if (kind == ELEMENT_CLASS)      return true;
+            if (kind == ELEMENT_STRUCT)     return !methodJava;
+            if (kind == ELEMENT_UNION)      return methodCpp;
+            if (kind == ELEMENT_INTERFACE)  return !methodCpp;
+            if (kind == ELEMENT_ENUM)       return methodJava;
+            return false;
+        };
+
+        std::vector<std::vector<int>>& classMethods = methods[language];
+        classMethods.resize(classes.size());
+        std::vector<int>  root(n, -1);              // Class the element is in
+        std::vector<int>  ancestors(n, 0);          // Number of class kind ancestors up to the class
+        std::vector<bool> inFunction(n, false);     // Has a function or property ancestor up to the class
+        for (std::size_t i = 0; i < n; ++i) {
+            const element& e = elements[i];
+            const int p = e.parent;
+            if (classIndex[i] != -1) {
+                root[i] = classIndex[i];
+                continue;
+            }
+            if (p == -1 || root[p] == -1) continue;
+
+            root[i] = root[p];
+            ancestors[i] = ancestors[p] + (isMethodClassKind(elements[p].kind) ? 1 : 0);
+            inFunction[i] = inFunction[p] || (classIndex[p] == -1 && (elements[p].kind == ELEMENT_FUNCTION || elements[p].kind == ELEMENT_PROPERTY));
+
+            bool isMethod = (e.kind == ELEMENT_FUNCTION || e.kind == ELEMENT_CONSTRUCTOR || (e.kind == ELEMENT_DESTRUCTOR && !methodJava)) &&
+                            !e.staticType && ancestors[i] == 1;
+            if (language == "C#") isMethod = isMethod && !inFunction[i];
+            if (isMethod) classMethods[root[i]].push_back(i);
+        }
+    }
+}
+
+// Checks the bytes of a unit for a start tag of an element that can be a class, a method, or a free function
+// This is a quick check before the unit is analyzed. A unit without any of these tags has nothing to annotate
+//
+bool unitElements::hasDefinitions(const char* srcML, std::size_t size) {
+    static const std::vector<std::string> TAGS = {
+        "class", "struct", "union", "interface", "enum", "function", "constructor", "destructor"
+    };
+
+    const char* end = srcML + size;
+    for (const char* open = static_cast<const char*>(std::memchr(srcML, '<', size)); open != nullptr;
+         open = static_cast<const char*>(std::memchr(open + 1, '<', end - open - 1))) {
+        const char* name = open + 1;
+        for (const std::string& tag : TAGS) {
+            if (static_cast<std::size_t>(end - name) <= tag.size() || std::memcmp(name, tag.c_str(), tag.size()) != 0) continue;
+            char next = name[tag.size()];
+            if (next == ' ' || next == '>' || next == '/' || next == '\t' || next == '\r' || next == '\n') return true;
+        }
+    }
+    return false;
+}
+
+// Qualified name of the first package (Java) or namespace (C++ and C#) declared in a unit (e.g., a.b or a::b)
+// Namespaces in a using directive are skipped. Returns an empty string if there is none (or it has no name)
+// Used by the rollup report (--rollup)
+//
+std::string unitElements::findNamespace(const char* srcML, std::size_t size) {
+    const char* end = srcML + size;
+    auto isTag = [&](const char* name, const char* tag) {
+        std::size_t length = std::strlen(tag);
+        if (static_cast<std::size_t>(end - name) <= length || std::memcmp(name, tag, length) != 0) return false;
+        char next = name[length];
+        return next == ' ' || next == '>' || next == '/' || next == '\t' || next == '\r' || next == '\n';
+    };
+
+    bool inUsing = false;
+    for (const char* open = static_cast<const char*>(std::memchr(srcML, '<', size)); open != nullptr;
+         open = static_cast<const char*>(std::memchr(open + 1, '<', end - open - 1))) {
+        const char* name = open + 1;
+        if (isTag(name, "using"))  inUsing = true;
+        if (isTag(name, "/using")) inUsing = false;
+        if (inUsing || !(isTag(name, "namespace") || isTag(name, "package"))) continue;
+
+        // Text of the name element that follows the start tag (nested name elements give the qualified name)
+        const char* close = static_cast<const char*>(std::memchr(open, '>', end - open));
+        if (close == nullptr) return "";
+        const char* position = close + 1;
+        while (position < end && *position != '<') ++position;
+        if (position == end || !isTag(position + 1, "name")) return "";
+
+        std::string qualified;
+        int depth = 0;
+        while (position < end) {
+            if (*position == '<') {
+                if (isTag(position + 1, "/name")) --depth;
+                else if (isTag(position + 1, "name") && position[5] != '/') ++depth;
+                if (depth == 0) break;
+                const char* tagEnd = static_cast<const char*>(std::memchr(position, '>', end - position));
+                if (tagEnd == nullptr) break;
+                position = tagEnd + 1;
+            }
+            else {
+                if (!std::isspace(static_cast<unsigned char>(*position))) qualified += *position;
+                ++position;
+            }
+        }
+        return qualified;
+    }
+    return "";
+}
+
+int unitElements::getClass(std::size_t i) const {
+    return i < classes.size() ? classes[i] : -1;
+}
+
+int unitElements::getMethod(const std::string& language, std::size_t c, std::size_t i) const {
+    auto classMethods = methods.find(language);
+    if (classMethods == methods.end() || c >= classMethods->second.size()) return -1;
+    return i < classMethods->second[c].size() ? classMethods->second[c][i] : -1;
+}
+
+int unitElements::getPropertyMethod(std::size_t c, std::size_t property, std::size_t i) const {
+    if (c >= propertyMethods.size() || property >= propertyMethods[c].size()) return -1;
+    return i < propertyMethods[c][property].size() ? propertyMethods[c][property][i] : -1;
+}
+
+int unitElements::getFreeFunction(std::size_t i) const {
+    return i < freeFunctions.size() ? freeFunctions[i] : -1;
+}
+
+// Finds the start tags of the annotated ordinals without copying the srcML (used by --sidecar)
+//
+std::vector<elementTag> unitElements::findTags(const std::string& srcML, const std::map<int, stereotypeMask>& annotations) {
+    std::vector<elementTag> tags;
+    int ordinal = 0;
+    auto next = annotations.begin();
+
+    scanElements(srcML,
+        [&](std::size_t nameBegin, std::size_t nameEnd, std::size_t tagEnd) {
+            if (next != annotations.end() && next->first == ordinal) {
+                elementTag tag;
+                tag.ordinal = ordinal;
+                tag.name = srcML.substr(nameBegin, nameEnd - nameBegin);
+
+                // pos:start="line:column"
+                std::size_t start = srcML.find(" pos:start=\"", nameEnd);
+                if (start != std::string::npos && start < tagEnd) {
+                    std::size_t value = start + 12;
+                    std::size_t colon = srcML.find(':', value);
+                    if (colon != std::string::npos && colon < tagEnd) {
+                        tag.line = std::atoi(srcML.c_str() + value);
+                        tag.column = std::atoi(srcML.c_str() + colon + 1);
+                    }
+                }
+                tags.push_back(tag);
+                ++next;
+            }
+            ++ordinal;
+        },
+        []() {},
+        [](std::size_t, std::size_t) {});
+
+    return tags;
+}
+
+// Copies the srcML of a unit and adds the stereotype attributes to the start tags of the annotated ordinals
+// 'attributes' are the attribute names (e.g., st:stereotype-<profile>) of the profile stereotypes
+// 'namespaces' (prefix and uri) are declared on the unit if they are not already, so the copy can be read on its own
+// If 'comment' is true (-c), a comment with the stereotype is added before each annotated element, followed by
+//  the indentation of the element, which is the text after the last newline of its nearest preceding text sibling
+// Example: <comment type="block">/** @Stereotype get */</comment>
+//
+std::string unitElements::annotate(const std::string& srcML, const std::map<int, stereotypeMask>& annotations,
+                                   const std::vector<std::string>& attributes,
+                                   const std::vector<std::pair<std::string, std::string>>& namespaces, bool comment) {
+    std::string result;
+    result.reserve(srcML.size() + annotations.size() * (comment ? 100 : 40));
+
+    std::size_t copied = 0;
+    int ordinal = 0;
+    auto next = annotations.begin();
+
+    // Nearest preceding text sibling of the next child of each open element (document level first)
+    struct textSibling {
+        std::size_t begin{0};
+        std::size_t end{0};
+        bool        isLast{false};  // No element came after the text yet, so more text extends it
+    };
+    std::vector<textSibling> siblings(1);
+
+    scanElements(srcML,
+        [&](std::size_t nameBegin, std::size_t, std::size_t tagEnd) {
+            std::string insert;
+            if (ordinal == 0) {
+                const std::string tag = srcML.substr(nameBegin, tagEnd - nameBegin);
+                for (const auto& ns : namespaces) {
+                    std::string declaration = ns.first.empty() ? " xmlns=\"" : " xmlns:" + ns.first + "=\"";
+                    if (tag.find(declaration) == std::string::npos) insert += declaration + ns.second + "\"";
+                }
+            }
+            if (next != annotations.end() && next->first == ordinal) {
+                const bool classified = next->second.bits != stereotypeMask::NOT_CLASSIFIED;
+                if (comment && classified) {
+                    const textSibling& text = siblings.back();
+                    std::size_t indent = text.begin;
+                    if (text.end > text.begin) {
+                        std::size_t newline = srcML.rfind('\n', text.end - 1);
+                        if (newline != std::string::npos && newline >= text.begin) indent = newline + 1;
+                    }
+                    result.append(srcML, copied, nameBegin - 1 - copied);
+                    result += "<comment type=\"block\">/** @Stereotype " + next->second.label() + " */</comment>\n";
+                    result.append(srcML, indent, text.end - indent);
+                    copied = nameBegin - 1;
+                }
+
+                if (classified) insert += " st:stereotype=\"" + next->second.label() + "\"";
+                for (std::size_t i = 0; i < next->second.profiles.size() && i < attributes.size(); ++i)
+                    if (next->second.profiles[i] != stereotypeMask::NOT_CLASSIFIED)
+                        insert += " st:" + attributes[i] + "=\"" + next->second.label(next->second.profiles[i]) + "\"";
+                ++next;
+            }
+            if (!insert.empty()) {
+                result.append(srcML, copied, tagEnd - copied);
+                result += insert;
+                copied = tagEnd;
+            }
+            siblings.back().isLast = false;
+            siblings.push_back(textSibling());
+            ++ordinal;
+        },
+        [&]() {
+            if (siblings.size() > 1) siblings.pop_back();
+        },
+        [&](std::size_t begin, std::size_t end) {
+            textSibling& text = siblings.back();
+            if (!text.isLast) text.begin = begin;
+            text.end = end;
+            text.isLast = true;
+        });
+
+    result.append(srcML, copied, std::string::npos);
+    return result;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file UnitElements.hpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+#ifndef UNITELEMENTS_HPP
+#define UNITELEMENTS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include "StereotypeMask.hpp"
+#include "AnalysisSettings.hpp"
+
+// Start tag of an annotated element
+//
+struct elementTag {
+    int                         ordinal{-1};
+    std::string                 name;               // Element name (e.g., function or class)
+    int                         line{0};            // Position of the start tag from pos:start (0 if the archive has no positions)
+    int                         column{0};
+};
+
+// Ordinals of the classes, methods, and free functions of a unit
+// An ordinal is the position of an element's start tag among all start tags of the unit (the unit itself is 0)
+// The elements are found with one pass over the unit's srcML using the same conditions as the
+//  "class", "method", "property", and "free_function" xpaths, and are listed in document order like
+//  the results of those xpaths. The methods of a class are found with the xpath of each language, since a class can
+//  take parts in other languages. The kinds of classes found depend on the settings (-s, -i, -n, -m)
+// Each getter returns -1 if the element is not found
+// A default constructed object has no elements (i.e., nothing is annotated)
+//
+class unitElements {
+public:
+                                unitElements            () = default;
+                                unitElements            (const std::string&, const std::string&, const analysisSettings&);
+
+    int                         getClass                (std::size_t) const;
+    int                         getMethod               (const std::string&, std::size_t, std::size_t) const;
+    int                         getPropertyMethod       (std::size_t, std::size_t, std::size_t) const;
+    int                         getFreeFunction         (std::size_t) const;
+
+    static bool                 hasDefinitions          (const char*, std::size_t);
+    static std::string          findNamespace           (const char*, std::size_t);
+    static std::vector<elementTag>
+                                findTags                (const std::string&, const std::map<int, stereotypeMask>&);
+    static std::string          annotate                (const std::string&, const std::map<int, stereotypeMask>&,
+                                                         const std::vector<std::string>&,
+                                                         const std::vector<std::pair<std::string, std::string>>&, bool);
+
+private:
+    std::vector<int>                                    classes;            // Classes in document order
+    std::map<std::string, std::vector<std::vector<int>>>
+                                                        methods;            // Methods of each class by the language of the xpath
+    std::vector<std::vector<std::vector<int>>>          propertyMethods;    // Methods of each property of each class (C#)
+    std::vector<int>                                    freeFunctions;      // Free functions in document order
+};
+
+#endif
@@ -9,19 +9,16 @@
 
 #include "XPathBuilder.hpp"
 
-extern bool   STRUCT;        
-extern bool   INTERFACE;   
-extern bool   UNION;
-extern bool   ENUM;
-
-void XPathBuilder::generateXpath() {
+// The xpaths of the classes depend on the kinds of classes analyzed (-s, -i, -n, -m)
+//
+void XPathBuilder::generateXpath(bool structs, bool interfaces, bool unions, bool enums) {
     /////////////////////
     //////// C++ ////////
     /////////////////////
     std::string language = "C++";
     std::string xpath = "//src:*[(self::src:class";
-    if (STRUCT) xpath += " or self::src:struct";        
-    if (UNION) xpath += " or self::src:union[src:name]";       
+    if (structs) xpath += " or self::src:struct";        
+    if (unions) xpath += " or self::src:union[src:name]";       
     xpath += ") and not(ancestor::src:class or ancestor::src:struct or ancestor::src:union)]"; 
     xpathTable[language]["class"] = xpath;
 
@@ -112,6 +109,10 @@ void XPathBuilder::generateXpath() {
     xpath = "//src:block_content[1][*[not(self::src:comment)][1]]";
     xpathTable[language]["non_comment_statements"] = xpath; 
 
+    xpath = "/src:unit[count(//src:expr) = 1]/src:function/src:block/src:block_content[count(*[not(self::src:comment)]) = 1]";
+    xpath += "/src:return/src:expr[count(*) = 1][src:name]";
+    xpathTable[language]["simple_return"] = xpath; 
+
     xpath = "//src:expr/src:name";
     xpathTable[language]["expression_name"] = xpath;    
 
@@ -131,8 +132,8 @@ void XPathBuilder::generateXpath() {
     /////////////////////
     language = "C#";
     xpath = "//src:*[(self::src:class";
-    if (STRUCT) xpath += " or self::src:struct";
-    if (INTERFACE) xpath += " or self::src:interface";             
+    if (structs) xpath += " or self::src:struct";
+    if (interfaces) xpath += " or self::src:interface";             
     xpath += ") and not(src:specifier='static') and not(ancestor::src:class or ancestor::src:struct or ancestor::src:interface)]"; 
     xpathTable[language]["class"] = xpath;
 
@@ -233,6 +234,10 @@ void XPathBuilder::generateXpath() {
     xpath = "//src:block_content[1][*[not(self::src:comment)][1]]";
     xpathTable[language]["non_comment_statements"] = xpath; 
 
+    xpath = "/src:unit[count(//src:expr) = 1]/src:function/src:block/src:block_content[count(*[not(self::src:comment)]) = 1]";
+    xpath += "/src:return/src:expr[count(*) = 1][src:name]";
+    xpathTable[language]["simple_return"] = xpath; 
+
     xpath = "//src:expr[count(ancestor::src:function) = 1]/src:name";
     xpathTable[language]["expression_name"] = xpath;    
 
@@ -252,8 +257,8 @@ void XPathBuilder::generateXpath() {
     /////////////////////
     language = "Java";
     xpath = "//src:*[((self::src:class and not(child::src:super[1]))";
-    if (INTERFACE) xpath += " or self::src:interface";       
-    if (ENUM) xpath += " or self::src:enum";        
+    if (interfaces) xpath += " or self::src:interface";       
+    if (enums) xpath += " or self::src:enum";        
     xpath += ") and not(ancestor::src:class or ancestor::src:interface or ancestor::src:enum)]"; 
     xpathTable[language]["class"] = xpath;
 
@@ -341,6 +346,10 @@ void XPathBuilder::generateXpath() {
     xpath = "//src:block_content[1][*[not(self::src:comment)][1]]";
     xpathTable[language]["non_comment_statements"] = xpath; 
 
+    xpath = "/src:unit[count(//src:expr) = 1]/src:function/src:block/src:block_content[count(*[not(self::src:comment)]) = 1]";
+    xpath += "/src:return/src:expr[count(*) = 1][src:name]";
+    xpathTable[language]["simple_return"] = xpath; 
+
     xpath = "//src:expr/src:name";
     xpathTable[language]["expression_name"] = xpath;    
 
@@ -354,6 +363,12 @@ void XPathBuilder::generateXpath() {
     xpathTable[language]["expression_assignment"] = xpath;  
 }
 
-const std::string& XPathBuilder::getXpath(const std::string& language, const std::string& xpathName) {
-    return xpathTable[language][xpathName];
+// Returns an empty xpath if there is none with the name for the language
+//
+const std::string& XPathBuilder::getXpath(const std::string& language, const std::string& xpathName) const {
+    static const std::string none;
+    auto table = xpathTable.find(language);
+    if (table == xpathTable.end()) return none;
+    auto xpath = table->second.find(xpathName);
+    return xpath == table->second.end() ? none : xpath->second;
 }
\ No newline at end of file
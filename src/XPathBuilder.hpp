@@ -18,9 +18,9 @@ private:
     std::unordered_map<std::string, std::unordered_map<std::string, std::string>> xpathTable;
 
 public:
-          void         generateXpath ();
+          void         generateXpath (bool, bool, bool, bool);
 
-    const std::string& getXpath      (const std::string&, const std::string&);
+    const std::string& getXpath      (const std::string&, const std::string&) const;
 };
 
 #endif
@@ -8,58 +8,162 @@
  */
 
 #include "ClassModelCollection.hpp"
+#include "FactStore.hpp"
+#ifdef STEREOCODE_SERVER
+#include "AnalysisServer.hpp"
+#endif
 #include "CLI11.hpp"
 
-primitiveTypes                     PRIMITIVES;
-ignorableCalls                     IGNORED_CALLS;
-typeModifiers                      TYPE_MODIFIERS;
+// The tables of the analysis are defined in libstereocode (StereocodeAnalyzer.cpp) and the user-defined entries are set by the options
+// The other options set the settings of the analysis (analysisSettings)
+extern primitiveTypes                PRIMITIVES;
+extern ignorableCalls                IGNORED_CALLS;
+extern typeModifiers                 TYPE_MODIFIERS;
+
 int                                METHODS_PER_CLASS_THRESHOLD = 21;
-bool                               FREE_FUNCTION                   = false;
-bool                               STRUCT                          = false;
-bool                               INTERFACE                       = false;
-bool                               UNION                           = false;
-bool                               ENUM                            = false;
-bool                               IS_VERBOSE                      = false;
-
-std::unordered_map
-     <int, std::unordered_map
-     <std::string, std::string>>   XPATH_LIST;                         // Map key = unit number. Each map value is a pair of xpath and stereotype
-std::vector<std::string>           LANGUAGE = {"C++", "C#", "Java"};   // Supported languages
-XPathBuilder                       XPATH_TRANSFORMATION;               // List of xpaths used for transformations
 
 int main (int argc, char const *argv[]) {
 
+    analysisSettings    analysis;
     std::string         inputFile;
     std::string         primitivesFile;
     std::string         ignoredCallsFile;
     std::string         typeModifiersFile;
+    std::string         rulesFile;
+    std::vector<std::string> profileOptions;
     std::string         outputFile;
+    std::string         sidecarFile;
+    std::string         eventsFile;
+    std::string         factsFile;
+    std::string         socketFile;
+    std::size_t         maxRequestSize     = 256;
+    bool                allowQuit          = false;
     bool                outputTxtReport    = false;
     bool                outputCsvReport    = false;
+    bool                outputRollup       = false;
     bool                overWriteInput     = false;
     bool                reDocComment       = false;
+    bool                noArchive          = false;
 
     CLI::App app{"Stereocode: Determines method and class stereotypes\n"
                  "Supports C++, C#, and Java\n" };
     
-    app.add_option("input-archive",           inputFile,                        "File name of a srcML input archive")->required();
-    app.add_option("-o,--output-file",        outputFile,                       "File name of output - srcML archive with stereotypes");
+    app.add_option("input-archive",           inputFile,                        "File name of a srcML input archive (- for stdin)");
+    app.add_option("-o,--output-file",        outputFile,                       "File name of output - srcML archive with stereotypes (- for stdout)");
     app.add_option("-p,--primitive-file",     primitivesFile,                   "File name of user supplied primitive types (one per line)");
     app.add_option("-g,--ignore-call-file",   ignoredCallsFile,                 "File name of user supplied calls to ignore (one per line)");
     app.add_option("-t,--type-modifier-file", typeModifiersFile,                "File name of user supplied data type modifiers to remove (one per line)");
+    app.add_option("-r,--rule-file",          rulesFile,                        "File name of user supplied stereotype rules (replaces the built-in rules of each scope it defines)");
     app.add_option("-l,--large-class",        METHODS_PER_CLASS_THRESHOLD,      "Method threshold for the large-class stereotype (default = 21)");
-    app.add_flag  ("-f,--free-function",      FREE_FUNCTION,                    "Identify stereotypes for free functions (C++, C#, and Java)");
-    app.add_flag  ("-i,--interface",          INTERFACE,                        "Identify stereotypes for interfaces (C# and Java)");
-    app.add_flag  ("-n,--union",              UNION,                            "Identify stereotypes for unions (C++)");
-    app.add_flag  ("-m,--enum",               ENUM,                             "Identify stereotypes for enums (Java)");
-    app.add_flag  ("-s,--struct",             STRUCT,                           "Identify stereotypes for structs (C# and Java)");
+    app.add_option("-b,--memory-budget",      analysis.memoryBudget,            "Megabytes of units kept in memory after analysis so output does not read them again (default = 512)");
+    app.add_option("-j,--jobs",               analysis.jobs,                    "Number of threads that add stereotypes to units and compress a .gz output archive (default = number of cores)");
+    app.add_option("-P,--profile",            profileOptions,                   "Also classify with the named settings name[,large-class=int][,rule-file=file][,kinds=sinm]"
+                                                                                "[,primitive-file=file][,ignore-call-file=file] (repeatable)");
+    app.add_flag  ("-f,--free-function",      analysis.freeFunction,            "Identify stereotypes for free functions (C++, C#, and Java)");
+    app.add_flag  ("-i,--interface",          analysis.interfaces,              "Identify stereotypes for interfaces (C# and Java)");
+    app.add_flag  ("-n,--union",              analysis.unions,                  "Identify stereotypes for unions (C++)");
+    app.add_flag  ("-m,--enum",               analysis.enums,                   "Identify stereotypes for enums (Java)");
+    app.add_flag  ("-s,--struct",             analysis.structs,                 "Identify stereotypes for structs (C# and Java)");
     app.add_flag  ("-e,--input-overwrite",    overWriteInput,                   "Overwrite input with stereotype information");
     app.add_flag  ("-x,--txt-report",         outputTxtReport,                  "Output optional TXT report file containing stereotype information");
     app.add_flag  ("-z,--csv-report",         outputCsvReport,                  "Output optional CSV report file containing stereotype information");
+    app.add_flag  ("--rollup",                outputRollup,                     "Output optional CSV report file with the stereotype categories of each directory, file, and package or namespace");
     app.add_flag  ("-c,--comment",            reDocComment,                     "Annotates stereotypes as a comment before method and class definitions (/** @stereotype stereotype */)");
-    app.add_flag  ("-v,--verbose",            IS_VERBOSE,                       "Outputs default primitives, ignored calls, type modifiers, and extra report files");
+    app.add_option("--sidecar",               sidecarFile,                      "File name of optional NDJSON output with one record per annotated element (unit, ordinal, position, and stereotype)");
+    app.add_option("--events",                eventsFile,                       "File name of optional NDJSON output with one record per class, method, and free function as soon as its stereotype is final (- for stdout)");
+    app.add_option("--facts",                 factsFile,                        "File name of optional binary fact store with the facts and stereotypes of every class, method, and free function (see query)");
+    app.add_option("--cache",                 analysis.cacheFile,               "File name of the analysis cache. Units that did not change since the run that wrote it are not extracted again");
+    app.add_flag  ("--two-phase",             analysis.twoPhase,                "Read the input twice (class skeletons first, then analysis and output unit by unit) so only the units waiting for their classes are kept in memory");
+    app.add_option("--serve",                 socketFile,                       "File name of a Unix socket to serve requests on (the srcML archive with stereotypes or the events of each archive sent) instead of analyzing input-archive");
+    app.add_option("--max-request",           maxRequestSize,                   "Megabytes of the largest request --serve reads (default = 256)");
+    app.add_flag  ("--allow-quit",            allowQuit,                        "Stop --serve on a quit request");
+    app.add_flag  ("--no-archive",            noArchive,                        "Only output the report files (-x, -z, -v) and the sidecar (--sidecar), and not the srcML archive with stereotypes");
+    app.add_flag  ("-v,--verbose",            analysis.verbose,                 "Outputs default primitives, ignored calls, type modifiers, stereotype rules, analysis stage counts, and extra report files");
     
+    // Subcommand that filters, counts, or generates reports from a fact store (--facts) without the srcML archive
+    std::string         queryFactsFile;
+    std::string         queryReportPrefix;
+    bool                queryTxtReport     = false;
+    bool                queryCsvReport     = false;
+    bool                queryVerboseReport = false;
+    factQuery           query;
+
+    CLI::App* queryCommand = app.add_subcommand("query", "Filters, counts, or generates the report files of the stereotypes in a fact store (--facts)");
+    queryCommand->add_option("fact-store",           queryFactsFile,      "File name of a fact store written with --facts")->required();
+    queryCommand->add_option("-o,--output-prefix",   queryReportPrefix,   "Prefix of the report files (default = fact store name without extension)");
+    queryCommand->add_flag  ("-x,--txt-report",      queryTxtReport,      "Output the TXT report files");
+    queryCommand->add_flag  ("-z,--csv-report",      queryCsvReport,      "Output the CSV report files");
+    queryCommand->add_flag  ("-v,--verbose",         queryVerboseReport,  "Output the extra CSV report files (unique_method_view, class_view, ...)");
+    queryCommand->add_option("-k,--kind",            query.kind,          "Only output elements of a kind (class, method, or function)")->check(CLI::IsMember({"class", "method", "function"}));
+    queryCommand->add_option("-s,--stereotype",      query.stereotype,    "Only output elements with a stereotype (e.g., get)");
+    queryCommand->add_option("-C,--class",           query.className,     "Only output a class and its methods");
+    queryCommand->add_option("-P,--profile",         query.profile,       "Use the stereotypes of a profile given with --profile");
+    queryCommand->add_flag  ("--count",              query.count,         "Output the number of elements of each stereotype instead of the elements");
+
     CLI11_PARSE(app, argc, argv);
+
+    // Elements matching the query are output to stdout unless only report files are requested
+    if (queryCommand->parsed()) {
+        factStore facts;
+        if (!facts.read(queryFactsFile)) {
+            std::cerr << "Error: Invalid or missing fact store: " << queryFactsFile << '\n';
+            return -1;
+        }
+
+        bool reports = queryTxtReport || queryCsvReport || queryVerboseReport;
+        if (reports) {
+            if (queryReportPrefix == "") queryReportPrefix = queryFactsFile.substr(0, queryFactsFile.find_last_of('.'));
+            facts.outputReportFiles(queryReportPrefix, queryTxtReport, queryCsvReport, queryVerboseReport);
+        }
+
+        bool filtered = query.kind != "" || query.stereotype != "" || query.className != "" || query.profile != "" || query.count;
+        if ((filtered || !reports) && !facts.outputQuery(std::cout, query)) return -1;
+        return 0;
+    }
+
+    // The server only uses the settings and writes the results of each request to its connection
+    // It is only built on platforms with Unix sockets
+    if (socketFile != "") {
+#ifndef STEREOCODE_SERVER
+        std::cerr << "Error: --serve is not supported on this platform" << '\n';
+        return -1;
+#endif
+        bool fileOutput = inputFile != "" || outputFile != "" || overWriteInput || outputTxtReport || outputCsvReport || outputRollup ||
+                          sidecarFile != "" || eventsFile != "" || factsFile != "" || analysis.cacheFile != "" || noArchive || analysis.verbose;
+        if (fileOutput || analysis.twoPhase) {
+            std::cerr << "Error: --serve cannot be used with input-archive, -o, -e, -x, -z, -v, --rollup, --sidecar, --events, --facts, --cache, --two-phase, or --no-archive" << '\n';
+            return -1;
+        }
+    }
+    else if (inputFile == "") {
+        std::cerr << "Error: input-archive is required" << '\n';
+        return -1;
+    }
+
+    if (noArchive && overWriteInput) {
+        std::cerr << "Error: --input-overwrite needs the output archive and cannot be used with --no-archive" << '\n';
+        return -1;
+    }
+
+    if (analysis.twoPhase && inputFile == "-") {
+        std::cerr << "Error: --two-phase reads the input twice and cannot be used with input from stdin (-)" << '\n';
+        return -1;
+    }
+
+    if (analysis.twoPhase && factsFile != "") {
+        std::cerr << "Error: --facts cannot be used with --two-phase" << '\n';
+        return -1;
+    }
+
+    if (analysis.twoPhase && analysis.cacheFile != "") {
+        std::cerr << "Error: --cache cannot be used with --two-phase" << '\n';
+        return -1;
+    }
+
+    if (inputFile == "-" && overWriteInput) {
+        std::cerr << "Error: --input-overwrite cannot be used with input from stdin (-)" << '\n';
+        return -1;
+    }
     
     // Add user-defined primitive types to initial set
     if (primitivesFile != "") {         
@@ -97,8 +201,140 @@ int main (int argc, char const *argv[]) {
         in.close();
     }
 
+    analysis.rules.setLargeClassThreshold(METHODS_PER_CLASS_THRESHOLD);
+
+    // Add user-defined stereotype rules
+    if (rulesFile != "") {         
+        std::ifstream in(rulesFile);
+        if (in.is_open())
+            in >> analysis.rules;
+        else {
+            std::cerr << "Error: Stereotype rules file not found: " << rulesFile << '\n';
+            return -1;
+        }
+        in.close();
+
+        if (analysis.rules.getError() != "") {
+            std::cerr << "Error: Invalid stereotype rules file: " << rulesFile << ", " << analysis.rules.getError() << '\n';
+            return -1;
+        }
+    }
+
+    // Profiles share the facts extracted from the archive and only repeat the classification
+    // Settings not given in a profile are the same as the default settings (-l, -s, -i, -n, -m, -p, -g), 
+    //  except for rules (built-in). kinds= lists the letters of the options of the kinds of classes (e.g., kinds=si),
+    //  and primitive-file= and ignore-call-file= are used with the built-in lists in place of -p and -g
+    for (const std::string& option : profileOptions) {
+        stereotypeProfile profile;
+        std::istringstream settings(option);
+        std::getline(settings, profile.name, ',');
+
+        bool validName = profile.name != "";
+        for (char c : profile.name)
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') validName = false;
+        for (const auto& other : analysis.profiles)
+            if (other.name == profile.name) validName = false;
+        if (!validName) {
+            std::cerr << "Error: Invalid or repeated profile name: " << profile.name << '\n';
+            return -1;
+        }
+
+        profile.structs    = analysis.structs;
+        profile.interfaces = analysis.interfaces;
+        profile.unions     = analysis.unions;
+        profile.enums      = analysis.enums;
+
+        int threshold = METHODS_PER_CLASS_THRESHOLD;
+        std::string profileRulesFile;
+        std::string profilePrimitivesFile;
+        std::string profileIgnoredCallsFile;
+        std::string setting;
+        while (std::getline(settings, setting, ',')) {
+            std::size_t equal = setting.find('=');
+            std::string key = setting.substr(0, equal);
+            std::string value = equal != std::string::npos ? setting.substr(equal + 1) : "";
+            std::istringstream number(value);
+            if (key == "large-class" && number >> threshold && number.eof())
+                continue;
+            else if (key == "rule-file" && value != "")
+                profileRulesFile = value;
+            else if (key == "kinds" && equal != std::string::npos && value.find_first_not_of("sinm") == std::string::npos) {
+                profile.structs    = value.find('s') != std::string::npos;
+                profile.interfaces = value.find('i') != std::string::npos;
+                profile.unions     = value.find('n') != std::string::npos;
+                profile.enums      = value.find('m') != std::string::npos;
+            }
+            else if (key == "primitive-file" && value != "")
+                profilePrimitivesFile = value;
+            else if (key == "ignore-call-file" && value != "")
+                profileIgnoredCallsFile = value;
+            else {
+                std::cerr << "Error: Invalid setting in profile " << profile.name << ": " << setting << '\n';
+                return -1;
+            }
+        }
+        profile.rules.setLargeClassThreshold(threshold);
+
+        if (profileRulesFile != "") {
+            std::ifstream in(profileRulesFile);
+            if (in.is_open())
+                in >> profile.rules;
+            else {
+                std::cerr << "Error: Stereotype rules file not found: " << profileRulesFile << '\n';
+                return -1;
+            }
+            in.close();
+
+            if (profile.rules.getError() != "") {
+                std::cerr << "Error: Invalid stereotype rules file: " << profileRulesFile << ", " << profile.rules.getError() << '\n';
+                return -1;
+            }
+        }
+
+        if (profilePrimitivesFile != "") {
+            std::ifstream in(profilePrimitivesFile);
+            if (in.is_open())
+                in >> profile.primitives;
+            else {
+                std::cerr << "Error: Primitive types file not found: " << profilePrimitivesFile << '\n';
+                return -1;
+            }
+            profile.ownPrimitives = true;
+        }
+
+        if (profileIgnoredCallsFile != "") {
+            std::ifstream in(profileIgnoredCallsFile);
+            if (in.is_open())
+                in >> profile.ignoredCalls;
+            else {
+                std::cerr << "Error: Ignorable calls file not found: " << profileIgnoredCallsFile << '\n';
+                return -1;
+            }
+            profile.ownIgnoredCalls = true;
+        }
+        analysis.profiles.push_back(profile);
+    }
+
+#ifdef STEREOCODE_SERVER
+    // The tables, rules, and xpaths are created once and used by every request
+    if (socketFile != "") {
+        PRIMITIVES.createPrimitiveList();
+        IGNORED_CALLS.createCallList();
+        TYPE_MODIFIERS.createModifierList();
+        analysis.prepare();
+
+        analysisServer server(socketFile, analysis, reDocComment, allowQuit, maxRequestSize);
+        if (!server.open()) {
+            std::cerr << "Error: Cannot listen on socket: " << socketFile << ", " << server.getError() << '\n';
+            return -1;
+        }
+        server.run();
+        return 0;
+    }
+#endif
+
     srcml_archive* archive = srcml_archive_create();
-    int error = srcml_archive_read_open_filename(archive, inputFile.c_str());   
+    int error = openInputArchive(archive, inputFile);   
     if (error) {
         std::cerr << "Error: File not found: " << inputFile << ", error == " << error << '\n';
         srcml_archive_free(archive);
@@ -106,35 +342,65 @@ int main (int argc, char const *argv[]) {
     }
 
     // Default output file name if output a name is not specified by the user
-    if (outputFile == "") {                                             
-        std::string InputFileNoExt = inputFile.substr(0, inputFile.size() - 4);     
+    // A compressed input (.gz) gives a compressed output, and input from stdin (-) gives output to stdout (-)
+    if (outputFile == "" && inputFile == "-")
+        outputFile = "-";
+    else if (outputFile == "") {                                             
+        std::string InputFileNoExt = archiveNameNoExt(inputFile);     
         outputFile = InputFileNoExt + ".stereotypes.xml";     
+        if (isCompressedArchive(inputFile)) outputFile += ".gz";
     }  
 
-    srcml_archive* outputArchive = srcml_archive_create();
-    error = srcml_archive_write_open_filename(outputArchive, outputFile.c_str());
-    if (error) {
-        std::cerr << "Error opening: " << outputFile << std::endl;
+    if (eventsFile == "-" && outputFile == "-" && !noArchive) {
+        std::cerr << "Error: --events and the output archive cannot both be written to stdout (use -o or --no-archive)" << '\n';
         srcml_archive_close(archive);
         srcml_archive_free(archive);
-        srcml_archive_free(outputArchive);
         return -1;
     }
-    
-    // Register namespaces for output
-    srcml_archive_register_namespace(outputArchive, "st", "http://www.srcML.org/srcML/stereotype"); 
-    std::size_t size = srcml_archive_get_namespace_size(archive);
-    for (std::size_t i = 0; i < size; i++) {
-        if (strcmp(srcml_archive_get_namespace_prefix(archive, i), "pos")  == 0) {
-            srcml_archive_register_namespace(outputArchive, "pos", "http://www.srcML.org/srcML/position");
-            break;
+
+    // No output archive is created with --no-archive
+    // An output archive named .gz is compressed as it is written
+    srcml_archive* outputArchive = nullptr;
+    std::unique_ptr<parallelDeflate> compressor;
+    if (!noArchive) {
+        outputArchive = srcml_archive_create();
+        if (outputFile == "-")
+            error = srcml_archive_write_open_FILE(outputArchive, stdout);
+        else if (isCompressedArchive(outputFile)) {
+            compressor.reset(new parallelDeflate(analysis.jobs));
+            error = compressor->open(outputArchive, outputFile);
+        }
+        else
+            error = srcml_archive_write_open_filename(outputArchive, outputFile.c_str());
+        if (error) {
+            std::cerr << "Error opening: " << outputFile << std::endl;
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+            srcml_archive_free(outputArchive);
+            return -1;
         }
+    
+        registerOutputNamespaces(outputArchive, archive);
     }
     
+    std::ofstream eventsOutput;
+    if (eventsFile != "" && eventsFile != "-") eventsOutput.open(eventsFile);
+    std::ostream* events = eventsFile == "-" ? &std::cout : (eventsFile != "" ? &eventsOutput : nullptr);
+
     // Find stereotypes
-    XPATH_TRANSFORMATION.generateXpath(); // Called here since it depends on globals initalized by user input
-    classModelCollection classObj(archive, outputArchive, 
-                                    inputFile, outputFile, outputTxtReport, outputCsvReport, reDocComment);
+    analysis.allFacts = factsFile != "";
+    analysis.prepare(); // Called here since it depends on the settings given by the options
+    classModelCollection classObj(analysis, archive, outputArchive, 
+                                    inputFile, outputTxtReport, outputCsvReport, outputRollup, reDocComment, sidecarFile, events, factsFile);
+    eventsOutput.close();
+    if (classObj.getError() != "") {
+        std::cerr << "Error: " << classObj.getError() << '\n';
+        return -1;
+    }
+    if (compressor && compressor->failed()) {
+        std::cerr << "Error: Cannot write: " << outputFile << '\n';
+        return -1;
+    }
 
     if (overWriteInput) {
         std::filesystem::remove(inputFile);
@@ -11,13 +11,27 @@
  #define STEREOTYPES_HPP
 
  #include "ClassModel.hpp"
+ #include "MethodFeatures.hpp"
+ #include "StereotypeRules.hpp"
  
+ // The feature tables are built on the first call and reused when the stereotypes are computed again with other rules
+ // 'profile' is 0 for the default settings, otherwise the index of the profile (--profile) + 1
+ // The stereotypes of the annotated elements are recorded in the annotation list given to the constructor
+ //
  class stereotypes {
  public:
-    void computeMethodStereotypes         (std::unordered_map<std::string, classModel>&);
-    void computeClassStereotypes          (std::unordered_map<std::string, classModel>&);
-    void computeFreeFunctionsStereotypes  (std::vector<methodModel>&                   );
+         stereotypes                      (annotationList& annotationsFound) : annotations(annotationsFound) {}
 
+    void computeMethodStereotypes         (std::unordered_map<std::string, classModel>&, const stereotypeRules&, std::size_t);
+    void computeClassStereotypes          (std::unordered_map<std::string, classModel>&, const stereotypeRules&, std::size_t);
+    void computeFreeFunctionsStereotypes  (std::vector<methodModel>&,                    const stereotypeRules&, std::size_t);
+
+ private:
+    void recordStereotype                 (int, int, std::uint32_t, bool, std::size_t);
+
+    annotationList&                       annotations;      // Stereotypes recorded for the output archive
+    methodFeatures                        methodTable;      // Methods of all classes in class collection order
+    methodFeatures                        functionTable;    // Free functions
  }; 
  
  #endif
@@ -9,12 +9,12 @@
 
 #include "utils.hpp"
 
-extern primitiveTypes                        PRIMITIVES;   
 extern typeModifiers                         TYPE_MODIFIERS;  
 
 void checkNonPrimitiveType(const std::string& type, variable& var, 
                            const std::string& unitLanguage, 
-                           const std::string& className) {
+                           const std::string& className,
+                           const primitiveTypes& primitives) {
     std::string typeParsed = type;
 
     std::size_t listOpen = typeParsed.find("<");
@@ -37,7 +37,7 @@ void checkNonPrimitiveType(const std::string& type, variable& var,
     while (end != std::string::npos) {
         subType = typeParsed.substr(start, end - start);   
         removeNamespace(subType, unitLanguage, true); 
-        if (!isPrimitiveType(subType, unitLanguage)) {
+        if (!isPrimitiveType(subType, unitLanguage, primitives)) {
             var.setNonPrimitive(true);
             if (subType != className && !className.empty()) var.setNonPrimitiveExternal(true);
         }
@@ -48,19 +48,20 @@ void checkNonPrimitiveType(const std::string& type, variable& var,
 
     subType = typeParsed.substr(start, typeParsed.size() - start);
     removeNamespace(subType, unitLanguage, true);
-    if (!isPrimitiveType(subType, unitLanguage)) {
+    if (!isPrimitiveType(subType, unitLanguage, primitives)) {
         var.setNonPrimitive(true);
         if (subType != className && !className.empty()) var.setNonPrimitiveExternal(true);
     }
 }
 
 // Checks if a type is primitive.  
+// 'primitives' are the primitive types of the analysis (see analysisSettings::getPrimitives())
 //
-bool isPrimitiveType(const std::string& type, const std::string& unitLanguage) {
+bool isPrimitiveType(const std::string& type, const std::string& unitLanguage, const primitiveTypes& primitives) {
     std::istringstream subType(type);
     std::string token;
     while (std::getline(subType, token, ','))
-        if (!PRIMITIVES.isPrimitive(token, unitLanguage)) return false;
+        if (!primitives.isPrimitive(token, unitLanguage)) return false;
     return true;
 }
 
@@ -81,8 +82,7 @@ bool matchSubstringAtBeginning(const std::string& text, const std::string& subst
 // Removes specifiers from type name
 //
 void removeTypeModifiers(std::string& type, std::string unitLanguage) {
-    std::regex regexPattern(TYPE_MODIFIERS.getTypeModifiers(unitLanguage));
-    type = std::regex_replace(type, regexPattern, " ");
+    type = std::regex_replace(type, TYPE_MODIFIERS.getTypeModifierRegex(unitLanguage), " ");
 }
 
 // Function that removes everything starting at '[' and then trims right whitespace
@@ -194,4 +194,27 @@ void srcmlBackwardCompatibility(std::string& xmlText) {
         beforeFunction.pop_back();
         xmlText = beforeFunction + afterFunction;
     }
-}
\ No newline at end of file
+}
+
+// Quotes and escapes a string as a JSON string
+//
+std::string jsonString(const std::string& s) {
+    std::string json = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':  json += "\\\""; break;
+            case '\\': json += "\\\\"; break;
+            case '\n': json += "\\n";  break;
+            case '\r': json += "\\r";  break;
+            case '\t': json += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    json += escaped;
+                }
+                else json += c;
+        }
+    }
+    return json + "\"";
+}
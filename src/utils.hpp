@@ -19,14 +19,16 @@
 #include <unordered_map>
 #include <map>
 #include <cstddef>
+#include <cstdio>
 #include "PrimitiveTypes.hpp"
 #include "TypeModifiers.hpp"
 #include "variable.hpp"
  
 
 void                            checkNonPrimitiveType         (const std::string& type, variable&, 
-                                                               const std::string& unitLanguage, const std::string& className);
-bool                            isPrimitiveType               (const std::string&, const std::string& unitLanguage);
+                                                               const std::string& unitLanguage, const std::string& className,
+                                                               const primitiveTypes&);
+bool                            isPrimitiveType               (const std::string&, const std::string& unitLanguage, const primitiveTypes&);
 bool                            matchSubstringAtBeginning     (const std::string&, const std::string&);
 void                            createSpecifierList           ();
 void                            removeTypeModifiers           (std::string&, std::string);
@@ -38,5 +40,6 @@ void                            Rtrim                         (std::string&);
 void                            removeNamespace               (std::string&, std::string_view, bool);
 void                            removeBetweenComma            (std::string& s, bool);
 void                            srcmlBackwardCompatibility    (std::string&);
+std::string                     jsonString                    (const std::string&);
 
 #endif
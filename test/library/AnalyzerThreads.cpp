@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-3.0-only
+/**
+ * @file AnalyzerThreads.cpp
+ *
+ * @copyright Copyright (C) 2021-2025 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the Stereocode application.
+ */
+
+// Test of libstereocode: two analyzers with their own settings classify the same archive at the same time on two
+//  threads. Each unit handed to unitAnnotated is written to an archive in memory, which must be the BASE archive
+// One analyzer reads a buffer and the other an archive opened by the caller, both with a memory budget of 0, so the
+//  units are read again from the buffer and spooled to a temporary file
+//
+// Usage: analyzer_threads Mixed.xml Mixed.BASE.xml
+//
+
+#include "StereocodeAnalyzer.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// Analyses each thread runs
+constexpr int RUNS = 10;
+
+std::string readFile(const std::string& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    std::stringstream bytes;
+    bytes << in.rdbuf();
+    return bytes.str();
+}
+
+// Classifies the srcML with the analyzer and returns the archive written from unitAnnotated
+// Returns the error of the analyzer if the analysis fails
+//
+std::string annotate(stereocodeAnalyzer& analyzer, const std::string& srcML, bool fromArchive) {
+    srcml_archive* outputArchive = srcml_archive_create();
+    char* buffer = nullptr;
+    std::size_t size = 0;
+    srcml_archive_write_open_memory(outputArchive, &buffer, &size);
+    srcml_archive_register_namespace(outputArchive, "st", "http://www.srcML.org/srcML/stereotype");
+
+    analysisCallbacks callbacks;
+    callbacks.unitAnnotated = [outputArchive](int, srcml_unit* unit) { srcml_archive_write_unit(outputArchive, unit); };
+
+    bool analyzed;
+    if (fromArchive) {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcML.data(), srcML.size());
+        analyzed = analyzer.analyze(archive, callbacks);
+    }
+    else
+        analyzed = analyzer.analyze(srcML.data(), srcML.size(), callbacks);
+
+    srcml_archive_close(outputArchive);
+    srcml_archive_free(outputArchive);
+    std::string annotated = analyzed ? std::string(buffer, size) : "Error: " + analyzer.getError();
+    free(buffer);
+    return annotated;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: analyzer_threads input-archive base-archive" << '\n';
+        return 1;
+    }
+    std::string srcML = readFile(argv[1]);
+    std::string base = readFile(argv[2]);
+
+    // The settings of the BASE archive (-f -s -i -n -m), by one and by several output threads
+    analyzerSettings settings;
+    settings.freeFunction = true;
+    settings.structs      = true;
+    settings.interfaces   = true;
+    settings.unions       = true;
+    settings.enums        = true;
+    settings.memoryBudget = 0;
+    settings.jobs         = 1;
+    stereocodeAnalyzer bufferAnalyzer(settings);
+    settings.jobs         = 4;
+    stereocodeAnalyzer archiveAnalyzer(settings);
+
+    std::atomic<int> failures{0};
+    auto classify = [&](stereocodeAnalyzer& analyzer, bool fromArchive) {
+        for (int i = 0; i < RUNS; ++i) {
+            std::string annotated = annotate(analyzer, srcML, fromArchive);
+            if (annotated != base) {
+                std::cerr << (fromArchive ? "Archive" : "Buffer") << " analysis " << i << " is not the BASE archive:" << '\n'
+                          << annotated.substr(0, 200) << '\n';
+                ++failures;
+            }
+        }
+    };
+
+    std::thread bufferThread(classify, std::ref(bufferAnalyzer), false);
+    std::thread archiveThread(classify, std::ref(archiveAnalyzer), true);
+    bufferThread.join();
+    archiveThread.join();
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/budget)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# Runs stereocode on an input file with a memory budget and compares the output archive to the BASE archive
+# The verbose output (-v) reports how many units were read again from the input for output
+function(run_budget INPUT OUTPUT BUDGET)
+    execute_process(COMMAND ${STEREOCODE} ${INPUT} -f -s -i -n -m -b ${BUDGET} -v -o ${OUTPUT} WORKING_DIRECTORY ${WORK}
+                    OUTPUT_QUIET ERROR_VARIABLE LOG COMMAND_ERROR_IS_FATAL ANY)
+    string(REGEX MATCH "\\[output re-read units\\]: ([0-9]+)" REREAD "${LOG}")
+    set(REREAD_UNITS ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+# With the default budget, every unit is kept from the analysis. With a budget of 0, every unit is read again from the file
+run_budget(Mixed.xml Mixed.512.stereotypes.xml 512)
+if (NOT REREAD_UNITS EQUAL 0)
+    message(FATAL_ERROR "With the default budget, ${REREAD_UNITS} units were read again")
+endif()
+run_budget(Mixed.xml Mixed.0.stereotypes.xml 0)
+if (NOT REREAD_UNITS GREATER 0)
+    message(FATAL_ERROR "With a budget of 0, no unit was read again")
+endif()
+foreach(BUDGET 512 0)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.${BUDGET}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+# A compressed input is read again (and decompressed) the same way
+find_program(GZIP gzip)
+if (NOT GZIP)
+    message(STATUS "gzip not found, compressed input skipped")
+    return()
+endif()
+execute_process(COMMAND ${GZIP} -c ${OPTIONS_DIR}/Mixed.xml OUTPUT_FILE ${WORK}/Mixed.xml.gz COMMAND_ERROR_IS_FATAL ANY)
+run_budget(Mixed.xml.gz Mixed.gz.stereotypes.xml.gz 0)
+if (NOT REREAD_UNITS GREATER 0)
+    message(FATAL_ERROR "With a budget of 0, no unit of the compressed input was read again")
+endif()
+execute_process(COMMAND ${GZIP} -d -c Mixed.gz.stereotypes.xml.gz WORKING_DIRECTORY ${WORK} OUTPUT_FILE ${WORK}/Mixed.gz.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.gz.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
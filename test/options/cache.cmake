@@ -0,0 +1,28 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/cache)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK}/cold ${WORK}/warm)
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK}/cold)
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK}/warm)
+
+# The cold run writes the analysis cache and the warm run restores every unit from it
+# The verbose output (-v) gives the number of units restored and analyzed
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -x -z -v --cache ${WORK}/Mixed.cache WORKING_DIRECTORY ${WORK}/cold
+                ERROR_VARIABLE COLD_LOG COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -x -z -v --cache ${WORK}/Mixed.cache WORKING_DIRECTORY ${WORK}/warm
+                ERROR_VARIABLE WARM_LOG COMMAND_ERROR_IS_FATAL ANY)
+
+if (NOT COLD_LOG MATCHES "\\[restored units\\]: 0\n" OR COLD_LOG MATCHES "\\[analyzed units\\]: 0\n")
+    message(FATAL_ERROR "The cold run restored units from the analysis cache")
+endif()
+if (WARM_LOG MATCHES "\\[restored units\\]: 0\n" OR NOT WARM_LOG MATCHES "\\[analyzed units\\]: 0\n")
+    message(FATAL_ERROR "The warm run did not restore every unit from the analysis cache")
+endif()
+
+# Both runs give the BASE archive and report files
+foreach(RUN cold warm)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/${RUN}/Mixed.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+    foreach(REPORT stereotypes.txt stereotypes.csv free_functions_stereotypes.txt free_functions_stereotypes.csv)
+        execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.${REPORT} ${WORK}/${RUN}/Mixed.${REPORT} COMMAND_ERROR_IS_FATAL ANY)
+    endforeach()
+endforeach()
@@ -0,0 +1,24 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/comment)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# Run stereocode with the stereotype comments (-c) by one and by several threads, with a memory budget of 0, and in two phases
+# Mixed.BASE.comment.xml was written by the separate comment pass that -c used before, so the comments are placed the same way
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -c WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.comment.xml ${WORK}/Mixed.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+
+foreach(JOBS 1 4)
+    execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -c -j ${JOBS} -b 0 -o Mixed.${JOBS}.stereotypes.xml WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.comment.xml ${WORK}/Mixed.${JOBS}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -c --two-phase -o Mixed.two_phase.stereotypes.xml WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.comment.xml ${WORK}/Mixed.two_phase.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+
+# Without the comments, the archive is the same as without -c
+file(READ ${WORK}/Mixed.stereotypes.xml ARCHIVE)
+string(REGEX REPLACE "[ \t]*<comment type=\"block\">/\\*\\* @Stereotype [^*]*\\*/</comment>\n" "" ARCHIVE "${ARCHIVE}")
+file(WRITE ${WORK}/Mixed.uncommented.xml "${ARCHIVE}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.uncommented.xml COMMAND_ERROR_IS_FATAL ANY)
@@ -0,0 +1,20 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/duplicates)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# The units in vendor/ have the same content as the units of the same name, so they copy what was found in them
+# The verbose output (-v) gives the number of units copied
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -x -z -v --sidecar Mixed.sidecar.json WORKING_DIRECTORY ${WORK}
+                ERROR_VARIABLE LOG COMMAND_ERROR_IS_FATAL ANY)
+if (NOT LOG MATCHES "\\[duplicate units\\]: 3\n")
+    message(FATAL_ERROR "The units in vendor/ were not copied from the units with the same content")
+endif()
+
+# The copies are annotated and reported as if they were extracted
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.sidecar.json ${WORK}/Mixed.sidecar.json COMMAND_ERROR_IS_FATAL ANY)
+foreach(REPORT stereotypes.txt stereotypes.csv free_functions_stereotypes.txt free_functions_stereotypes.csv)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.${REPORT} ${WORK}/Mixed.${REPORT} COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
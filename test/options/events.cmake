@@ -0,0 +1,31 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/events)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# Run stereocode with the events written to a file and to stdout (-)
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m --events Mixed.events.json WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m --events - --no-archive OUTPUT_FILE ${WORK}/Mixed.stdout.events.json
+                WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+
+# Compare the archive and both event files to the BASE files
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.events.json ${WORK}/Mixed.events.json COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.events.json ${WORK}/Mixed.stdout.events.json COMMAND_ERROR_IS_FATAL ANY)
+
+# There is one method event per row of the CSV report and one function event per row of the free function CSV report
+file(STRINGS ${WORK}/Mixed.events.json METHOD_EVENTS REGEX "\"kind\":\"method\"")
+file(STRINGS ${WORK}/Mixed.events.json FUNCTION_EVENTS REGEX "\"kind\":\"function\"")
+file(STRINGS ${OPTIONS_DIR}/Mixed.BASE.stereotypes.csv METHOD_ROWS)
+file(STRINGS ${OPTIONS_DIR}/Mixed.BASE.free_functions_stereotypes.csv FUNCTION_ROWS)
+list(LENGTH METHOD_EVENTS METHOD_EVENT_COUNT)
+list(LENGTH FUNCTION_EVENTS FUNCTION_EVENT_COUNT)
+list(LENGTH METHOD_ROWS METHOD_ROW_COUNT)
+list(LENGTH FUNCTION_ROWS FUNCTION_ROW_COUNT)
+math(EXPR METHOD_ROW_COUNT "${METHOD_ROW_COUNT} - 1")
+math(EXPR FUNCTION_ROW_COUNT "${FUNCTION_ROW_COUNT} - 1")
+if (NOT METHOD_EVENT_COUNT EQUAL METHOD_ROW_COUNT OR NOT FUNCTION_EVENT_COUNT EQUAL FUNCTION_ROW_COUNT)
+    message(FATAL_ERROR "The events have ${METHOD_EVENT_COUNT} methods and ${FUNCTION_EVENT_COUNT} functions for "
+                        "${METHOD_ROW_COUNT} and ${FUNCTION_ROW_COUNT} rows of the CSV reports")
+endif()
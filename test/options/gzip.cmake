@@ -0,0 +1,25 @@
+# The input archive is compressed and the output archive is decompressed with gzip
+find_program(GZIP gzip)
+if (NOT GZIP)
+    message(STATUS "gzip not found, test skipped")
+    return()
+endif()
+
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/gzip)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+execute_process(COMMAND ${GZIP} -c ${OPTIONS_DIR}/Mixed.xml OUTPUT_FILE ${WORK}/Mixed.xml.gz COMMAND_ERROR_IS_FATAL ANY)
+
+# A compressed input gives a compressed output. The blocks of the output are compressed by one and by several threads
+foreach(JOBS 1 4)
+    execute_process(COMMAND ${STEREOCODE} Mixed.xml.gz -f -s -i -n -m -j ${JOBS} -o Mixed.${JOBS}.stereotypes.xml.gz WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${GZIP} -d -c Mixed.${JOBS}.stereotypes.xml.gz WORKING_DIRECTORY ${WORK} OUTPUT_FILE ${WORK}/Mixed.${JOBS}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.${JOBS}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+# Default output file name of a compressed input
+execute_process(COMMAND ${STEREOCODE} Mixed.xml.gz -f -s -i -n -m WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+if (NOT EXISTS ${WORK}/Mixed.stereotypes.xml.gz)
+    message(FATAL_ERROR "A compressed input did not give a compressed output")
+endif()
@@ -0,0 +1,24 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/no_archive)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK}/archive ${WORK}/no_archive)
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK}/archive)
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK}/no_archive)
+
+# Run stereocode with the report files, with and without the output archive
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -x -z -v WORKING_DIRECTORY ${WORK}/archive ERROR_QUIET COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -x -z -v --no-archive WORKING_DIRECTORY ${WORK}/no_archive ERROR_QUIET COMMAND_ERROR_IS_FATAL ANY)
+
+if (EXISTS ${WORK}/no_archive/Mixed.stereotypes.xml)
+    message(FATAL_ERROR "--no-archive wrote the output archive")
+endif()
+
+# Compare the report files of both runs, and the TXT and CSV report files to the BASE report files
+file(GLOB REPORTS RELATIVE ${WORK}/archive ${WORK}/archive/*.csv ${WORK}/archive/*.txt)
+foreach(REPORT ${REPORTS})
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/archive/${REPORT} ${WORK}/no_archive/${REPORT} COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+foreach(REPORT stereotypes.txt stereotypes.csv free_functions_stereotypes.txt free_functions_stereotypes.csv)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.${REPORT} ${WORK}/no_archive/Mixed.${REPORT} COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
@@ -0,0 +1,63 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/profiles)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+file(WRITE ${WORK}/primitives.txt "MyClass\nAnotherClass\n")
+file(WRITE ${WORK}/ignored_calls.txt "externalFunction\nanotherExternalFunction\n")
+
+# Run stereocode with a profile for each setting
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -z -P small,large-class=10 -P classes,kinds=
+                        -P primitives,primitive-file=primitives.txt -P calls,ignore-call-file=ignored_calls.txt
+                WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+
+# Without the profile attributes, the archive is the same as without profiles, and so are the default report files
+file(READ ${WORK}/Mixed.stereotypes.xml ARCHIVE)
+string(REGEX REPLACE " st:stereotype-[a-z]+=\"[^\"]*\"" "" DEFAULT_ARCHIVE "${ARCHIVE}")
+file(WRITE ${WORK}/Mixed.default.xml "${DEFAULT_ARCHIVE}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.default.xml COMMAND_ERROR_IS_FATAL ANY)
+foreach(REPORT stereotypes.csv free_functions_stereotypes.csv)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.${REPORT} ${WORK}/Mixed.${REPORT} COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+# Every profile has its report files, and a profile with the same kinds labels every element
+foreach(PROFILE small classes primitives calls)
+    foreach(REPORT stereotypes.csv free_functions_stereotypes.csv)
+        if (NOT EXISTS ${WORK}/Mixed.${PROFILE}.${REPORT})
+            message(FATAL_ERROR "The profile ${PROFILE} has no ${REPORT}")
+        endif()
+    endforeach()
+endforeach()
+string(REGEX MATCHALL "st:stereotype=" DEFAULT_ATTRIBUTES "${ARCHIVE}")
+string(REGEX MATCHALL "st:stereotype-small=" SMALL_ATTRIBUTES "${ARCHIVE}")
+list(LENGTH DEFAULT_ATTRIBUTES DEFAULT_COUNT)
+list(LENGTH SMALL_ATTRIBUTES SMALL_COUNT)
+if (NOT DEFAULT_COUNT EQUAL SMALL_COUNT)
+    message(FATAL_ERROR "The profile small labels ${SMALL_COUNT} of ${DEFAULT_COUNT} elements")
+endif()
+
+# kinds= only classifies classes, so the union and the enum are not labeled by the profile
+file(READ ${WORK}/Mixed.classes.stereotypes.csv CLASSES_REPORT)
+if (NOT ARCHIVE MATCHES "<class [^>]*st:stereotype-classes=" OR ARCHIVE MATCHES "<(union|enum) [^>]*st:stereotype-classes=" OR
+    CLASSES_REPORT MATCHES "\"(MyUnion|Day)\"")
+    message(FATAL_ERROR "The profile classes did not only classify classes")
+endif()
+
+# MyClass is a primitive type for the profile primitives, so createObject is not a factory
+# The profile calls ignores the calls of wrapExternalFunction, so it is not a wrapper
+file(READ ${WORK}/Mixed.stereotypes.csv DEFAULT_REPORT)
+file(READ ${WORK}/Mixed.primitives.stereotypes.csv PRIMITIVES_REPORT)
+file(READ ${WORK}/Mixed.calls.stereotypes.csv CALLS_REPORT)
+if (NOT DEFAULT_REPORT MATCHES "\"createObject\",\"factory" OR PRIMITIVES_REPORT MATCHES "factory")
+    message(FATAL_ERROR "The profile primitives did not use its primitive types")
+endif()
+if (NOT DEFAULT_REPORT MATCHES "\"wrapExternalFunction\",\"wrapper" OR CALLS_REPORT MATCHES "\"wrapExternalFunction\",\"wrapper")
+    message(FATAL_ERROR "The profile calls did not use its ignored calls")
+endif()
+
+# An unknown setting is an error
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -P bad,kinds=x --no-archive WORKING_DIRECTORY ${WORK}
+                RESULT_VARIABLE RESULT OUTPUT_QUIET ERROR_QUIET)
+if (RESULT EQUAL 0)
+    message(FATAL_ERROR "The setting kinds=x was accepted")
+endif()
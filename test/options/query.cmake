@@ -0,0 +1,30 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/query)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# Run stereocode with the report files and the fact store, then generate the report files again from the fact store
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -x -z -v --facts Mixed.facts --no-archive WORKING_DIRECTORY ${WORK} ERROR_QUIET COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} query Mixed.facts -x -z -v -o query WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+
+# The report files of the query are the same as those of the analysis, whose TXT and CSV report files are the BASE report files
+file(GLOB REPORTS RELATIVE ${WORK} ${WORK}/Mixed.*.csv ${WORK}/Mixed.*.txt)
+list(LENGTH REPORTS REPORT_COUNT)
+if (REPORT_COUNT LESS 9)
+    message(FATAL_ERROR "The analysis wrote ${REPORT_COUNT} report files")
+endif()
+foreach(REPORT ${REPORTS})
+    string(REGEX REPLACE "^Mixed" "query" QUERY_REPORT ${REPORT})
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/${REPORT} ${WORK}/${QUERY_REPORT} COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+foreach(REPORT stereotypes.txt stereotypes.csv free_functions_stereotypes.txt free_functions_stereotypes.csv)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.${REPORT} ${WORK}/query.${REPORT} COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+# Count the stereotypes and filter the methods by stereotype
+execute_process(COMMAND ${STEREOCODE} query Mixed.facts --count OUTPUT_FILE ${WORK}/Mixed.count.csv WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} query Mixed.facts -k method -s get OUTPUT_FILE ${WORK}/Mixed.get.csv WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.count.csv ${WORK}/Mixed.count.csv COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.get.csv ${WORK}/Mixed.get.csv COMMAND_ERROR_IS_FATAL ANY)
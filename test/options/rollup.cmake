@@ -0,0 +1,22 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/rollup)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# Run stereocode with the rollup report and compare it to the BASE file
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m --rollup --no-archive WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.rollup.csv ${WORK}/Mixed.rollup.csv COMMAND_ERROR_IS_FATAL ANY)
+
+# The methods of the whole archive are the rows of the CSV report and of the free function CSV report
+file(STRINGS ${WORK}/Mixed.rollup.csv ALL_ROW REGEX "^all,")
+string(REPLACE "," ";" ALL_ROW "${ALL_ROW}")
+list(GET ALL_ROW 3 METHOD_COUNT)
+file(STRINGS ${OPTIONS_DIR}/Mixed.BASE.stereotypes.csv METHOD_ROWS)
+file(STRINGS ${OPTIONS_DIR}/Mixed.BASE.free_functions_stereotypes.csv FUNCTION_ROWS)
+list(LENGTH METHOD_ROWS METHOD_ROW_COUNT)
+list(LENGTH FUNCTION_ROWS FUNCTION_ROW_COUNT)
+math(EXPR ROW_COUNT "${METHOD_ROW_COUNT} + ${FUNCTION_ROW_COUNT} - 2")
+if (NOT METHOD_COUNT EQUAL ROW_COUNT)
+    message(FATAL_ERROR "The rollup report has ${METHOD_COUNT} methods for ${ROW_COUNT} rows of the CSV reports")
+endif()
@@ -0,0 +1,83 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/rules)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+get_filename_component(TEST_DIR ${OPTIONS_DIR} DIRECTORY)
+
+# A rules file (-r) with the built-in rules, as listed by the verbose output (-v), gives the BASE archives of the tests
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -v --no-archive WORKING_DIRECTORY ${WORK} ERROR_VARIABLE LOG COMMAND_ERROR_IS_FATAL ANY)
+string(REGEX MATCHALL "\\[Default\\]: [^\n]*" RULES "${LOG}")
+list(LENGTH RULES RULE_COUNT)
+if (RULE_COUNT EQUAL 0)
+    message(FATAL_ERROR "The verbose output has no built-in rules")
+endif()
+list(TRANSFORM RULES REPLACE "^\\[Default\\]: " "")
+list(JOIN RULES "\n" RULES)
+file(WRITE ${WORK}/Builtin.rules "${RULES}\n")
+
+foreach(TEST_FILE Cpp Csharp Java)
+    execute_process(COMMAND ${STEREOCODE} ${TEST_DIR}/${TEST_FILE}.xml -f -s -i -n -m -r Builtin.rules -o ${TEST_FILE}.stereotypes.xml
+                    WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${TEST_DIR}/${TEST_FILE}.BASE.xml ${WORK}/${TEST_FILE}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+# A custom rules file replaces the rules of the scopes it defines (methods and classes), and free functions keep the built-in rules
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -z --no-archive -r ${OPTIONS_DIR}/Custom.rules WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.custom_rules.csv ${WORK}/Mixed.stereotypes.csv COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.free_functions_stereotypes.csv ${WORK}/Mixed.free_functions_stereotypes.csv COMMAND_ERROR_IS_FATAL ANY)
+
+# Rules from a file see every fact of empty methods, which the built-in rules decide by their statements alone
+file(WRITE ${WORK}/Empty.rules "method command : isVoidReturnType & nonCommentStatementsCount == 0\nmethod unclassified : none\n")
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -z --no-archive -r Empty.rules WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+file(STRINGS ${WORK}/Mixed.stereotypes.csv EMPTY_METHODS REGEX "\"[Ee]mptyMethod\"")
+list(LENGTH EMPTY_METHODS EMPTY_COUNT)
+if (EMPTY_COUNT EQUAL 0)
+    message(FATAL_ERROR "The report has no empty methods")
+endif()
+foreach(ROW ${EMPTY_METHODS})
+    if (NOT ROW MATCHES "\"command\"$")
+        message(FATAL_ERROR "A rule over the return type did not label an empty method: ${ROW}")
+    endif()
+endforeach()
+
+# Malformed rules files are rejected with the line and the reason, and nothing is output
+set(MALFORMED_RULES
+    "method get hasSimpleReturn"
+    "method get : isUnknownFact"
+    "method getter : hasSimpleReturn"
+    "methods get : hasSimpleReturn"
+    "method let get = hasSimpleReturn"
+    "class data-class : get + > 1"
+    "method get : (hasSimpleReturn"
+    "method get : nonCommentStatementsCount == 1.5.2")
+set(EXPECTED_ERRORS
+    "line 3: expected ':'"
+    "line 3: unknown condition 'isUnknownFact'"
+    "line 3: unknown method stereotype 'getter'"
+    "line 3: expected method, function, or class"
+    "line 3: 'get' is already defined"
+    "line 3: expected a count"
+    "line 3: expected '\\)'"
+    "line 3: invalid number '1.5.2'")
+
+list(LENGTH MALFORMED_RULES CASE_COUNT)
+math(EXPR LAST_CASE "${CASE_COUNT} - 1")
+foreach(CASE RANGE ${LAST_CASE})
+    list(GET MALFORMED_RULES ${CASE} RULE)
+    list(GET EXPECTED_ERRORS ${CASE} EXPECTED)
+    file(REMOVE ${WORK}/Mixed.stereotypes.xml)
+    file(WRITE ${WORK}/Malformed.rules "# Malformed rule\n\n${RULE}\n")
+    execute_process(COMMAND ${STEREOCODE} Mixed.xml -r Malformed.rules WORKING_DIRECTORY ${WORK} RESULT_VARIABLE RESULT ERROR_VARIABLE LOG)
+    if (RESULT EQUAL 0 OR NOT LOG MATCHES "Error: Invalid stereotype rules file: Malformed.rules, ${EXPECTED}\n")
+        message(FATAL_ERROR "The rule '${RULE}' was not rejected with '${EXPECTED}': ${LOG}")
+    endif()
+    if (EXISTS ${WORK}/Mixed.stereotypes.xml)
+        message(FATAL_ERROR "The rule '${RULE}' was rejected but the archive was written")
+    endif()
+endforeach()
+
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -r Missing.rules WORKING_DIRECTORY ${WORK} RESULT_VARIABLE RESULT ERROR_VARIABLE LOG)
+if (RESULT EQUAL 0 OR NOT LOG MATCHES "Error: Stereotype rules file not found: Missing.rules\n")
+    message(FATAL_ERROR "A missing rules file was not rejected: ${LOG}")
+endif()
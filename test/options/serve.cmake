@@ -0,0 +1,80 @@
+# The server (--serve) is only built on Unix, and the requests are sent with socat or nc
+if (NOT CMAKE_HOST_UNIX)
+    message(STATUS "--serve is not built on this platform, test skipped")
+    return()
+endif()
+
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/serve)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+
+# A file that is not a socket is not replaced
+file(WRITE ${WORK}/not_a_socket "Not a socket\n")
+execute_process(COMMAND ${STEREOCODE} --serve not_a_socket WORKING_DIRECTORY ${WORK} RESULT_VARIABLE RESULT OUTPUT_QUIET ERROR_QUIET)
+file(READ ${WORK}/not_a_socket CONTENT)
+if (RESULT EQUAL 0 OR NOT CONTENT STREQUAL "Not a socket\n")
+    message(FATAL_ERROR "--serve replaced a file that is not a socket")
+endif()
+
+find_program(SOCAT socat)
+find_program(NC nc)
+if (SOCAT)
+    set(CLIENT "'${SOCAT}' -t 30 - UNIX-CONNECT:stereocode.sock")
+elseif (NC)
+    set(CLIENT "'${NC}' -U -N stereocode.sock")
+else()
+    message(STATUS "socat and nc not found, test skipped")
+    return()
+endif()
+
+# Each request is a header line and the archive
+file(READ ${OPTIONS_DIR}/Mixed.xml ARCHIVE)
+file(WRITE ${WORK}/xml.request "xml\n${ARCHIVE}")
+file(WRITE ${WORK}/json.request "json\n${ARCHIVE}")
+file(WRITE ${WORK}/bad.request "bad\n")
+file(WRITE ${WORK}/quit.request "quit\n")
+
+# Start the server in the background and wait for its socket
+execute_process(COMMAND sh -c "'${STEREOCODE}' --serve stereocode.sock --allow-quit -f -s -i -n -m > server.log 2>&1 &" WORKING_DIRECTORY ${WORK})
+foreach(TRY RANGE 100)
+    if (EXISTS ${WORK}/stereocode.sock)
+        break()
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 0.1)
+endforeach()
+if (NOT EXISTS ${WORK}/stereocode.sock)
+    message(FATAL_ERROR "The server did not create its socket")
+endif()
+
+# A second server does not take over the socket of a running one
+execute_process(COMMAND ${STEREOCODE} --serve stereocode.sock WORKING_DIRECTORY ${WORK} RESULT_VARIABLE RESULT OUTPUT_QUIET ERROR_QUIET)
+if (RESULT EQUAL 0)
+    message(FATAL_ERROR "A second server listened on the socket of a running server")
+endif()
+
+# Send several requests at the same time, then an invalid request and the quit request
+execute_process(COMMAND sh -c "for i in 1 2 3 4 5 6; do ${CLIENT} < xml.request > Mixed.$i.stereotypes.xml & done; ${CLIENT} < json.request > Mixed.events.json & wait"
+                WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND sh -c "${CLIENT} < bad.request" WORKING_DIRECTORY ${WORK} OUTPUT_VARIABLE BAD_REPLY COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND sh -c "${CLIENT} < quit.request" WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+
+# Every reply is the same as the output of the command line
+foreach(REQUEST 1 2 3 4 5 6)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.${REQUEST}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.events.json ${WORK}/Mixed.events.json COMMAND_ERROR_IS_FATAL ANY)
+if (NOT BAD_REPLY MATCHES "^Error: Invalid request header: bad")
+    message(FATAL_ERROR "The invalid request was answered with: ${BAD_REPLY}")
+endif()
+
+# The server removes its socket when it stops
+foreach(TRY RANGE 100)
+    if (NOT EXISTS ${WORK}/stereocode.sock)
+        break()
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 0.1)
+endforeach()
+if (EXISTS ${WORK}/stereocode.sock)
+    message(FATAL_ERROR "The server did not stop on the quit request")
+endif()
@@ -0,0 +1,24 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/sidecar)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK})
+
+# Run stereocode with the sidecar, with and without the output archive
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m --sidecar Mixed.sidecar.json WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m --sidecar Mixed.no_archive.sidecar.json --no-archive WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+
+# Compare the archive and both sidecars to the BASE files
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.sidecar.json ${WORK}/Mixed.sidecar.json COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.sidecar.json ${WORK}/Mixed.no_archive.sidecar.json COMMAND_ERROR_IS_FATAL ANY)
+
+# The sidecar has one record per stereotype attribute of the archive
+file(STRINGS ${WORK}/Mixed.sidecar.json RECORDS)
+list(LENGTH RECORDS RECORD_COUNT)
+file(READ ${OPTIONS_DIR}/Mixed.BASE.xml ARCHIVE)
+string(REGEX MATCHALL "st:stereotype=" ATTRIBUTES "${ARCHIVE}")
+list(LENGTH ATTRIBUTES ATTRIBUTE_COUNT)
+if (NOT RECORD_COUNT EQUAL ATTRIBUTE_COUNT)
+    message(FATAL_ERROR "The sidecar has ${RECORD_COUNT} records for ${ATTRIBUTE_COUNT} stereotypes")
+endif()
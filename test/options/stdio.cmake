@@ -0,0 +1,12 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/stdio)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+
+# Run stereocode with the input from stdin and the output to stdout (-)
+# With a memory budget of 0, the units read from stdin are spooled to a temporary file for output
+foreach(BUDGET 512 0)
+    execute_process(COMMAND ${STEREOCODE} - -f -s -i -n -m -b ${BUDGET} INPUT_FILE ${OPTIONS_DIR}/Mixed.xml OUTPUT_FILE ${WORK}/Mixed.${BUDGET}.stereotypes.xml
+                    WORKING_DIRECTORY ${WORK} COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/Mixed.${BUDGET}.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
@@ -0,0 +1,53 @@
+# Remove the output of the last run (If it exists already)
+set(WORK ${OPTIONS_DIR}/two_phase)
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK}/archive ${WORK}/no_archive ${WORK}/default_profile ${WORK}/two_phase_profile)
+foreach(DIR archive no_archive default_profile two_phase_profile)
+    file(COPY ${OPTIONS_DIR}/Mixed.xml DESTINATION ${WORK}/${DIR})
+endforeach()
+
+# The rows of the report files are in the order that the classes are finished, so the lines are compared sorted
+function(compare_sorted EXPECTED ACTUAL)
+    file(STRINGS ${EXPECTED} EXPECTED_LINES)
+    file(STRINGS ${ACTUAL} ACTUAL_LINES)
+    list(SORT EXPECTED_LINES)
+    list(SORT ACTUAL_LINES)
+    if (NOT EXPECTED_LINES STREQUAL ACTUAL_LINES)
+        message(FATAL_ERROR "${ACTUAL} does not have the lines of ${EXPECTED}")
+    endif()
+endfunction()
+
+# Run stereocode in two phases with the report files and the sidecar, with and without the output archive
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -z --two-phase --sidecar Mixed.sidecar.json
+                WORKING_DIRECTORY ${WORK}/archive COMMAND_ERROR_IS_FATAL ANY)
+execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -z --two-phase --sidecar Mixed.sidecar.json --no-archive
+                WORKING_DIRECTORY ${WORK}/no_archive COMMAND_ERROR_IS_FATAL ANY)
+
+if (EXISTS ${WORK}/no_archive/Mixed.stereotypes.xml)
+    message(FATAL_ERROR "--no-archive wrote the output archive")
+endif()
+
+# The archive and the sidecar are the same as the default mode, and so are the rows of the report files
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.xml ${WORK}/archive/Mixed.stereotypes.xml COMMAND_ERROR_IS_FATAL ANY)
+foreach(DIR archive no_archive)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OPTIONS_DIR}/Mixed.BASE.sidecar.json ${WORK}/${DIR}/Mixed.sidecar.json COMMAND_ERROR_IS_FATAL ANY)
+    foreach(REPORT stereotypes.csv free_functions_stereotypes.csv)
+        compare_sorted(${OPTIONS_DIR}/Mixed.BASE.${REPORT} ${WORK}/${DIR}/Mixed.${REPORT})
+    endforeach()
+endforeach()
+
+# With a profile (-P), the archive has the stereotypes of both settings and each profile has its report files
+foreach(MODE default two_phase)
+    set(TWO_PHASE "")
+    if (MODE STREQUAL "two_phase")
+        set(TWO_PHASE --two-phase)
+    endif()
+    execute_process(COMMAND ${STEREOCODE} Mixed.xml -f -s -i -n -m -z -P small,large-class=10 ${TWO_PHASE}
+                    WORKING_DIRECTORY ${WORK}/${MODE}_profile COMMAND_ERROR_IS_FATAL ANY)
+endforeach()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/default_profile/Mixed.stereotypes.xml ${WORK}/two_phase_profile/Mixed.stereotypes.xml
+                COMMAND_ERROR_IS_FATAL ANY)
+foreach(REPORT stereotypes.csv small.stereotypes.csv free_functions_stereotypes.csv small.free_functions_stereotypes.csv)
+    compare_sorted(${WORK}/default_profile/Mixed.${REPORT} ${WORK}/two_phase_profile/Mixed.${REPORT})
+endforeach()